@@ -0,0 +1,74 @@
+#include "yaml.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+/*
+ * Время загрузки сгенерированной конфигурации с большим числом операций и
+ * обхода всех полей операций в порядке файла
+ */
+
+/*
+ * @brief Измерить лучшее время функции
+ * @param repeats количество повторов
+ * @param func функция
+ * @return время в миллисекундах
+ */
+template <typename F> double bestTime(int repeats, F func) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main() {
+  const size_t sizes[] = {1000, 10000, 100000};
+  const string path = "bench_config.yaml";
+
+  std::printf("%12s %12s %12s %12s\n", "operations", "size, KB", "load, ms",
+              "MB/s");
+
+  for (size_t size : sizes) {
+    std::ofstream file(path);
+    file << "path: data.csv\noperations:\n";
+    for (size_t i = 0; i < size; i++) {
+      file << "  op_" << i << ":\n"
+           << "    func: sum\n"
+           << "    column: " << i % 7 << "\n"
+           << "    where: flt_" << i % 13 << " # фильтр\n";
+    }
+    size_t bytes = file.tellp();
+    file.close();
+
+    size_t fields = 0;
+    double ms = bestTime(3, [&]() {
+      TINY_YAML::Yaml yaml(path);
+      const TINY_YAML::Node &operations = yaml["operations"];
+      fields = 0;
+      for (const string &id : operations.getChildIds()) {
+        operations[id].forEachChild([&](const TINY_YAML::Node &field) {
+          fields += !field.value().empty();
+        });
+      }
+    });
+
+    if (fields != size * 3) {
+      std::printf("Parsed %zu fields instead of %zu\n", fields, size * 3);
+      return 1;
+    }
+    std::printf("%12zu %12zu %12.2f %12.1f\n", size, bytes / 1024, ms,
+                bytes / 1024.0 / 1024.0 / (ms / 1000));
+  }
+  std::remove(path.c_str());
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include "../include/histogram.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using std::vector;
+
+/*
+ * Сравнение построчного подсчета гистограммы с histogramInsert (SIMD-ядро
+ * в одном потоке и по числу ядер) на равномерных данных с пропусками
+ */
+
+/*
+ * @brief Измерить лучшее время функции
+ * @param repeats количество повторов
+ * @param func функция
+ * @return время в миллисекундах
+ */
+template <typename F> double bestTime(int repeats, F func) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main() {
+  const size_t sizes[] = {1 << 16, 1 << 20, 1 << 24, 1 << 26};
+  const size_t bins = 64;
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> uniform(0, 1000);
+
+  std::printf("%12s %12s %12s %12s %9s\n", "rows", "scalar, ms",
+              "simd x1, ms", "simd, ms", "speedup");
+
+  for (size_t size : sizes) {
+    vector<float> values(size);
+    vector<uint64_t> validity((size + 63) / 64);
+    for (size_t i = 0; i < size; i++) {
+      values[i] = uniform(generator);
+      if (i % 10 != 0)
+        validity[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    vector<uint64_t> expected(bins);
+    double scalar_ms = bestTime(3, [&]() {
+      expected.assign(bins, 0);
+      for (size_t i = 0; i < size; i++) {
+        float value = values[i];
+        if ((validity[i / 64] >> (i % 64) & 1) and value >= 0 and
+            value <= 1000)
+          expected[std::min<size_t>(value * (bins / 1000.0f), bins - 1)]++;
+      }
+    });
+
+    HistogramState single;
+    HistogramState parallel;
+    auto run = [&](HistogramState &state, unsigned workers) {
+      state = HistogramState();
+      state.spec = {bins, true, 0, 1000};
+      histogramInsert(state, values.data(), validity.data(), size, workers);
+    };
+    double single_ms = bestTime(3, [&]() { run(single, 1); });
+    double parallel_ms = bestTime(3, [&]() { run(parallel, 0); });
+
+    if (single.counts != expected or parallel.counts != expected) {
+      std::printf("histogramInsert result differs from scalar loop\n");
+      return 1;
+    }
+    std::printf("%12zu %12.2f %12.2f %12.2f %8.1fx\n", size, scalar_ms,
+                single_ms, parallel_ms, scalar_ms / parallel_ms);
+  }
+  return 0;
+}
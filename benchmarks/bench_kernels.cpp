@@ -0,0 +1,95 @@
+#include "../include/kernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using std::vector;
+
+/*
+ * Сравнение ядра maskedSum с прежней реализацией sum (последовательный цикл
+ * с одним аккумулятором float) по времени и точности
+ */
+
+/*
+ * @brief Прежняя реализация суммы
+ * @param source значения
+ * @return сумма
+ */
+float scalarSum(const vector<float> &source) {
+  float sum = 0;
+  for (float num : source) {
+    sum += num;
+  }
+  return sum;
+}
+
+/*
+ * @brief Эталонная сумма с компенсацией Кэхэна в long double
+ * @param source значения
+ * @return сумма
+ */
+long double referenceSum(const vector<float> &source) {
+  long double sum = 0;
+  long double compensation = 0;
+  for (float num : source) {
+    long double y = num - compensation;
+    long double t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  }
+  return sum;
+}
+
+/*
+ * @brief Измерить лучшее время выполнения функции
+ * @param repeats количество повторов
+ * @param func измеряемая функция
+ * @param result результат последнего вызова
+ * @return время в миллисекундах
+ */
+template <typename F> double bestTime(int repeats, F func, double &result) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    auto start = std::chrono::steady_clock::now();
+    result = func();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main() {
+  const size_t sizes[] = {1 << 20, 1 << 24, 1 << 26};
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(0, 1);
+
+  std::printf("%12s %12s %12s %9s %14s %14s\n", "rows", "scalar, ms",
+              "kernel, ms", "speedup", "scalar error", "kernel error");
+
+  for (size_t size : sizes) {
+    vector<float> values(size);
+    for (float &value : values) {
+      value = distribution(generator);
+    }
+
+    long double reference = referenceSum(values);
+    double scalar_result = 0;
+    double kernel_result = 0;
+
+    double scalar_ms =
+        bestTime(5, [&]() { return double(scalarSum(values)); }, scalar_result);
+    double kernel_ms = bestTime(
+        5, [&]() { return maskedSum(values.data(), nullptr, values.size()); },
+        kernel_result);
+
+    std::printf("%12zu %12.2f %12.2f %8.1fx %14.3e %14.3e\n", size, scalar_ms,
+                kernel_ms, scalar_ms / kernel_ms,
+                double(std::fabs(scalar_result - reference) / reference),
+                double(std::fabs(kernel_result - reference) / reference));
+  }
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "../include/sort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using std::vector;
+
+/*
+ * Сравнение поразрядной сортировки radixSort с std::sort на одних и тех же
+ * данных: равномерные значения и значения с малым числом различных разрядов
+ */
+
+/*
+ * @brief Измерить лучшее время сортировки копии данных
+ * @param repeats количество повторов
+ * @param source исходные данные
+ * @param func функция сортировки
+ * @param sorted результат последнего вызова
+ * @return время в миллисекундах
+ */
+template <typename F>
+double bestTime(int repeats, const vector<float> &source, F func,
+                vector<float> &sorted) {
+  double best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    sorted = source;
+    auto start = std::chrono::steady_clock::now();
+    func(sorted);
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ms < best)
+      best = ms;
+  }
+  return best;
+}
+
+int main() {
+  const size_t sizes[] = {1 << 16, 1 << 20, 1 << 24};
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> uniform(-1e6, 1e6);
+  std::uniform_int_distribution<int> small(0, 255);
+
+  std::printf("%12s %10s %14s %12s %12s %9s\n", "rows", "data",
+              "std::sort, ms", "radix x1, ms", "radix, ms", "speedup");
+
+  for (size_t size : sizes) {
+    for (int kind = 0; kind < 2; kind++) {
+      vector<float> values(size);
+      for (float &value : values) {
+        value = kind == 0 ? uniform(generator) : float(small(generator));
+      }
+
+      vector<float> expected;
+      vector<float> single;
+      vector<float> parallel;
+      double std_ms = bestTime(
+          3, values,
+          [](vector<float> &v) { std::sort(v.begin(), v.end()); }, expected);
+      double single_ms = bestTime(
+          3, values, [](vector<float> &v) { radixSort(v, 1); }, single);
+      double parallel_ms = bestTime(
+          3, values, [](vector<float> &v) { radixSort(v); }, parallel);
+
+      if (single != expected or parallel != expected) {
+        std::printf("radixSort result differs from std::sort\n");
+        return 1;
+      }
+      std::printf("%12zu %10s %14.2f %12.2f %12.2f %8.1fx\n", size,
+                  kind == 0 ? "uniform" : "small int", std_ms, single_ms,
+                  parallel_ms, std_ms / parallel_ms);
+    }
+  }
+  return 0;
+}
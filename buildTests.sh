@@ -42,7 +42,7 @@ build_test() {
 echo "Starting test builds..."
 
 build_test "test_operations" \
-  "test_operations.cpp ../../src/operations.cpp" \
+  "test_operations.cpp ../../src/graph.cpp ../../src/operations.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/window.cpp ../../src/sketch.cpp ../../src/sort.cpp ../../src/topk.cpp ../../src/histogram.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../src/parser.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
   "operations"
 
 build_test "test_graph" \
@@ -50,11 +50,59 @@ build_test "test_graph" \
   "graph"
 
 build_test "test_parser" \
-  "test_parser.cpp ../../src/graph.cpp ../../src/parser.cpp ../../src/operations.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
+  "test_parser.cpp ../../src/graph.cpp ../../src/parser.cpp ../../src/operations.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/window.cpp ../../src/sketch.cpp ../../src/sort.cpp ../../src/topk.cpp ../../src/histogram.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
   "parser"
 
 build_test "test_utils" \
-  "test_utils.cpp ../../src/graph.cpp ../../src/operations.cpp ../../src/utils.cpp ../../src/parser.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
+  "test_utils.cpp ../../src/graph.cpp ../../src/operations.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/window.cpp ../../src/sketch.cpp ../../src/sort.cpp ../../src/topk.cpp ../../src/histogram.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../src/expr.cpp ../../src/plan.cpp ../../src/utils.cpp ../../src/parser.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
   "utils"
 
+build_test "test_column" \
+  "test_column.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "column"
+
+build_test "test_executor" \
+  "test_executor.cpp ../../src/executor.cpp ../../src/join.cpp ../../src/plan.cpp ../../src/graph.cpp ../../src/operations.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/window.cpp ../../src/sketch.cpp ../../src/sort.cpp ../../src/topk.cpp ../../src/histogram.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../src/expr.cpp ../../src/utils.cpp ../../src/parser.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
+  "executor"
+
+build_test "test_plan" \
+  "test_plan.cpp ../../src/plan.cpp ../../src/graph.cpp ../../src/parser.cpp ../../src/operations.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/window.cpp ../../src/sketch.cpp ../../src/sort.cpp ../../src/topk.cpp ../../src/histogram.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../src/expr.cpp ../../libs/Tiny_Yaml/yaml/yaml.cpp" \
+  "plan"
+
+build_test "test_sketch" \
+  "test_sketch.cpp ../../src/sketch.cpp ../../src/kernels.cpp" \
+  "sketch"
+
+build_test "test_groupby" \
+  "test_groupby.cpp ../../src/groupby.cpp ../../src/filter.cpp ../../src/column.cpp ../../src/kernels.cpp ../../src/sketch.cpp" \
+  "groupby"
+
+build_test "test_filter" \
+  "test_filter.cpp ../../src/filter.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "filter"
+
+build_test "test_expr" \
+  "test_expr.cpp ../../src/expr.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "expr"
+
+build_test "test_window" \
+  "test_window.cpp ../../src/window.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "window"
+
+build_test "test_sort" \
+  "test_sort.cpp ../../src/sort.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "sort"
+
+build_test "test_join" \
+  "test_join.cpp ../../src/join.cpp ../../src/sketch.cpp ../../src/kernels.cpp" \
+  "join"
+
+build_test "test_topk" \
+  "test_topk.cpp ../../src/topk.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "topk"
+
+build_test "test_histogram" \
+  "test_histogram.cpp ../../src/histogram.cpp ../../src/column.cpp ../../src/kernels.cpp" \
+  "histogram"
+
 echo "All tests built successfully!"
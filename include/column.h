@@ -0,0 +1,216 @@
+#ifndef COLUMN_H
+#define COLUMN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Маска валидности столбца: бит i установлен, если в строке i есть
+ * значение. Пустая маска (words.empty()) означает, что пропусков нет
+ */
+struct Bitmap {
+  vector<uint64_t> words; // слова по 64 бита, младший бит - младшая строка
+  size_t length = 0;      // количество строк, описываемых маской
+};
+
+/**
+ * @brief Перечисление способов хранения значений столбца
+ */
+enum ColumnLayout {
+  DENSE,  // значение на каждую строку таблицы, пропуски отмечены в маске
+  SPARSE, // только присутствующие значения и номера их строк
+};
+
+/**
+ * @brief Доля присутствующих значений, ниже которой столбец хранится
+ * разреженно
+ */
+const double SPARSE_DENSITY = 0.25;
+
+/**
+ * @brief Числовой столбец таблицы, выровненный по строкам
+ */
+struct NumericColumn {
+  size_t length = 0;           // количество строк таблицы
+  ColumnLayout layout = DENSE; // способ хранения
+  vector<float> values;        // DENSE: length значений, 0 на месте пропусков;
+                               // SPARSE: только присутствующие
+  vector<uint32_t> rows;       // SPARSE: номера строк значений из values
+  Bitmap validity;             // DENSE: маска присутствующих значений
+};
+
+/**
+ * @brief Строковый столбец таблицы, выровненный по строкам
+ */
+struct StringColumn {
+  size_t length = 0;           // количество строк таблицы
+  ColumnLayout layout = DENSE; // способ хранения
+  vector<string> values;       // DENSE: length значений, "" на месте пропусков;
+                               // SPARSE: только присутствующие
+  vector<uint32_t> rows;       // SPARSE: номера строк значений из values
+  Bitmap validity;             // DENSE: маска присутствующих значений
+};
+
+/**
+ * @brief Невладеющее представление числовых данных: непрерывный буфер значений
+ * и маска валидности. Не копирует данные и должно жить не дольше источника
+ */
+struct NumericView {
+  const float *values = nullptr;      // значения
+  const uint64_t *validity = nullptr; // слова маски или nullptr без пропусков
+  size_t length = 0;                  // количество значений
+  const uint32_t *rows = nullptr; // номера строк значений или nullptr, если
+                                  // i-е значение в строке i
+  size_t row_count = 0;           // количество строк таблицы в данных
+
+  NumericView() = default;
+
+  /**
+   * @brief Представление произвольного буфера
+   * @param values значения
+   * @param validity слова маски или nullptr
+   * @param length количество значений
+   */
+  NumericView(const float *values, const uint64_t *validity, size_t length);
+
+  /**
+   * @brief Представление вектора значений без пропусков
+   * @param values значения
+   */
+  NumericView(const vector<float> &values);
+
+  /**
+   * @brief Представление присутствующих значений столбца (для разреженного
+   * столбца - упакованные значения с номерами их строк)
+   * @param column столбец
+   */
+  NumericView(const NumericColumn &column);
+};
+
+/**
+ * @brief Невладеющее представление строковых данных: непрерывный буфер строк
+ * и маска валидности. Не копирует данные и должно жить не дольше источника
+ */
+struct StringView {
+  const string *values = nullptr;     // строки
+  const uint64_t *validity = nullptr; // слова маски или nullptr без пропусков
+  size_t length = 0;                  // количество строк
+  const uint32_t *rows = nullptr; // номера строк строк или nullptr, если
+                                  // i-е значение в строке i
+  size_t row_count = 0;           // количество строк таблицы в данных
+
+  StringView() = default;
+
+  /**
+   * @brief Представление произвольного буфера
+   * @param values строки
+   * @param validity слова маски или nullptr
+   * @param length количество строк
+   */
+  StringView(const string *values, const uint64_t *validity, size_t length);
+
+  /**
+   * @brief Представление вектора строк без пропусков
+   * @param values строки
+   */
+  StringView(const vector<string> &values);
+
+  /**
+   * @brief Представление присутствующих строк столбца (для разреженного
+   * столбца - упакованные строки с номерами их строк)
+   * @param column столбец
+   */
+  StringView(const StringColumn &column);
+};
+
+/**
+ * @brief Создать маску валидности без установленных битов
+ * @param length количество строк
+ * @return маска валидности
+ */
+Bitmap createBitmap(size_t length);
+
+/**
+ * @brief Отметить строку как содержащую значение
+ * @param bitmap маска валидности
+ * @param index номер строки
+ */
+void setBit(Bitmap &bitmap, size_t index);
+
+/**
+ * @brief Проверить, есть ли значение в строке
+ * @param bitmap маска валидности
+ * @param index номер строки
+ * @return true, если значение присутствует (или маска пуста), false - иначе
+ */
+bool testBit(const Bitmap &bitmap, size_t index);
+
+/**
+ * @brief Подсчитать количество присутствующих значений
+ * @param bitmap маска валидности
+ * @return количество установленных битов (length для пустой маски)
+ */
+size_t countBits(const Bitmap &bitmap);
+
+/**
+ * @brief Собрать числовой столбец, выбрав способ хранения по плотности
+ * @param values значения по строкам (length штук)
+ * @param validity маска присутствующих значений
+ * @return столбец в плотном или разреженном представлении
+ */
+NumericColumn makeNumericColumn(vector<float> values, Bitmap validity);
+
+/**
+ * @brief Собрать строковый столбец, выбрав способ хранения по плотности
+ * @param values значения по строкам (length штук)
+ * @param validity маска присутствующих значений
+ * @return столбец в плотном или разреженном представлении
+ */
+StringColumn makeStringColumn(vector<string> values, Bitmap validity);
+
+/**
+ * @brief Получить слова маски для передачи в вычислительные ядра
+ * @param column числовой столбец
+ * @return указатель на слова маски или nullptr, если все значения из values
+ * присутствуют
+ */
+const uint64_t *validityWords(const NumericColumn &column);
+
+/**
+ * @brief Получить слова маски для передачи в вычислительные ядра
+ * @param column строковый столбец
+ * @return указатель на слова маски или nullptr, если все значения из values
+ * присутствуют
+ */
+const uint64_t *validityWords(const StringColumn &column);
+
+/**
+ * @brief Подсчитать количество присутствующих значений столбца
+ * @param column числовой столбец
+ * @return количество значений
+ */
+size_t presentCount(const NumericColumn &column);
+
+/**
+ * @brief Подсчитать количество присутствующих значений столбца
+ * @param column строковый столбец
+ * @return количество значений
+ */
+size_t presentCount(const StringColumn &column);
+
+/**
+ * @brief Проверить, присутствует ли значение в представлении
+ * @param validity слова маски или nullptr
+ * @param index номер значения
+ * @return true, если значение присутствует
+ */
+inline bool isPresent(const uint64_t *validity, size_t index) {
+  return !validity or ((validity[index / 64] >> (index % 64)) & 1);
+}
+
+#endif // !COLUMN_H
@@ -0,0 +1,94 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "graph.h"
+#include "operations.h"
+#include "parser.h"
+#include "plan.h"
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace executor {
+
+/*
+ * @brief Получить список файлов данных по пути из конфигурации
+ * @param path путь к файлу, директории (все файлы .csv) или шаблон имени
+ * файла (*, ?, [...]) внутри директории
+ * @return отсортированный вектор путей к файлам
+ */
+vector<string> resolveShards(const string &path);
+
+/*
+ * @brief Выполнить операции над одной таблицей и таблицами конфигурации
+ * @param source таблица
+ * @param tasks операции
+ * @param cache кэш результатов запуска
+ * @param reused_from id операции -> id операции, чей результат взят из кэша
+ * @param failed id операции -> ошибка выполнения
+ * @return частичный результат для каждого id операции
+ */
+map<string, plan::SharedResult>
+runTable(table::Table &source, const vector<plan::Task> &tasks,
+         plan::Cache &cache, map<string, string> *reused_from = nullptr,
+         map<string, string> *failed = nullptr);
+
+/*
+ * @brief Обработать файлы данных параллельно и объединить частичные
+ * результаты в порядке файлов
+ * @param shards пути к файлам данных
+ * @param tasks операции
+ * @param workers количество потоков (0 - по числу ядер)
+ * @param reused_from id операции -> id операции, чей результат взят из кэша
+ * @param failed id операции -> ошибка выполнения
+ * @return объединенный частичный результат для каждого id операции
+ */
+map<string, plan::SharedResult>
+runShards(const vector<string> &shards, const vector<plan::Task> &tasks,
+          unsigned workers = 0, map<string, string> *reused_from = nullptr,
+          map<string, string> *failed = nullptr);
+
+/*
+ * @brief Вычислить результаты всех операций графа, просматривая каждый
+ * столбец один раз
+ * @param shards пути к файлам данных (пустой вектор - текущая таблица)
+ */
+void run(const vector<string> &shards);
+
+/*
+ * @brief Собрать входные данные операции из результатов предыдущих узлов:
+ * числа дают числовой вход, а строки и столбцы - строковый (числа при этом
+ * записываются как текст). Столбцы читаются без копирования
+ * @param sources узлы, чьи результаты читает операция
+ * @param needs что вычислить, кроме суммы и количества
+ * @return частичный результат (тип UNKNOWN, если у источника нет результата)
+ */
+PartialResult upstreamState(const vector<Node *> &sources,
+                            const StateNeeds &needs);
+
+/*
+ * @brief Процедура записи объединенного результата операции в узле графа.
+ * Результат сохраняется в узле, чтобы его могли прочитать следующие узлы
+ * @param node указатель на узел графа
+ */
+void writeMerged(Node *node);
+
+/*
+ * @brief Получить количество операций, пропущенных при записи результатов
+ * (ошибки конфигурации и выполнения, нет результата, неизвестный тип)
+ * @return количество пропусков с последней очистки
+ */
+size_t skipped();
+
+/*
+ * @brief Очистить объединенные результаты и кэш
+ */
+void clear();
+
+}; // namespace executor
+
+#endif // !EXECUTOR_H
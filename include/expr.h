@@ -0,0 +1,84 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "column.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/*
+ * Выражения над числовыми столбцами (например, col[2] * 1.2 + col[0]).
+ * Выражение разбирается один раз и компилируется в байт-код стековой
+ * машины. Каждая инструкция выполняется сразу над пакетом строк простым
+ * циклом, поэтому стоимость интерпретации делится на весь пакет.
+ */
+
+/**
+ * @brief Количество строк пакета (кратно 64 - размеру слова маски)
+ */
+const size_t EXPR_BATCH = 2048;
+
+/**
+ * @brief Перечисление инструкций байт-кода выражения
+ */
+enum ExprOp : uint8_t {
+  PUSH_COLUMN, // положить на стек столбец slot
+  PUSH_CONST,  // положить на стек константу value
+  ADD,         // сложить два верхних значения стека
+  SUB,         // вычесть верхнее значение из предыдущего
+  MUL,         // умножить два верхних значения
+  DIV,         // разделить предыдущее значение на верхнее
+  NEG,         // сменить знак верхнего значения
+  ADD_CONST,   // прибавить к верхнему значению константу value
+  SUB_CONST,   // вычесть из верхнего значения константу value
+  MUL_CONST,   // умножить верхнее значение на константу value
+  DIV_CONST,   // разделить верхнее значение на константу value
+};
+
+/**
+ * @brief Инструкция байт-кода
+ */
+struct ExprInstruction {
+  ExprOp op = PUSH_CONST; // инструкция
+  uint32_t slot = 0;      // PUSH_COLUMN: номер столбца в ExprProgram.columns
+  float value = 0;        // константа инструкций *_CONST и PUSH_CONST
+};
+
+/**
+ * @brief Скомпилированное выражение
+ */
+struct ExprProgram {
+  string text;                  // исходный текст выражения
+  vector<ExprInstruction> code; // байт-код
+  vector<int> columns;          // номера столбцов таблицы по слотам
+  size_t depth = 0;             // наибольшая глубина стека
+};
+
+/**
+ * @brief Разобрать и скомпилировать выражение. Поддерживаются числа,
+ * столбцы col[N], операции + - * /, унарный минус и скобки
+ * @param text текст выражения
+ * @param program скомпилированное выражение (заполняется)
+ * @param error описание ошибки разбора (заполняется при ошибке)
+ * @return true, если выражение скомпилировано
+ */
+bool compileExpression(const string &text, ExprProgram &program,
+                       string &error);
+
+/**
+ * @brief Вычислить выражение по пакетам строк. Значение строки отсутствует,
+ * если в строке нет значения хотя бы одного столбца выражения
+ * @param program скомпилированное выражение
+ * @param columns столбцы по слотам program.columns
+ * @param length количество строк таблицы
+ * @return производный столбец, выровненный по строкам таблицы
+ */
+NumericColumn evaluateExpression(const ExprProgram &program,
+                                 const vector<const NumericColumn *> &columns,
+                                 size_t length);
+
+#endif // !EXPR_H
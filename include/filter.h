@@ -0,0 +1,78 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "column.h"
+#include <cstddef>
+#include <string>
+
+using std::string;
+
+/*
+ * Отбор строк по условию. Результат - маска выбранных строк таблицы, а не
+ * копия строк: агрегаты получают ее вместо маски валидности и обрабатывают
+ * только выбранные значения теми же вычислительными ядрами.
+ */
+
+/**
+ * @brief Перечисление операций сравнения условия отбора
+ */
+enum CompareOp {
+  EQUAL,         // ==
+  NOT_EQUAL,     // !=
+  LESS,          // <
+  LESS_EQUAL,    // <=
+  GREATER,       // >
+  GREATER_EQUAL, // >=
+};
+
+/**
+ * @brief Разобрать операцию сравнения
+ * @param text запись операции (==, !=, <, <=, >, >=)
+ * @param op операция (заполняется)
+ * @return true, если запись распознана
+ */
+bool parseCompare(const string &text, CompareOp &op);
+
+/**
+ * @brief Отобрать строки числового столбца, значение которых удовлетворяет
+ * условию. Строки без значения не выбираются
+ * @param column столбец
+ * @param op операция сравнения
+ * @param value значение справа от операции
+ * @return маска выбранных строк таблицы (length строк столбца)
+ */
+Bitmap compareColumn(const NumericColumn &column, CompareOp op, float value);
+
+/**
+ * @brief Отобрать строки строкового столбца, значение которых удовлетворяет
+ * условию (строки сравниваются лексикографически). Строки без значения не
+ * выбираются
+ * @param column столбец
+ * @param op операция сравнения
+ * @param value значение справа от операции
+ * @return маска выбранных строк таблицы (length строк столбца)
+ */
+Bitmap compareColumn(const StringColumn &column, CompareOp op,
+                     const string &value);
+
+/**
+ * @brief Получить маску значений столбца, которые присутствуют и выбраны:
+ * маска выровнена по column.values и передается ядрам вместо маски
+ * валидности
+ * @param column числовой столбец
+ * @param selection маска выбранных строк таблицы
+ * @return маска длины column.values.size()
+ */
+Bitmap selectedMask(const NumericColumn &column, const Bitmap &selection);
+
+/**
+ * @brief Получить маску значений столбца, которые присутствуют и выбраны:
+ * маска выровнена по column.values и передается ядрам вместо маски
+ * валидности
+ * @param column строковый столбец
+ * @param selection маска выбранных строк таблицы
+ * @return маска длины column.values.size()
+ */
+Bitmap selectedMask(const StringColumn &column, const Bitmap &selection);
+
+#endif // !FILTER_H
@@ -1,15 +1,40 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "column.h"
+#include <memory>
 #include <string>
 #include <vector>
 
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
 struct Adjent;
 struct Node;
 
+/**
+ * @brief Перечисление видов результата узла графа
+ */
+enum OutputKind {
+  NO_OUTPUT,     // узел еще не выполнен или не дает результата
+  NUMBER_OUTPUT, // числовой скаляр
+  TEXT_OUTPUT,   // строковый скаляр
+  COLUMN_OUTPUT, // производный столбец
+};
+
+/**
+ * @brief Результат узла, который читают следующие узлы графа. Столбец не
+ * копируется: узел и все его потребители владеют одним буфером через счетчик
+ * ссылок
+ */
+struct NodeOutput {
+  OutputKind kind = NO_OUTPUT;           // вид результата
+  float number = 0;                      // NUMBER_OUTPUT: значение
+  string text;                           // TEXT_OUTPUT: значение
+  shared_ptr<const StringColumn> column; // COLUMN_OUTPUT: столбец
+};
+
 /**
  * @brief Структура элемента списка заголовков
  */
@@ -17,7 +42,10 @@ struct Node {
   string id;
   Adjent *adjency_list_head;
   Adjent *adjency_list_tail;
-  Node *next_head; // Указатель на следующую вершину в списке заголовков
+  Node *next_head;   // Указатель на следующую вершину в списке заголовков
+  NodeOutput output; // Результат узла для следующих узлов
+  int task;          // Номер операции в скомпилированном плане (-1 - не
+                     // найден)
 };
 
 /**
@@ -88,6 +116,13 @@ Node *getNodeById(string id);
  */
 vector<Node *> adjentNodes(Node *node);
 
+/**
+ * @brief Получает вектор всех узлов, из которых есть связь в указанный узел
+ * @param node Указатель на узел
+ * @return Вектор указателей на предыдущие узлы в порядке списка заголовков
+ */
+vector<Node *> parentNodes(Node *node);
+
 /**
  * @brief Связать узел с другими
  * @param node указатель на узел
@@ -103,6 +138,14 @@ void connect(Node *node, vector<Node *> to_another_nodes);
  */
 void connect(string id, vector<string> to_another_ids);
 
+/**
+ * @brief Связать два узла графа без поиска в списке заголовков (для
+ * массового построения графа): оба узла уже должны быть добавлены в граф
+ * @param node указатель на узел
+ * @param to_node узел, в который нужно попасть из node
+ */
+void link(Node *node, Node *to_node);
+
 /**
  * @brief Добавляет новый узел в граф, не связывая его с другими узлами
  * @param node Указатель на добавляемый узел
@@ -132,4 +175,12 @@ bool graphIsEmpty();
  */
 void deepFirstSearch(void (*procedure)(Node *node));
 
+/**
+ * @brief Пройти по всем узлам графа так, чтобы каждый узел посещался после
+ * всех предыдущих узлов: обход в глубину от каждого узла без входящих
+ * связей, который откладывает узел до посещения последнего из его родителей
+ * @param procedure указатель на функцию операции над узлом
+ */
+void topologicalSearch(void (*procedure)(Node *node));
+
 #endif // !GRAPH_H
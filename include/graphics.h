@@ -61,4 +61,20 @@ const string INSRUCTIONS = R"(
   ╚══════════════════════════════════════════════════════════════════════════════╝
 )";
 
+const string USAGE = R"(Использование:
+  SimpleDAG.out                       интерактивный режим
+  SimpleDAG.out --config <yaml> [--scheme <файл>] [--data <директория>]
+                [--output <файл>]     пакетный режим без ввода
+
+  --config   путь к YAML-конфигурации
+  --scheme   файл схемы графа в формате 1->2->3 (строка на цепочку); без
+             него граф строится по полям depends_on конфигурации
+  --data     директория с файлами данных (по умолчанию data)
+  --output   файл результатов (по умолчанию файл с датой в директории данных)
+  --help     показать эту справку
+
+Коды завершения: 0 - успех, 2 - неверные аргументы, 3 - ошибка
+конфигурации, 4 - ошибка данных, 5 - ошибка схемы, 6 - ошибка файла
+результатов, 7 - операции с ошибками пропущены)";
+
 #endif // !GRAPHICS_H
@@ -0,0 +1,75 @@
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include "column.h"
+#include "kernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Слот хэш-таблицы групп: хэш ключа хранится рядом с номером группы,
+ * поэтому пробирование читает один непрерывный массив
+ */
+struct GroupSlot {
+  uint64_t hash = 0;  // хэш ключа группы
+  uint32_t group = 0; // номер группы + 1 (0 - пустой слот)
+};
+
+/**
+ * @brief Хэш-таблица групп с открытой адресацией и линейным пробированием.
+ * Ключи и состояния групп хранятся в порядке первого появления ключа, а
+ * таблицы частей данных объединяются groupMerge
+ */
+struct GroupTable {
+  bool moments = false;    // вычислять моменты, а не только сумму и экстремумы
+  vector<GroupSlot> slots; // слоты (размер - степень двойки)
+  vector<string> keys;     // ключи групп
+  vector<Moments> states;  // агрегаты групп
+};
+
+/**
+ * @brief Создать пустую таблицу групп
+ * @param moments вычислять ли моменты (для дисперсии и асимметрии)
+ * @return таблица
+ */
+GroupTable createGroupTable(bool moments);
+
+/**
+ * @brief Найти группу по ключу, создав ее при отсутствии
+ * @param table таблица групп
+ * @param key ключ
+ * @param hash хэш ключа (hashBytes)
+ * @return номер группы
+ */
+size_t groupOf(GroupTable &table, const string &key, uint64_t hash);
+
+/**
+ * @brief Добавить таблицу следующей части данных: группы из from, которых
+ * нет в into, добавляются в конец в порядке from
+ * @param into накапливаемая таблица
+ * @param from таблица следующей части
+ */
+void groupMerge(GroupTable &into, const GroupTable &from);
+
+/**
+ * @brief Сгруппировать значения числового столбца по ключам другого столбца.
+ * Строки делятся между потоками, каждый поток заполняет свою таблицу, затем
+ * таблицы объединяются в порядке строк. Строки без значения или без ключа
+ * пропускаются
+ * @param values столбец значений
+ * @param keys столбец ключей (выровнен по тем же строкам)
+ * @param moments вычислять ли моменты
+ * @param workers количество потоков (0 - по числу ядер)
+ * @param selection маска выбранных строк таблицы или nullptr (все строки)
+ * @return таблица групп
+ */
+GroupTable groupAggregate(const NumericColumn &values, const StringColumn &keys,
+                          bool moments, unsigned workers = 0,
+                          const Bitmap *selection = nullptr);
+
+#endif // !GROUPBY_H
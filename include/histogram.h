@@ -0,0 +1,74 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+/**
+ * @brief Количество корзин гистограммы по умолчанию (параметр bins)
+ */
+const size_t DEFAULT_BINS = 10;
+
+/**
+ * @brief Наибольшее количество корзин: счетчики корзин выделяются в каждом
+ * потоке
+ */
+const size_t MAX_BINS = 1 << 16;
+
+/**
+ * @brief Параметры гистограммы: количество корзин и диапазон. Без
+ * заданного диапазона границы берутся из минимума и максимума данных
+ */
+struct HistogramSpec {
+  size_t bins = DEFAULT_BINS; // количество корзин
+  bool fixed = false;         // диапазон задан параметрами min и max
+  float min = 0;              // нижняя граница заданного диапазона
+  float max = 0;              // верхняя граница заданного диапазона
+
+  bool operator==(const HistogramSpec &other) const {
+    return bins == other.bins and fixed == other.fixed and
+           (!fixed or (min == other.min and max == other.max));
+  }
+};
+
+/**
+ * @brief Гистограмма части данных: счетчики равных корзин диапазона
+ * [min, max] и количество присутствующих значений вне диапазона
+ */
+struct HistogramState {
+  HistogramSpec spec;      // параметры гистограммы
+  float min = INFINITY;    // нижняя граница корзин
+  float max = -INFINITY;   // верхняя граница корзин
+  vector<uint64_t> counts; // счетчики корзин (пусто - значений не было)
+  size_t outside = 0;      // значения вне диапазона и NaN
+};
+
+/**
+ * @brief Добавить присутствующие значения. Без заданного диапазона границы
+ * берутся из предварительного прохода по минимуму и максимуму. Каждый
+ * поток считает свою часть столбца в собственный массив счетчиков,
+ * отделенный от соседних строкой кэша, и массивы складываются в конце
+ * @param state гистограмма
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void histogramInsert(HistogramState &state, const float *values,
+                     const uint64_t *validity, size_t length,
+                     unsigned workers = 0);
+
+/**
+ * @brief Добавить гистограмму следующей части данных. Если границы частей
+ * различаются (диапазон из данных), корзины переносятся в объединенный
+ * диапазон по своим серединам, поэтому результат приближенный
+ * @param into накапливаемая гистограмма
+ * @param from гистограмма следующей части
+ */
+void histogramMerge(HistogramState &into, const HistogramState &from);
+
+#endif // !HISTOGRAM_H
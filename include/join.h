@@ -0,0 +1,61 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include "parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+/**
+ * @brief Фильтр Блума по хэшам ключей: отвечает "ключа точно нет" без
+ * обращения к хэш-таблице. Три позиции бита берутся из одного 64-битного
+ * хэша (двойное хэширование), около 10 бит на ключ
+ */
+struct BloomFilter {
+  vector<uint64_t> words; // биты фильтра (количество - степень двойки)
+};
+
+/**
+ * @brief Создать пустой фильтр Блума
+ * @param keys ожидаемое количество ключей
+ * @return фильтр
+ */
+BloomFilter createBloom(size_t keys);
+
+/**
+ * @brief Добавить ключ в фильтр
+ * @param filter фильтр
+ * @param hash хэш ключа (hashBytes)
+ */
+void bloomInsert(BloomFilter &filter, uint64_t hash);
+
+/**
+ * @brief Проверить, может ли ключ быть в фильтре
+ * @param filter фильтр
+ * @param hash хэш ключа (hashBytes)
+ * @return false, если ключа точно нет
+ */
+bool bloomContains(const BloomFilter &filter, uint64_t hash);
+
+/**
+ * @brief Хэш-соединение (inner join) двух таблиц по равенству полей-ключей.
+ * Хэш-таблица строится по меньшей таблице, а строки большей делятся между
+ * потоками и проверяются сначала фильтром Блума, затем хэш-таблицей. Строки
+ * результата идут в порядке строк большей таблицы (совпадения - в порядке
+ * меньшей) и состоят из полей левой строки, дополненных пропусками до
+ * ширины левой таблицы, и полей правой строки. Ключи сравниваются как
+ * текст, строки без ключа не соединяются
+ * @param left левая таблица
+ * @param left_key столбец ключа левой таблицы
+ * @param right правая таблица
+ * @param right_key столбец ключа правой таблицы
+ * @param workers количество потоков (0 - по числу ядер)
+ * @return строки соединения
+ */
+vector<vector<string>> hashJoin(const table::Table &left, int left_key,
+                                const table::Table &right, int right_key,
+                                unsigned workers = 0);
+
+#endif // !JOIN_H
@@ -0,0 +1,187 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/*
+ * Вычислительные ядра агрегаций над непрерывными буферами значений.
+ * Пропуски задаются маской валидности (бит i - значение i присутствует) и
+ * учитываются без ветвлений: отсутствующие значения обнуляются маской.
+ * Маска nullptr означает, что присутствуют все значения.
+ */
+
+/**
+ * @brief Размер части буфера, которая обрабатывается целиком в кэше процессора
+ * при вычислении моментов (кратен 64 - размеру слова маски)
+ */
+const size_t MOMENTS_CHUNK = 4096;
+
+/**
+ * @brief Моменты и экстремумы присутствующих значений. Состояния частей
+ * данных объединяются mergeMoments (формулы Чана), поэтому порядок и размер
+ * частей не влияют на устойчивость результата
+ */
+struct Moments {
+  size_t count = 0;      // количество значений
+  double sum = 0;        // сумма значений
+  double mean = 0;       // среднее
+  double m2 = 0;         // сумма квадратов отклонений от среднего
+  double m3 = 0;         // сумма кубов отклонений от среднего
+  float min = INFINITY;  // минимум
+  float max = -INFINITY; // максимум
+};
+
+/**
+ * @brief Сумма присутствующих значений
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return сумма
+ */
+double maskedSum(const float *values, const uint64_t *validity, size_t length);
+
+/**
+ * @brief Количество присутствующих значений
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return количество установленных битов
+ */
+size_t maskedCount(const uint64_t *validity, size_t length);
+
+/**
+ * @brief Моменты и экстремумы присутствующих значений за один проход по
+ * памяти: каждая часть из MOMENTS_CHUNK значений сначала суммируется, а затем,
+ * пока находится в кэше, дает отклонения от своего среднего
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return моменты
+ */
+Moments maskedMoments(const float *values, const uint64_t *validity,
+                      size_t length);
+
+/**
+ * @brief Добавить моменты следующей части данных (формулы Чана)
+ * @param into накапливаемые моменты
+ * @param from моменты следующей части
+ */
+void mergeMoments(Moments &into, const Moments &from);
+
+/**
+ * @brief Добавить одно значение к моментам (обновление Уэлфорда)
+ * @param into накапливаемые моменты
+ * @param value значение
+ */
+void addMoment(Moments &into, float value);
+
+/**
+ * @brief Накопленная сумма присутствующих значений: out[i] - сумма
+ * присутствующих значений с номерами от 0 до i. Сумма накапливается в
+ * двойной точности
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param out указатель на результат (length значений)
+ */
+void maskedPrefixSum(const float *values, const uint64_t *validity,
+                     size_t length, float *out);
+
+/**
+ * @brief Минимум и максимум присутствующих значений (NaN пропускаются)
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param min минимум (INFINITY, если значений нет)
+ * @param max максимум (-INFINITY, если значений нет)
+ */
+void maskedRange(const float *values, const uint64_t *validity, size_t length,
+                 float &min, float &max);
+
+/**
+ * @brief Добавить присутствующие значения из диапазона [min, max] в bins
+ * равных корзин: номера корзин четырех значений вычисляются за одну
+ * SIMD-операцию, значение max попадает в последнюю корзину. Значения вне
+ * диапазона и NaN не учитываются
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param min нижняя граница
+ * @param max верхняя граница
+ * @param bins количество корзин
+ * @param counts счетчики корзин (bins значений, увеличиваются)
+ */
+void maskedHistogram(const float *values, const uint64_t *validity,
+                     size_t length, float min, float max, size_t bins,
+                     uint64_t *counts);
+
+/**
+ * @brief Пока объект жив, текущий поток считается рабочим потоком
+ * параллельной части (файла набора или части parallelChunks): ядра в нем
+ * выполняются в одном потоке, чтобы вложенный параллелизм не порождал N×N
+ * потоков
+ */
+struct WorkerThreadScope {
+  bool previous; // отметка потока до создания объекта
+
+  explicit WorkerThreadScope(bool active = true);
+  ~WorkerThreadScope();
+};
+
+/**
+ * @brief Количество потоков для параллельного ядра
+ * @param workers запрошенное количество (0 - по числу ядер)
+ * @return 1 в рабочем потоке параллельной части, иначе workers или число
+ * ядер
+ */
+unsigned resolveWorkers(unsigned workers);
+
+/**
+ * @brief Выполнить функцию над частями диапазона в нескольких потоках.
+ * Исключение потока передается вызывающему после завершения всех потоков
+ * @param workers количество потоков (0 - resolveWorkers(0); состояние
+ * потоков вызывающий готовит по уже разрешенному количеству)
+ * @param size размер диапазона
+ * @param body функция (номер потока, начало, конец)
+ */
+template <typename Body>
+void parallelChunks(unsigned workers, size_t size, Body body) {
+  if (workers == 0)
+    workers = resolveWorkers(0);
+  size_t chunk = (size + workers - 1) / workers;
+  std::vector<std::thread> pool;
+  std::vector<std::exception_ptr> errors(workers);
+
+  for (unsigned w = 1; w < workers; w++) {
+    size_t begin = std::min(size, w * chunk);
+    size_t end = std::min(size, (w + 1) * chunk);
+    pool.emplace_back([&body, &errors, w, begin, end]() {
+      WorkerThreadScope scope;
+      try {
+        body(w, begin, end);
+      } catch (...) {
+        errors[w] = std::current_exception();
+      }
+    });
+  }
+  try {
+    WorkerThreadScope scope(workers > 1);
+    body(0, 0, std::min(size, chunk));
+  } catch (...) {
+    errors[0] = std::current_exception();
+  }
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+  for (const std::exception_ptr &error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+}
+
+#endif // !KERNELS_H
@@ -1,71 +1,563 @@
 #ifndef OPERATIONS_H
 #define OPERATIONS_H
 
-#include <functional>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
-#include <variant>
 #include <vector>
 
+#include "column.h"
+#include "filter.h"
+#include "groupby.h"
+#include "histogram.h"
+#include "kernels.h"
 #include "parser.h"
+#include "sketch.h"
+#include "sort.h"
+#include "topk.h"
 
-using std::function;
 using std::map;
+using std::shared_ptr;
 using std::string;
-using std::variant;
 using std::vector;
 
+/**
+ * @brief Параметры операции из конфигурации (имя -> значение)
+ */
+typedef map<string, string> Params;
+
+/**
+ * @brief Часть строкового результата без копии строк: общий буфер столбца
+ * таблицы и маска его значений
+ */
+struct TextPiece {
+  shared_ptr<const StringColumn> column; // столбец (общий буфер)
+  Bitmap mask; // маска column->values (пустая - маска валидности столбца)
+};
+
+/**
+ * @brief Частичный результат операции над частью данных (например, над одним
+ * файлом из набора). Частичные результаты объединяются mergePartial и
+ * завершаются функциями из таблицы операций
+ */
+struct PartialResult {
+  ColumnType type = UNKNOWN; // тип столбца в обработанных данных
+  double sum = 0;            // сумма присутствующих значений
+  size_t count = 0;          // количество присутствующих значений
+  string text;               // объединение строк в порядке частей
+  vector<TextPiece> pieces;  // строки для потоковой записи в порядке частей
+  Moments moments;           // моменты, если они нужны операциям
+  QuantileSketch sketch;     // скетч квантилей, если он нужен операциям
+  vector<float> values;      // присутствующие значения по возрастанию для
+                             // точных квантилей
+  DistinctSketch distinct;   // скетч уникальных строк, если он нужен
+  DistinctSet distinct_set;  // точное множество уникальных строк
+  GroupTable groups;         // агрегаты по группам для параметра group_by
+  SortState sorted;          // отсортированные серии для сортировки
+  TopKState top;             // наибольшие значения и частоты для top_k
+  TopKState bottom;          // наименьшие значения и частоты для top_k
+  size_t rows = 0;           // строк таблицы в частях: сдвиг номеров строк
+                             // top_k следующей части
+  vector<HistogramState> histograms; // гистограммы по параметрам
+
+  // производный столбец преобразования: общий буфер таблицы, который узел
+  // передает следующим узлам графа (mergePartial его не объединяет)
+  shared_ptr<const StringColumn> column;
+};
+
+/**
+ * @brief Что, кроме суммы и количества, нужно вычислить за проход по столбцу
+ */
+struct StateNeeds {
+  bool moments = false;      // моменты и экстремумы
+  size_t sketch = 0;         // точность скетча квантилей (0 - скетч не нужен)
+  bool values = false;       // копия присутствующих значений
+  bool text = false;         // объединение строк
+  bool stream = false;       // части строк для потоковой записи
+  bool distinct = false;     // скетч уникальных строк
+  bool distinct_set = false; // точное множество уникальных строк
+  size_t sort = 0; // бюджет памяти сортировки (0 - сортировка не нужна)
+  size_t top_k = 0;    // количество наибольших значений (0 - не нужны)
+  size_t bottom_k = 0; // количество наименьших значений (0 - не нужны)
+  vector<HistogramSpec> histograms; // параметры нужных гистограмм
+};
+
+/**
+ * @brief Номер операции в таблице операций. Ключ операции разрешается в
+ * номер один раз при загрузке конфигурации, а дальнейшие вызовы обращаются
+ * к таблице по номеру без поиска по строке
+ */
+enum OperationId : uint8_t {
+  OP_SUM,
+  OP_AVERAGE,
+  OP_MIN,
+  OP_MAX,
+  OP_COUNT,
+  OP_VARIANCE,
+  OP_STDDEV,
+  OP_SKEWNESS,
+  OP_MEDIAN,
+  OP_P95,
+  OP_P99,
+  OP_QUANTILE,
+  OP_CONCATINATE,
+  OP_COUNT_DISTINCT_APPROX,
+  OP_COUNT_DISTINCT,
+  OP_FIND_REPLACE,
+  OP_FILTER,
+  OP_ROLLING_SUM,
+  OP_ROLLING_AVERAGE,
+  OP_CUMULATIVE_SUM,
+  OP_SORT,
+  OP_JOIN,
+  OP_TOP_K,
+  OP_HISTOGRAM,
+  OP_UNKNOWN, // неизвестная операция (последний элемент)
+};
+
 /*
- * @brief Определение возможных типов функций для словаря операций
+ * @brief Функции завершения операции с числовым и строковым результатом,
+ * преобразования столбца, отбора строк и оконной операции в таблице операций
  */
-using FunctionVariant =
-    variant<function<float(vector<float>)>,  // Функции для числовых данных
-            function<string(vector<string>)> // Функции для строковых данных
-            >;
+using NumericFinalize = float (*)(const PartialResult &, const Params &);
+using StringFinalize = string (*)(const PartialResult &, const Params &);
+using TransformCall = StringColumn (*)(const StringColumn &, const Params &);
+using FilterCall = Bitmap (*)(table::Table &, int, const Params &);
+using WindowCall = NumericColumn (*)(const NumericColumn &, const Params &);
 
 /**
- * @brief Словарь операций, поддерживающий различные типы данных через variant
- * Ключ: идентификатор операции
- * Значение: функция соответствующего типа
+ * @brief Запись таблицы операций: все, что нужно плану и исполнителю, чтобы
+ * вычислить и завершить операцию
+ */
+struct OperationInfo {
+  const char *name;        // ключ операции в конфигурации
+  ColumnType input;        // тип столбца, который принимает операция
+                           // (UNKNOWN - столбец любого типа в его типе)
+  ColumnType result;       // тип результата операции
+  bool groupable;          // вычисляется ли операция по группам
+  bool moments;            // нужны ли моменты и экстремумы
+  double quantile;         // уровень квантиля (0 - не квантиль, -1 - q)
+  NumericFinalize numeric; // завершение с числовым результатом
+  StringFinalize text;     // завершение со строковым результатом
+  TransformCall transform; // преобразование столбца
+  FilterCall filter;       // отбор строк
+  WindowCall window;       // оконная операция над числовым столбцом
+};
+
+/*
+ * @brief Разрешить ключ операции в номер (при загрузке конфигурации)
+ * @param op_name ключ операции
+ * @return номер операции или OP_UNKNOWN
+ */
+OperationId resolveOperation(const string &op_name);
+
+/*
+ * @brief Получить запись таблицы операций
+ * @param op номер операции
+ * @return запись (для OP_UNKNOWN - запись без функций с типом UNKNOWN)
+ */
+const OperationInfo &operationInfo(OperationId op);
+
+/*
+ * @brief Получить тип столбца, который принимает операция
+ * @param op номер операции
+ * @return NUMERIC, STRING или UNKNOWN для операции над столбцом любого типа
+ * и для неизвестной операции
+ */
+ColumnType operationInput(OperationId op);
+
+/*
+ * @brief Получить тип столбца, который принимает операция
+ * @param op_name ключ операции
+ * @return NUMERIC, STRING или UNKNOWN для операции над столбцом любого типа
+ * и для неизвестной операции
+ */
+ColumnType operationInput(const string &op_name);
+
+/*
+ * @brief Получить тип результата операции
+ * @param op номер операции
+ * @return NUMERIC, STRING или UNKNOWN для неизвестной операции
+ */
+ColumnType operationResult(OperationId op);
+
+/*
+ * @brief Проверить, принимает ли операция столбец данного типа: сортировка
+ * и top_k принимают и числовые, и строковые столбцы
+ * @param op номер операции
+ * @param type тип столбца в обработанных данных
+ * @return true, если операцию можно завершить над столбцом
+ */
+bool acceptsInput(OperationId op, ColumnType type);
+
+/*
+ * @brief Определить, что нужно вычислить за проход по столбцу для операции
+ * @param op номер операции
+ * @param params параметры операции
+ * @return требования к частичному результату
+ */
+StateNeeds needsOf(OperationId op, const Params &params);
+
+/*
+ * @brief Определить, что нужно вычислить за проход по столбцу для операции
+ * @param op_name ключ операции
+ * @param params параметры операции
+ * @return требования к частичному результату
+ */
+StateNeeds needsOf(const string &op_name, const Params &params);
+
+/*
+ * @brief Проверить параметры операции при загрузке конфигурации, чтобы
+ * ошибка была найдена до выполнения, а не при вычислении столбца
+ * @param op номер операции
+ * @param params параметры операции
+ * @return описание ошибки или пустая строка, если параметры верны
+ */
+string paramError(OperationId op, const Params &params);
+
+/*
+ * @brief Проверить, пишется ли строковый результат операции в лог потоком,
+ * без сборки в одну строку (concatinate с параметром stream: true)
+ * @param op номер операции
+ * @param params параметры операции
+ * @return true для потоковой записи
+ */
+bool streamsText(OperationId op, const Params &params);
+
+/*
+ * @brief Проверить, совпадает ли производный столбец преобразования с
+ * входным (find_replace с пустым find, с replace, равным find, или без
+ * вхождений find): такой столбец не вычисляется и не копируется
+ * @param op номер операции
+ * @param source входной столбец
+ * @param params параметры операции
+ * @return true, если преобразование не меняет столбец
+ */
+bool keepsColumn(OperationId op, const StringColumn &source,
+                 const Params &params);
+
+/*
+ * @brief Проверить, пишется ли строковый результат операции в лог потоком,
+ * без сборки в одну строку (concatinate с параметром stream: true)
+ * @param op_name ключ операции
+ * @param params параметры операции
+ * @return true для потоковой записи
+ */
+bool streamsText(const string &op_name, const Params &params);
+
+/*
+ * @brief Проверить, задан ли порядок по убыванию (order: desc)
+ * @param params параметры операции
+ * @return true для order: desc
+ */
+bool descendingParam(const Params &params);
+
+/*
+ * @brief Получить представление части строкового результата
+ * @param piece часть
+ * @return представление присутствующих (и выбранных) строк части
+ */
+StringView pieceView(const TextPiece &piece);
+
+/*
+ * @brief Объединить требования нескольких операций над одним столбцом
+ * @param into накапливаемые требования
+ * @param from требования следующей операции
+ */
+void addNeeds(StateNeeds &into, const StateNeeds &from);
+
+/*
+ * @brief Вычислить частичный результат над числовыми данными
+ * @param source представление данных
+ * @param needs что вычислить, кроме суммы и количества
+ * @return сумма и количество присутствующих значений
+ */
+PartialResult partialOf(NumericView source,
+                        const StateNeeds &needs = StateNeeds());
+
+/*
+ * @brief Вычислить частичный результат над строковыми данными
+ * @param source представление данных
+ * @param needs что вычислить, кроме количества
+ * @return количество присутствующих строк и требуемые состояния
  */
-extern map<string, FunctionVariant> operation_map;
+PartialResult partialOf(StringView source, const StateNeeds &needs);
 
 /*
- * @brief Вызвать операцию из словаря операций
- * @param op_name указатель на ключ операции
- * @param arg входной параметр вызываемой операции
- * @return результат работы вызываемой функции
+ * @brief Добавить частичный результат следующей части данных
+ * @param into накапливаемый результат
+ * @param from результат следующей части
  */
-string callOperation(const string &op_name, vector<string> arg);
+void mergePartial(PartialResult &into, const PartialResult &from);
 
 /*
- * @brief Вызвать операцию из словаря операций
- * @param op_name указатель на ключ операции
- * @param arg входной параметр вызываемой операции
- * @return результат работы вызываемой функции
+ * @brief Получить числовой результат операции из частичного результата
+ * @param op номер операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
  */
-float callOperation(const string &op_name, vector<float> arg);
+float finalizeNumeric(OperationId op, const PartialResult &partial,
+                      const Params &params = Params());
+
+/*
+ * @brief Получить числовой результат операции из частичного результата
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+float finalizeNumeric(const string &op_name, const PartialResult &partial,
+                      const Params &params = Params());
+
+/*
+ * @brief Получить строковый результат операции из частичного результата
+ * @param op номер операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+string finalizeString(OperationId op, const PartialResult &partial,
+                      const Params &params = Params());
+
+/*
+ * @brief Получить строковый результат операции из частичного результата
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+string finalizeString(const string &op_name, const PartialResult &partial,
+                      const Params &params = Params());
+
+/*
+ * @brief Проверить, может ли операция вычисляться по группам
+ * @param op номер операции
+ * @return true, если результат операции выражается через сумму, количество,
+ * экстремумы и моменты
+ */
+bool isGroupable(OperationId op);
+
+/*
+ * @brief Проверить, может ли операция вычисляться по группам
+ * @param op_name ключ операции
+ * @return true, если результат операции выражается через сумму, количество,
+ * экстремумы и моменты
+ */
+bool isGroupable(const string &op_name);
+
+/*
+ * @brief Получить числовые результаты операции для каждой группы: функция
+ * завершения выбирается один раз для всех групп
+ * @param op номер операции
+ * @param partial объединенный частичный результат с таблицей групп
+ * @param params параметры операции
+ * @return результаты в порядке partial.groups.keys
+ */
+vector<float> finalizeGroups(OperationId op, const PartialResult &partial,
+                             const Params &params = Params());
+
+/*
+ * @brief Получить числовые результаты операции для каждой группы
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат с таблицей групп
+ * @param params параметры операции
+ * @return результаты в порядке partial.groups.keys
+ */
+vector<float> finalizeGroups(const string &op_name,
+                             const PartialResult &partial,
+                             const Params &params = Params());
+
+/*
+ * @brief Проверить, является ли операция преобразованием столбца (в том
+ * числе оконной операцией)
+ * @param op номер операции
+ * @return true, если операция создает производный столбец
+ */
+bool isTransform(OperationId op);
+
+/*
+ * @brief Проверить, является ли операция преобразованием столбца
+ * @param op_name ключ операции
+ * @return true, если операция создает производный столбец
+ */
+bool isTransform(const string &op_name);
+
+/*
+ * @brief Вызвать преобразование столбца из таблицы операций
+ * @param op номер операции
+ * @param source исходный столбец
+ * @param params параметры операции
+ * @return производный столбец
+ */
+StringColumn callTransform(OperationId op, const StringColumn &source,
+                           const Params &params);
+
+/*
+ * @brief Проверить, является ли операция оконной: она создает производный
+ * числовой столбец из числового столбца
+ * @param op номер операции
+ * @return true для оконной операции
+ */
+bool isWindow(OperationId op);
+
+/*
+ * @brief Вызвать оконную операцию из таблицы операций
+ * @param op номер операции
+ * @param source исходный числовой столбец
+ * @param params параметры операции
+ * @return производный числовой столбец
+ */
+NumericColumn callWindow(OperationId op, const NumericColumn &source,
+                         const Params &params);
+
+/*
+ * @brief Проверить, является ли операция соединением таблиц: ее результат -
+ * таблица, которую обрабатывают операции с параметром table
+ * @param op номер операции
+ * @return true для соединения
+ */
+bool isJoin(OperationId op);
+
+/*
+ * @brief Проверить, является ли операция отбором строк
+ * @param op номер операции
+ * @return true, если операция создает маску выбранных строк
+ */
+bool isFilter(OperationId op);
+
+/*
+ * @brief Проверить, является ли операция отбором строк
+ * @param op_name ключ операции
+ * @return true, если операция создает маску выбранных строк
+ */
+bool isFilter(const string &op_name);
+
+/*
+ * @brief Вызвать отбор строк из таблицы операций
+ * @param op номер операции
+ * @param source таблица
+ * @param column номер столбца условия
+ * @param params параметры операции
+ * @return маска выбранных строк таблицы
+ */
+Bitmap callFilter(OperationId op, table::Table &source, int column,
+                  const Params &params);
 
 /**
- * @brief Вычисляет сумму элементов числового вектора
- * @param source Входной вектор числовых данных
+ * @brief Вычисляет сумму присутствующих элементов числовых данных
+ * @param source Представление числовых данных
  * @return Сумма всех элементов
  */
-float sum(vector<float> source);
+float sum(NumericView source);
 
 /**
- * @brief Вычисляет среднее арифметическое элементов числового вектора
- * @param source Входной вектор числовых данных
+ * @brief Вычисляет среднее арифметическое присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
  * @return Среднее значение элементов
  */
-float average(vector<float> source);
+float average(NumericView source);
 
 /**
- * @brief Объединяет строки из вектора в одну строку
- * @param source Входной вектор строк
+ * @brief Находит минимум присутствующих элементов числовых данных
+ * @param source Представление числовых данных
+ * @return Минимальное значение (NaN для пустых данных)
+ */
+float minimum(NumericView source);
+
+/**
+ * @brief Находит максимум присутствующих элементов числовых данных
+ * @param source Представление числовых данных
+ * @return Максимальное значение (NaN для пустых данных)
+ */
+float maximum(NumericView source);
+
+/**
+ * @brief Подсчитывает присутствующие элементы числовых данных
+ * @param source Представление числовых данных
+ * @return Количество элементов
+ */
+float countPresent(NumericView source);
+
+/**
+ * @brief Вычисляет выборочную дисперсию присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
+ * @return Дисперсия (NaN, если элементов меньше двух)
+ */
+float variance(NumericView source);
+
+/**
+ * @brief Вычисляет выборочное стандартное отклонение присутствующих элементов
+ * числовых данных
+ * @param source Представление числовых данных
+ * @return Стандартное отклонение (NaN, если элементов меньше двух)
+ */
+float stddev(NumericView source);
+
+/**
+ * @brief Вычисляет коэффициент асимметрии присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
+ * @return Асимметрия (NaN для постоянных или пустых данных)
+ */
+float skewness(NumericView source);
+
+/**
+ * @brief Находит медиану присутствующих элементов числовых данных по скетчу
+ * квантилей
+ * @param source Представление числовых данных
+ * @return Медиана (NaN для пустых данных)
+ */
+float median(NumericView source);
+
+/**
+ * @brief Находит 95-й процентиль присутствующих элементов числовых данных по
+ * скетчу квантилей
+ * @param source Представление числовых данных
+ * @return Процентиль (NaN для пустых данных)
+ */
+float p95(NumericView source);
+
+/**
+ * @brief Находит 99-й процентиль присутствующих элементов числовых данных по
+ * скетчу квантилей
+ * @param source Представление числовых данных
+ * @return Процентиль (NaN для пустых данных)
+ */
+float p99(NumericView source);
+
+/**
+ * @brief Находит квантиль присутствующих элементов числовых данных по скетчу
+ * квантилей (уровень задается параметром q, по умолчанию 0.5)
+ * @param source Представление числовых данных
+ * @return Квантиль (NaN для пустых данных)
+ */
+float quantile(NumericView source);
+
+/**
+ * @brief Объединяет присутствующие строки в одну строку
+ * @param source Представление строковых данных
  * @return Результирующая объединенная строка
  */
-string concatinate(vector<string> source);
+string concatinate(StringView source);
+
+/**
+ * @brief Оценивает количество уникальных присутствующих строк по скетчу
+ * HyperLogLog (фиксированная память, ошибка около 1.6%)
+ * @param source Представление строковых данных
+ * @return Оценка количества уникальных строк
+ */
+string countDistinctApprox(StringView source);
+
+/**
+ * @brief Подсчитывает уникальные присутствующие строки точно
+ * @param source Представление строковых данных
+ * @return Количество уникальных строк
+ */
+string countDistinct(StringView source);
 
 /**
  * @brief Выполняет поиск и замену в векторе строк
@@ -74,6 +566,57 @@ string concatinate(vector<string> source);
  * @param replace Строка для замены
  * @return Вектор с выполненными заменами
  */
-vector<string> findReplace(vector<string> source, string find, string replace);
+vector<string> findReplace(const vector<string> &source, const string &find,
+                           const string &replace);
+
+/**
+ * @brief Выполняет поиск и замену в строковом столбце (параметры find и
+ * replace)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец того же размера и способа хранения
+ */
+StringColumn findReplaceColumn(const StringColumn &source,
+                               const Params &params);
+
+/**
+ * @brief Отбирает строки таблицы по условию на столбец (параметры op и
+ * value). Числовой столбец сравнивается с числом, иначе значения
+ * сравниваются как строки
+ * @param source Таблица
+ * @param column Номер столбца условия
+ * @param params Параметры операции
+ * @return Маска выбранных строк таблицы
+ */
+Bitmap filterRows(table::Table &source, int column, const Params &params);
+
+/**
+ * @brief Вычисляет скользящую сумму по окну из window строк (параметр
+ * window)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn rollingSumColumn(const NumericColumn &source,
+                               const Params &params);
+
+/**
+ * @brief Вычисляет скользящее среднее по окну из window строк (параметр
+ * window)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn rollingAverageColumn(const NumericColumn &source,
+                                   const Params &params);
+
+/**
+ * @brief Вычисляет накопленную сумму от первой строки
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn cumulativeSumColumn(const NumericColumn &source,
+                                  const Params &params);
 
 #endif // !OPERATIONS_H
@@ -2,11 +2,14 @@
 #define PARSER_H
 
 #include "../libs/Tiny_Yaml/yaml/yaml.hpp"
+#include "column.h"
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 using std::map;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -68,15 +71,66 @@ int getColumnById(string id);
  */
 string getFuncById(string id);
 
+/*
+ * @brief Получить дополнительные параметры операции (все поля, кроме func и
+ * column)
+ * @param id уникальный идентификатор операции
+ * @return словарь параметр -> значение
+ */
+map<string, string> getParamsById(string id);
+
+/*
+ * @brief Получить значение поля column без преобразования в число (номер
+ * столбца или id операции-преобразования)
+ * @param id уникальный идентификатор операции
+ * @return значение поля или пустая строка
+ */
+string getColumnFieldById(string id);
+
 /*
  * @brief Получить путь к файлу csv для обработки
  * @return путь к файлу
  */
 string getCSV();
+
+/*
+ * @brief Получить именованные таблицы из раздела tables
+ * @return имя таблицы -> путь к файлу csv (пустой словарь, если раздела нет)
+ */
+map<string, string> getTables();
+
+/*
+ * @brief Получить зависимости операций из поля depends_on (список `[a, b]`,
+ * одно значение или блочный список `- a`)
+ * @return id операции -> id операций, от которых она зависит (только
+ * операции, в которых поле задано; пустой словарь, если поле не задано нигде)
+ */
+map<string, vector<string>> getDependencies();
 }; // namespace config
 
 namespace table {
 
+/**
+ * @brief Номер первого производного столбца: производные столбцы хранятся в
+ * тех же кэшах, что и столбцы файла, под номерами от DERIVED_COLUMN
+ */
+const int DERIVED_COLUMN = 1 << 20;
+
+/**
+ * @brief Таблица, считанная из файла csv, с кэшем типизированных столбцов
+ */
+struct Table {
+  vector<vector<string>> rows;             // поля по строкам файла
+  map<int, ColumnType> column_types;       // кэш определенных типов столбцов
+  map<int, NumericColumn> numeric_columns; // кэш числовых столбцов
+  map<string, int> derived_columns;        // ключ преобразования -> номер
+                                           // производного столбца
+  size_t version = 0;                      // версия данных (номер чтения)
+
+  // кэш строковых столбцов: узлы графа получают эти буферы без копирования
+  map<int, shared_ptr<const StringColumn>> string_columns;
+};
+
 /**
  * @brief Инициализировать объкт документа
  * @param path путь к документу
@@ -84,10 +138,47 @@ namespace table {
 void read(string path, char delimiter = ',');
 
 /**
- * @brief Очистить таблицу
+ * @brief Считать файл csv в отдельную таблицу
+ * @param target таблица для заполнения
+ * @param path путь к документу
+ * @param delimiter разделитель полей
+ */
+void read(Table &target, string path, char delimiter = ',');
+
+/**
+ * @brief Заполнить таблицу готовыми строками (например, результатом
+ * соединения): кэши столбцов сбрасываются, а версия данных обновляется
+ * @param target таблица для заполнения
+ * @param rows строки таблицы
+ */
+void assign(Table &target, vector<vector<string>> rows);
+
+/**
+ * @brief Считать файл csv в именованную таблицу конфигурации
+ * @param name имя таблицы
+ * @param path путь к документу
+ * @param delimiter разделитель полей
+ */
+void readNamed(const string &name, string path, char delimiter = ',');
+
+/**
+ * @brief Получить именованную таблицу конфигурации
+ * @param name имя таблицы
+ * @return указатель на таблицу или nullptr, если таблицы нет
+ */
+Table *namedTable(const string &name);
+
+/**
+ * @brief Очистить таблицу и именованные таблицы
  */
 void clear();
 
+/**
+ * @brief Получить текущую таблицу, с которой работают операции графа
+ * @return ссылка на таблицу
+ */
+Table &currentTable();
+
 /*
  * @brief Получить id всех доступных операций
  */
@@ -107,19 +198,83 @@ bool isNumneric(string &s);
  * @return Тип данных столбца
  */
 ColumnType getTypeOfColumn(int column);
+
+/**
+ * @brief Определяет тип данных столбца отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return Тип данных столбца
+ */
+ColumnType getTypeOfColumn(Table &source, int column);
+
+/**
+ * @brief Получить числовой столбец, выровненный по строкам таблицы
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится до table::clear)
+ */
+const NumericColumn &numericColumn(int column);
+
+/**
+ * @brief Получить числовой столбец отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится вместе с таблицей)
+ */
+const NumericColumn &numericColumn(Table &source, int column);
+
+/**
+ * @brief Получить строковый столбец, выровненный по строкам таблицы
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится до table::clear)
+ */
+const StringColumn &stringColumn(int column);
+
+/**
+ * @brief Получить строковый столбец отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится вместе с таблицей)
+ */
+const StringColumn &stringColumn(Table &source, int column);
+
+/**
+ * @brief Получить строковый столбец отдельной таблицы во владение: буфер не
+ * копируется и остается доступным после очистки таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return указатель на столбец со счетчиком ссылок
+ */
+shared_ptr<const StringColumn> sharedStringColumn(Table &source, int column);
+
+/**
+ * @brief Добавить производный столбец в кэши таблицы: тип определяется по
+ * значениям, числовой столбец строится сразу, если все значения - числа
+ * @param source таблица
+ * @param column номер производного столбца (от DERIVED_COLUMN)
+ * @param values значения, выровненные по строкам таблицы
+ */
+void addDerivedColumn(Table &source, int column, StringColumn values);
+
+/**
+ * @brief Добавить производный числовой столбец (например, значения
+ * выражения) в кэши таблицы. Строковый столбец строится при первом запросе
+ * @param source таблица
+ * @param column номер производного столбца (от DERIVED_COLUMN)
+ * @param values значения, выровненные по строкам таблицы
+ */
+void addDerivedColumn(Table &source, int column, NumericColumn values);
+
 /*
- * @brief Считать столбец чисел из файла
- * @param reader указатель на "документ"
+ * @brief Считать присутствующие значения числового столбца
  * @param column номер столбца
- * @return вектор чисел столбца
+ * @return вектор чисел столбца без пропусков
  */
 vector<float> readNumericColumn(int column);
 
 /*
- * @brief Считать столбец строк из файла
- * @param reader указатель на "документ"
+ * @brief Считать присутствующие значения строкового столбца
  * @param column номер столбца
- * @return вектор чисел столбца
+ * @return вектор строк столбца без пропусков
  */
 vector<string> readStringColumn(int column);
 
@@ -162,4 +317,23 @@ void createGraphFromScheme(vector<string> scheme);
  */
 void createGraphFromScheme(vector<string> scheme, vector<string> ids);
 
+/*
+ * @brief Проверить зависимости операций: все id существуют, операция не
+ * зависит от себя, и граф не содержит циклов
+ * @param ids id операций
+ * @param depends id операции -> id операций, от которых она зависит
+ * @return сообщения об ошибках (пустой вектор - ошибок нет)
+ */
+vector<string> checkDependencies(const vector<string> &ids,
+                                 const map<string, vector<string>> &depends);
+
+/**
+ * @brief Создать граф из всех операций конфигурации по их зависимостям за
+ * один проход: каждая зависимость становится связью от нее к операции
+ * @param ids id операций (порядок узлов в графе)
+ * @param depends id операции -> id операций, от которых она зависит
+ */
+void createGraphFromDependencies(const vector<string> &ids,
+                                 const map<string, vector<string>> &depends);
+
 #endif // !PARSER_H
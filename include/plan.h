@@ -0,0 +1,186 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include "expr.h"
+#include "graph.h"
+#include "operations.h"
+#include "parser.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace plan {
+
+/**
+ * @brief Операция узла графа, разрешенная по конфигурации до выполнения
+ */
+struct Task {
+  string id;         // уникальный идентификатор операции
+  string func;       // название функции
+  int column = 0;    // номер столбца
+  Params params;     // дополнительные параметры из конфигурации
+  int group_by = -1; // столбец ключей группировки (-1 - без группировки)
+  string input;      // id узла, чей результат читает операция: производный
+                     // столбец преобразования, скаляр или INPUT_PARENTS
+                     // (пусто - столбец файла)
+  string where;      // id отбора строк, выбранные строки которого
+                     // обрабатывает операция (пусто - все строки)
+  string table;      // именованная таблица или id соединения, строки
+                     // которого обрабатывает операция (пусто - основная)
+  ExprProgram expr;  // выражение, значения которого обрабатывает операция
+                     // (input равен INPUT_EXPR и тексту выражения)
+
+  // номер функции в таблице операций (заполняется resolveOperations)
+  OperationId op = OP_UNKNOWN;
+  string error; // ошибка конфигурации операции (пусто - ошибок нет)
+};
+
+/**
+ * @brief Группа операций, читающих один столбец: столбец просматривается
+ * один раз, а результаты всех операций группы вычисляются из общего
+ * частичного результата
+ */
+struct ColumnGroup {
+  int column = 0;       // номер столбца
+  string input;         // id преобразования для производного столбца
+  vector<size_t> tasks; // индексы операций группы в векторе операций
+};
+
+/**
+ * @brief Ключ кэша результатов: функция (или общее состояние столбца),
+ * столбец и версия данных таблицы
+ */
+struct CacheKey {
+  string func;        // функция с параметрами или общее состояние (*_STATE)
+  int column = 0;     // номер столбца
+  size_t version = 0; // версия данных таблицы
+
+  bool operator<(const CacheKey &other) const;
+};
+
+/**
+ * @brief Частичный результат, общий для операций с одинаковым состоянием и
+ * для кэша: результат не копируется при повторном использовании
+ */
+typedef std::shared_ptr<const PartialResult> SharedResult;
+
+/**
+ * @brief Запись кэша: частичный результат и id операции, которая его
+ * вычислила
+ */
+struct CacheEntry {
+  SharedResult partial; // частичный результат
+  string owner;          // id операции, вычислившей результат
+};
+
+/**
+ * @brief Кэш результатов одного запуска
+ */
+typedef map<CacheKey, CacheEntry> Cache;
+
+const string NUMERIC_STATE = "#numeric"; // общее состояние числовых операций
+const string STRING_STATE = "#string";   // общее состояние строковых операций
+const string GROUPED_STATE = "#grouped"; // общее состояние операций по группам
+
+const string PARAM_GROUP_BY = "group_by"; // параметр столбца группировки
+const string INPUT_PARENTS = "parents";   // вход - результаты всех родителей
+const string PARAM_WHERE = "where";       // параметр отбора строк
+const string PARAM_EXPR = "expr";         // параметр выражения над столбцами
+const string INPUT_EXPR = "expr:";        // начало входа-выражения
+const string PARAM_TABLE = "table";       // параметр таблицы операции
+const string PARAM_RIGHT = "right";       // параметр правой таблицы соединения
+const string PARAM_RIGHT_COLUMN = "right_column"; // параметр столбца ключа
+                                                  // правой таблицы
+
+/*
+ * @brief Разрешить операции по конфигурации
+ * @param ids уникальные идентификаторы операций
+ * @return вектор операций
+ */
+vector<Task> collectTasks(const vector<string> &ids);
+
+/*
+ * @brief Скомпилировать операции конфигурации в плоский план один раз при
+ * загрузке: ключи функций, столбцы, параметры и выражения разбираются и
+ * проверяются здесь, а узлы графа затем читают только массив операций
+ * @param ids уникальные идентификаторы операций
+ * @return количество операций с ошибками
+ */
+size_t compile(const vector<string> &ids);
+
+/*
+ * @brief Получить номер операции в скомпилированном плане
+ * @param id уникальный идентификатор операции
+ * @return номер или -1, если операции нет
+ */
+int taskIndex(const string &id);
+
+/*
+ * @brief Получить операцию скомпилированного плана
+ * @param index номер операции
+ * @return указатель на операцию или nullptr, если номера нет
+ */
+const Task *compiledTask(int index);
+
+/*
+ * @brief Получить операцию узла графа: номер операции находится по id один
+ * раз и запоминается в узле
+ * @param node узел графа
+ * @return указатель на операцию или nullptr, если операции нет
+ */
+const Task *taskOf(Node *node);
+
+/*
+ * @brief Очистить скомпилированный план
+ */
+void clear();
+
+/*
+ * @brief Разрешить функции операций в номера таблицы операций: план и
+ * исполнитель вызывают функции по номеру, а не по ключу
+ * @param tasks операции
+ */
+void resolveOperations(vector<Task> &tasks);
+
+/*
+ * @brief Сгруппировать операции по читаемому столбцу
+ * @param tasks операции
+ * @return группы в порядке первого появления столбца
+ */
+vector<ColumnGroup> groupByColumn(const vector<Task> &tasks);
+
+/*
+ * @brief Выполнить операции над таблицей, просматривая каждый столбец один
+ * раз
+ * @param source таблица
+ * @param tasks операции
+ * @param groups группы операций по столбцам
+ * @return частичный результат для каждой операции (по индексу в tasks)
+ */
+vector<SharedResult> evaluate(table::Table &source, const vector<Task> &tasks,
+                              const vector<ColumnGroup> &groups);
+
+/*
+ * @brief Выполнить операции над таблицей с кэшем результатов: одинаковые
+ * операции над одним столбцом вычисляются один раз, а производные агрегаты
+ * (например, average) используют общее состояние столбца
+ * @param source таблица
+ * @param tasks операции
+ * @param groups группы операций по столбцам
+ * @param cache кэш результатов запуска
+ * @param reused_from для каждой операции - id операции, чей результат был
+ * взят из кэша, или пустая строка
+ * @return частичный результат для каждой операции (по индексу в tasks)
+ */
+vector<SharedResult> evaluate(table::Table &source, const vector<Task> &tasks,
+                              const vector<ColumnGroup> &groups, Cache &cache,
+                              vector<string> &reused_from);
+
+}; // namespace plan
+
+#endif // !PLAN_H
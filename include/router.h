@@ -2,6 +2,7 @@
 #define ROUTER_H
 
 #include "parser.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -14,8 +15,60 @@ namespace SimpleDAG {
  */
 int run();
 
+/**
+ * @brief Коды завершения пакетного режима
+ */
+enum ExitCode {
+  EXIT_OK = 0,          // все операции выполнены
+  EXIT_USAGE = 2,       // неверные аргументы командной строки
+  EXIT_CONFIG = 3,      // конфигурация не загружена или неизвестные функции
+  EXIT_DATA = 4,        // не найдены файлы данных или таблиц
+  EXIT_SCHEME = 5,      // файл схемы не найден или схема некорректна
+  EXIT_OUTPUT = 6,      // не удалось открыть файл результатов
+  EXIT_INVALID_OPS = 7, // граф выполнен, операции с ошибками пропущены
+};
+
+/**
+ * @brief Аргументы пакетного режима
+ */
+struct BatchOptions {
+  std::string config;            // путь к YAML-конфигурации
+  std::string scheme;            // файл схемы графа (пусто - depends_on)
+  std::string data_dir = "data"; // директория с файлами данных
+  std::string output;            // файл результатов (пусто - как в TUI)
+  bool help = false;             // вывести справку
+};
+
+/**
+ * @brief Запуск SimpleDAG без интерактивного ввода: конфигурация, схема,
+ * директория данных и файл результатов задаются аргументами командной строки
+ * @param argc количество аргументов
+ * @param argv аргументы
+ * @return код завершения ExitCode
+ */
+int runBatch(int argc, char *argv[]);
+
 namespace Internal {
 
+/**
+ * @brief Разбирает аргументы пакетного режима
+ * @param argc количество аргументов
+ * @param argv аргументы (--config, --scheme, --data, --output, --help)
+ * @param options заполняемые аргументы
+ * @return true если аргументы корректны
+ */
+bool parseArguments(int argc, char *argv[], BatchOptions &options);
+
+/**
+ * @brief Читает схему графа из файла: строки до end, пустые строки
+ * пропускаются
+ * @param path путь к файлу схемы
+ * @param scheme прочитанные строки схемы
+ * @return true если файл открыт
+ */
+bool readSchemeFile(const std::string &path,
+                    std::vector<std::string> &scheme);
+
 /**
  * @brief Загружает конфигурацию из YAML файла
  * @param workingDir Рабочая директория для поиска конфигурационных файлов
@@ -31,10 +84,14 @@ bool loadConfiguration(const std::string &workingDir);
 bool validateConfiguration();
 
 /**
- * @brief Загружает данные из CSV файла указанного в конфигурации
+ * @brief Загружает данные из CSV файла указанного в конфигурации. Если путь
+ * задает директорию или шаблон имени, запоминает набор файлов для
+ * параллельной обработки. Также загружает именованные таблицы из раздела
+ * tables
+ * @param workingDir Директория с файлами данных
  * @return true если данные успешно загружены, false в случае ошибки
  */
-bool loadDataTable();
+bool loadDataTable(const std::string &workingDir);
 
 /**
  * @brief Отображает список доступных операций из конфигурации
@@ -43,8 +100,10 @@ void displayAvailableOperations();
 
 /**
  * @brief Инициализирует систему логирования с временной меткой
+ * @param workingDir Директория для файла результатов
+ * @return true если файл результатов открыт
  */
-void initializeLogging();
+bool initializeLogging(const std::string &workingDir);
 
 /**
  * @brief Обрабатывает ввод и валидацию схемы графа от пользователя
@@ -53,6 +112,17 @@ void initializeLogging();
  */
 bool processGraphScheme(std::vector<std::string> &ids);
 
+/**
+ * @brief Проверяет зависимости depends_on из конфигурации, отображает ошибки
+ * и строит граф из всех операций без ввода схемы
+ * @param ids Список идентификаторов доступных операций
+ * @param depends Зависимости операций из конфигурации
+ * @return true если зависимости корректны и граф построен
+ */
+bool processDependencies(
+    const std::vector<std::string> &ids,
+    const std::map<std::string, std::vector<std::string>> &depends);
+
 /**
  * @brief Отображает ошибки в строке схемы графа
  * @param schemeLine Строка схемы с ошибкой
@@ -0,0 +1,154 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Точность скетча квантилей по умолчанию (параметр k: ошибка ранга
+ * порядка 1.7 / k при памяти порядка 3k значений)
+ */
+const size_t DEFAULT_ACCURACY = 200;
+
+/**
+ * @brief Допустимая точность скетча квантилей: при меньшей точности уровни
+ * сжимаются почти при каждой вставке, а большая не нужна при памяти порядка
+ * 3k значений
+ */
+const size_t MIN_ACCURACY = 8;
+const size_t MAX_ACCURACY = 1 << 16;
+
+/**
+ * @brief Скетч квантилей KLL: значения хранятся по уровням, значение уровня h
+ * представляет 2^h исходных значений. Память ограничена и не зависит от
+ * количества значений, а скетчи частей данных объединяются sketchMerge
+ */
+struct QuantileSketch {
+  size_t accuracy = DEFAULT_ACCURACY; // параметр k: емкость верхнего уровня
+  size_t count = 0;                   // количество добавленных значений
+  bool parity = false;                // чередование выбора при сжатии
+  vector<vector<float>> levels;       // значения по уровням
+};
+
+/**
+ * @brief Создать пустой скетч
+ * @param accuracy параметр k (приводится к диапазону от MIN_ACCURACY до
+ * MAX_ACCURACY)
+ * @return скетч
+ */
+QuantileSketch createSketch(size_t accuracy);
+
+/**
+ * @brief Добавить присутствующие значения в скетч
+ * @param sketch скетч
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ */
+void sketchInsert(QuantileSketch &sketch, const float *values,
+                  const uint64_t *validity, size_t length);
+
+/**
+ * @brief Добавить скетч следующей части данных
+ * @param into накапливаемый скетч
+ * @param from скетч следующей части
+ */
+void sketchMerge(QuantileSketch &into, const QuantileSketch &from);
+
+/**
+ * @brief Получить приближенный квантиль
+ * @param sketch скетч
+ * @param q уровень квантиля от 0 до 1
+ * @return значение, ранг которого ближе всего к q * count (NaN для пустого
+ * скетча)
+ */
+float sketchQuantile(const QuantileSketch &sketch, double q);
+
+/**
+ * @brief Получить точный квантиль отсортированных значений без копирования
+ * @param sorted значения по возрастанию
+ * @param q уровень квантиля от 0 до 1
+ * @return значение с рангом ceil(q * n) (NaN для пустых данных)
+ */
+float sortedQuantile(const vector<float> &sorted, double q);
+
+/**
+ * @brief Точность HyperLogLog: 2^12 регистров по байту (4 КБ), стандартная
+ * ошибка около 1.6%
+ */
+const size_t HLL_PRECISION = 12;
+
+/**
+ * @brief Скетч HyperLogLog для оценки количества уникальных значений.
+ * Память фиксирована, а скетчи частей данных объединяются поэлементным
+ * максимумом регистров
+ */
+struct DistinctSketch {
+  vector<uint8_t> registers; // максимальный ранг хэшей по корзинам
+};
+
+/**
+ * @brief Точное множество уникальных строк с открытой адресацией: слоты
+ * хранят номер строки и ее хэш, коллизии разрешаются линейным пробированием
+ */
+struct DistinctSet {
+  vector<uint32_t> slots;  // номер строки в values + 1 (0 - пустой слот)
+  vector<uint64_t> hashes; // хэши строк по слотам
+  vector<string> values;   // уникальные строки в порядке появления
+};
+
+/**
+ * @brief Хэш последовательности байтов: байты обрабатываются словами по 8
+ * @param data указатель на байты
+ * @param length количество байтов
+ * @return 64-битный хэш
+ */
+uint64_t hashBytes(const char *data, size_t length);
+
+/**
+ * @brief Добавить присутствующие строки в скетч HyperLogLog
+ * @param sketch скетч (создается при первом добавлении)
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void distinctInsert(DistinctSketch &sketch, const string *values,
+                    const uint64_t *validity, size_t length);
+
+/**
+ * @brief Добавить скетч следующей части данных
+ * @param into накапливаемый скетч
+ * @param from скетч следующей части
+ */
+void distinctMerge(DistinctSketch &into, const DistinctSketch &from);
+
+/**
+ * @brief Оценить количество уникальных значений
+ * @param sketch скетч
+ * @return оценка (0 для пустого скетча)
+ */
+double distinctEstimate(const DistinctSketch &sketch);
+
+/**
+ * @brief Добавить присутствующие строки в точное множество
+ * @param set множество
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void distinctSetInsert(DistinctSet &set, const string *values,
+                       const uint64_t *validity, size_t length);
+
+/**
+ * @brief Добавить множество следующей части данных
+ * @param into накапливаемое множество
+ * @param from множество следующей части
+ */
+void distinctSetMerge(DistinctSet &into, const DistinctSet &from);
+
+#endif // !SKETCH_H
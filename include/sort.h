@@ -0,0 +1,98 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+/**
+ * @brief Бюджет памяти сортировки по умолчанию в мегабайтах (параметр
+ * memory): серии сверх бюджета сбрасываются на диск
+ */
+const double DEFAULT_SORT_MEMORY = 64;
+
+/**
+ * @brief Отсортированная по возрастанию серия значений части данных. Серия
+ * хранится в памяти или в файле сброса, который удаляется вместе с серией
+ */
+struct SortRun {
+  bool numeric = true;    // числовые ключи (иначе строки)
+  size_t count = 0;       // количество значений
+  size_t bytes = 0;       // занимаемая память (0 для файла сброса)
+  vector<float> numbers;  // числа в памяти
+  vector<string> strings; // строки в памяти
+  string path;            // файл сброса (пустой - серия в памяти)
+
+  SortRun() = default;
+  SortRun(const SortRun &) = delete;
+  SortRun &operator=(const SortRun &) = delete;
+  ~SortRun();
+};
+
+/**
+ * @brief Состояние сортировки: серии частей данных, которые объединяются
+ * k-путевым слиянием при получении результата. Серии в памяти не занимают
+ * больше budget байт: самые большие из них сбрасываются на диск
+ */
+struct SortState {
+  size_t budget = 0; // бюджет памяти в байтах (0 - без ограничения)
+  vector<shared_ptr<const SortRun>> runs; // серии в порядке частей
+};
+
+/**
+ * @brief Поразрядная сортировка (LSD) чисел по возрастанию: ключи - биты
+ * float с сохранением порядка, по 8 бит за проход. Гистограммы разрядов
+ * считаются потоками по своим частям, а проход, в котором у всех ключей
+ * одинаковый разряд, пропускается
+ * @param values значения (сортируются на месте)
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void radixSort(vector<float> &values, unsigned workers = 0);
+
+/**
+ * @brief Добавить отсортированные серии присутствующих чисел
+ * @param state состояние сортировки
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ */
+void sortInsert(SortState &state, const float *values,
+                const uint64_t *validity, size_t length);
+
+/**
+ * @brief Добавить отсортированные серии присутствующих строк
+ * @param state состояние сортировки
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void sortInsert(SortState &state, const string *values,
+                const uint64_t *validity, size_t length);
+
+/**
+ * @brief Добавить серии следующей части данных
+ * @param into накапливаемое состояние
+ * @param from состояние следующей части
+ */
+void sortMerge(SortState &into, const SortState &from);
+
+/**
+ * @brief Передать все значения по порядку k-путевым слиянием серий: значения
+ * не собираются в памяти, а передаются по одному по мере слияния. Числа
+ * сравниваются как числа, но если среди серий есть строковые, все значения
+ * сравниваются как строки
+ * @param state состояние сортировки
+ * @param descending по убыванию (иначе по возрастанию)
+ * @param visit функция, получающая значения в текстовом виде
+ */
+void forEachSorted(const SortState &state, bool descending,
+                   const std::function<void(const string &)> &visit);
+
+#endif // !SORT_H
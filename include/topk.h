@@ -0,0 +1,129 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+/**
+ * @brief Количество значений top_k по умолчанию (параметр k)
+ */
+const size_t DEFAULT_TOP_K = 10;
+
+/**
+ * @brief Наибольшее количество значений top_k: куча не растет больше числа
+ * строк, а граница не дает переполниться емкости счетчиков строк
+ */
+const size_t MAX_TOP_K = 1 << 24;
+
+/**
+ * @brief Значение числового столбца и номер его строки
+ */
+struct TopEntry {
+  float value = 0; // значение
+  size_t row = 0;  // номер строки с начала первой части данных
+};
+
+/**
+ * @brief Частота строки и номер строки ее первого появления
+ */
+struct TopCount {
+  size_t count = 0; // количество появлений
+  size_t row = 0;   // номер первой строки с начала первой части данных
+};
+
+/**
+ * @brief Счетчик строки top_k
+ */
+struct TopCounter {
+  string value;   // строка
+  TopCount count; // частота и первая строка
+};
+
+/**
+ * @brief Счетчиков строк на одно лучшее значение: для самых частых строк
+ * хранится не больше max(k * TOPK_COUNTERS, MIN_TOPK_COUNTERS) счетчиков
+ */
+const size_t TOPK_COUNTERS = 8;
+const size_t MIN_TOPK_COUNTERS = 1024;
+
+/**
+ * @brief Состояние top_k: ограниченная куча из не более чем k лучших чисел
+ * (в корне - худшее из них) и счетчики строк. Для самых частых строк
+ * счетчики ограничены (Space-Saving: новая строка вытесняет самый редкий
+ * счетчик и наследует его частоту), поэтому память O(k), а частоты -
+ * верхние оценки, точные, пока различных строк не больше счетчиков. Самые
+ * редкие строки требуют частот всех строк, и их счетчики не ограничены
+ */
+struct TopKState {
+  size_t k = 0;           // количество лучших значений (0 - не нужны)
+  bool ascending = false; // лучшие - наименьшие (иначе наибольшие)
+  vector<TopEntry> heap;  // лучшие числа
+  vector<TopCounter> counters; // счетчики строк (при ограничении - куча с
+                               // самым редким счетчиком в корне)
+  unordered_map<string, size_t> positions; // строка -> номер счетчика
+};
+
+/**
+ * @brief Добавить присутствующие числа: каждый поток ведет свою
+ * ограниченную кучу над частью столбца, затем кучи объединяются. Время
+ * O(n log k), память O(k) на поток. Значения NaN пропускаются
+ * @param state состояние top_k
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param rows номера строк значений или nullptr, если i-е значение
+ * находится в строке i (разреженный столбец)
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void topKInsert(TopKState &state, const float *values,
+                const uint64_t *validity, size_t length,
+                const uint32_t *rows = nullptr, unsigned workers = 0);
+
+/**
+ * @brief Добавить частоты присутствующих строк
+ * @param state состояние top_k
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ * @param rows номера строк значений или nullptr, если i-е значение
+ * находится в строке i (разреженный столбец)
+ */
+void topKInsert(TopKState &state, const string *values,
+                const uint64_t *validity, size_t length,
+                const uint32_t *rows = nullptr);
+
+/**
+ * @brief Добавить состояние следующей части данных
+ * @param into накапливаемое состояние
+ * @param from состояние следующей части
+ * @param offset количество строк предыдущих частей: сдвиг номеров строк from
+ */
+void topKMerge(TopKState &into, const TopKState &from, size_t offset);
+
+/**
+ * @brief Получить лучшие числа от лучшего к худшему (при равенстве - по
+ * номеру строки)
+ * @param state состояние top_k
+ * @return не более k значений с номерами строк
+ */
+vector<TopEntry> topKValues(const TopKState &state);
+
+/**
+ * @brief Выбрать самые частые (ascending - самые редкие) строки ограниченной
+ * кучей за O(m log k), где m - количество счетчиков
+ * @param state состояние top_k
+ * @return не более k строк с частотами от лучшей к худшей (при равенстве -
+ * по первой строке)
+ */
+vector<pair<string, TopCount>> topKStrings(const TopKState &state);
+
+#endif // !TOPK_H
@@ -22,22 +22,49 @@ namespace logger {
 /*
  * @brief Открыть лог
  * @param путь к файлу лога
+ * @return true, если файл лога открыт
  */
-void openLog(string path);
+bool openLog(string path);
 
 /*
  * @brief Записать результат выполненя операции над числовым столбцом
  * @param id уникальный идентификатор операции
  * @param res результат выполнения
  */
-void writeResult(string id, float res);
+void writeResult(const string &id, float res);
 
 /*
  * @brief Записать результат выполненя операции над строковым столбцом
  * @param id уникальный идентификатор операции
  * @param res результат выполнения
  */
-void writeResult(string id, string res);
+void writeResult(const string &id, const string &res);
+
+/*
+ * @brief Записать строковый результат по частям без сборки в одну строку:
+ * присутствующие строки частей пишутся в лог по порядку
+ * @param id уникальный идентификатор операции
+ * @param parts части результата
+ */
+void writeStream(const string &id, const vector<StringView> &parts);
+
+/*
+ * @brief Записать отсортированные значения через запятую по мере слияния
+ * серий, без сборки результата в одну строку
+ * @param id уникальный идентификатор операции
+ * @param state состояние сортировки
+ * @param descending по убыванию (иначе по возрастанию)
+ */
+void writeSorted(const string &id, const SortState &state, bool descending);
+
+/*
+ * @brief Записать результаты операции по группам
+ * @param id уникальный идентификатор операции
+ * @param keys ключи групп
+ * @param res результаты в порядке ключей
+ */
+void writeGroups(const string &id, const vector<string> &keys,
+                 const vector<float> &res);
 
 /*
  * @brief Записать предупреждения
@@ -45,6 +72,13 @@ void writeResult(string id, string res);
  */
 void warning(string message);
 
+/*
+ * @brief Записать повторное использование результата из кэша
+ * @param id уникальный идентификатор операции
+ * @param source id операции, чей результат использован
+ */
+void cacheHit(string id, string source);
+
 /*
  * @brief Закрыть лог
  */
@@ -155,10 +189,4 @@ void getSourceFiles(string &config, string &res_file);
  */
 vector<string> collectFiles(string path, string extension);
 
-/*
- * @brief Процедура запуска операции в узле графа
- * @param node указатель на узел графа
- */
-void procedure(Node *node);
-
 #endif // !UTILS_H
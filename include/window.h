@@ -0,0 +1,48 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include "column.h"
+#include <cstddef>
+
+/*
+ * Оконные операции над строками таблицы в порядке файла. Результат -
+ * производный числовой столбец, выровненный по строкам исходного, который
+ * читают операции следующих узлов графа. Скользящее окно обновляется за O(1)
+ * на строку: значение, вошедшее в окно, прибавляется, а вышедшее - вычитается.
+ */
+
+/**
+ * @brief Наибольший размер окна в строках: окно не меньше таблицы дает
+ * накопленную сумму, поэтому большее окно не нужно
+ */
+const size_t MAX_WINDOW = size_t(1) << 30;
+
+/**
+ * @brief Скользящая сумма: значение строки - сумма присутствующих значений
+ * последних window строк, включая текущую. Строка, в окне которой нет
+ * значений, считается пропуском
+ * @param column числовой столбец
+ * @param window размер окна в строках (не меньше 1)
+ * @return производный столбец
+ */
+NumericColumn rollingSum(const NumericColumn &column, size_t window);
+
+/**
+ * @brief Скользящее среднее: значение строки - среднее присутствующих
+ * значений последних window строк, включая текущую. Строка, в окне которой
+ * нет значений, считается пропуском
+ * @param column числовой столбец
+ * @param window размер окна в строках (не меньше 1)
+ * @return производный столбец
+ */
+NumericColumn rollingAverage(const NumericColumn &column, size_t window);
+
+/**
+ * @brief Накопленная сумма: значение строки - сумма присутствующих значений
+ * от первой строки до текущей. Строки без значения остаются пропусками
+ * @param column числовой столбец
+ * @return производный столбец
+ */
+NumericColumn cumulativeSum(const NumericColumn &column);
+
+#endif // !WINDOW_H
@@ -37,14 +37,14 @@ namespace tests {
         std::cout << "############# TESTGROUP: test_variables" << std::endl;
         try{
             Yaml yamlFile( dirpath() + std::string("/1.yaml"));
-            total++; passed += assert(yamlFile["version"].getData<std::string>(), std::string("1.2.3")); 
-            total++; passed += assert(yamlFile["name"].getData<std::string>(), std::string("\"tiny yaml\""));
-            total++; passed += assert(yamlFile["age"].getData<std::string>(), std::string("123"));
-            total++; passed += assert(yamlFile["alive"].getData<std::string>(), std::string("true"));
-            total++; passed += assert(yamlFile["complex_text"].getData<std::string>(), std::string("\"-1234he-\"")); 
-            total++; passed += assert(yamlFile["comment_text"].getData<std::string>(), std::string("\"this is how to write a # comment\""));
-            total++; passed += assert(yamlFile["var_comm"].getData<std::string>(), std::string("\"Some text\""));
-            total++; passed += assert(yamlFile["special_text"].getData<std::string>(), std::string("\"Some#text\""));
+            total++; passed += assert(std::string(yamlFile["version"].value()), std::string("1.2.3")); 
+            total++; passed += assert(std::string(yamlFile["name"].value()), std::string("\"tiny yaml\""));
+            total++; passed += assert(std::string(yamlFile["age"].value()), std::string("123"));
+            total++; passed += assert(std::string(yamlFile["alive"].value()), std::string("true"));
+            total++; passed += assert(std::string(yamlFile["complex_text"].value()), std::string("\"-1234he-\"")); 
+            total++; passed += assert(std::string(yamlFile["comment_text"].value()), std::string("\"this is how to write a # comment\""));
+            total++; passed += assert(std::string(yamlFile["var_comm"].value()), std::string("\"Some text\""));
+            total++; passed += assert(std::string(yamlFile["special_text"].value()), std::string("\"Some#text\""));
         }catch(const std::exception& e){
             std::cerr << e.what() << std::endl;
             return false;
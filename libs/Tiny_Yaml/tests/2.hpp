@@ -37,9 +37,9 @@
          std::cout << "############# TESTGROUP: test_2_basic_object" << std::endl;
          try{
              Yaml yamlFile( dirpath() + std::string("/2.yaml"));
-             total++; passed += assert(yamlFile["object"]["name"].getData<std::string>(), std::string("\"mohido\"")); 
-             total++; passed += assert(yamlFile["object"]["property"].getData<std::string>(), std::string("\"cool-as#hell\"")); 
-             total++; passed += assert(yamlFile["variable"].getData<std::string>(), std::string("\"Some#text\"")); 
+             total++; passed += assert(std::string(yamlFile["object"]["name"].value()), std::string("\"mohido\"")); 
+             total++; passed += assert(std::string(yamlFile["object"]["property"].value()), std::string("\"cool-as#hell\"")); 
+             total++; passed += assert(std::string(yamlFile["variable"].value()), std::string("\"Some#text\"")); 
          }catch(const std::exception& e){
              std::cerr << e.what() << std::endl;
              return false;
@@ -37,10 +37,10 @@
          std::cout << "############# TESTGROUP: test_basic_list" << std::endl;
          try{
              Yaml yamlFile( dirpath() + std::string("/3.yaml"));
-             total++; passed += assert(yamlFile["list"].getData<std::vector<std::string>>().size(), std::size_t(3)); 
-             total++; passed += assert(yamlFile["list"].getData<std::vector<std::string>>()[0], std::string("item1")); 
-             total++; passed += assert(yamlFile["list"].getData<std::vector<std::string>>()[1], std::string("item2")); 
-             total++; passed += assert(yamlFile["list"].getData<std::vector<std::string>>()[2], std::string("item3")); 
+             total++; passed += assert(yamlFile["list"].items().size(), std::size_t(3)); 
+             total++; passed += assert(std::string(yamlFile["list"].items()[0]), std::string("item1")); 
+             total++; passed += assert(std::string(yamlFile["list"].items()[1]), std::string("item2")); 
+             total++; passed += assert(std::string(yamlFile["list"].items()[2]), std::string("item3")); 
          }catch(const std::exception& e){
              std::cerr << e.what() << std::endl;
              return false;
@@ -37,8 +37,8 @@
          std::cout << "############# TESTGROUP: test_basic_object_list" << std::endl;
          try{
              Yaml yamlFile( dirpath() + std::string("/4.yaml"));
-             total++; passed += assert(yamlFile["hell"]["0"]["item1"].getData<std::string>(), std::string("\"sang\"")); 
-             total++; passed += assert(yamlFile["hell"]["1"]["item1"].getData<std::string>(), std::string("\"mang\"")); 
+             total++; passed += assert(std::string(yamlFile["hell"]["0"]["item1"].value()), std::string("\"sang\"")); 
+             total++; passed += assert(std::string(yamlFile["hell"]["1"]["item1"].value()), std::string("\"mang\"")); 
          }catch(const std::exception& e){
              std::cerr << e.what() << std::endl;
              return false;
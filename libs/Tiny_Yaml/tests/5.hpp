@@ -37,17 +37,17 @@
          std::cout << "############# TESTGROUP: test_complex_nested_object" << std::endl;
          try{
              Yaml yamlFile( dirpath() + std::string("/5.yaml"));
-             total++; passed += assert(yamlFile["node_list"]["0"]["name"].getData<std::string>(), std::string("\"node1\"")); 
-             total++; passed += assert(yamlFile["node_list"]["0"]["value"].getData<std::string>(), std::string("1")); 
-             total++; passed += assert(yamlFile["node_list"]["0"]["hell"]["0"]["item1"].getData<std::string>(), std::string("\"sang\"")); 
-             total++; passed += assert(yamlFile["node_list"]["0"]["hell"]["1"]["item1"].getData<std::string>(), std::string("\"mang\"")); 
-             total++; passed += assert(yamlFile["node_list"]["1"]["name"].getData<std::string>(), std::string("\"node2\"")); 
-             total++; passed += assert(yamlFile["node_list"]["1"]["value"].getData<std::string>(), std::string("2")); 
-             total++; passed += assert(yamlFile["node_list"]["1"]["temp"].getData<std::string>(), std::string("extra")); 
-             total++; passed += assert(yamlFile["node_list"]["1"]["extra"].getData<std::vector<std::string>>().size(), std::size_t(3));
-             total++; passed += assert(yamlFile["node_list"]["1"]["extra"].getData<std::vector<std::string>>()[0], std::string("extra1"));
-             total++; passed += assert(yamlFile["node_list"]["1"]["extra"].getData<std::vector<std::string>>()[1], std::string("extra2"));
-             total++; passed += assert(yamlFile["node_list"]["1"]["extra"].getData<std::vector<std::string>>()[2], std::string("extra3"));
+             total++; passed += assert(std::string(yamlFile["node_list"]["0"]["name"].value()), std::string("\"node1\"")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["0"]["value"].value()), std::string("1")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["0"]["hell"]["0"]["item1"].value()), std::string("\"sang\"")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["0"]["hell"]["1"]["item1"].value()), std::string("\"mang\"")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["name"].value()), std::string("\"node2\"")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["value"].value()), std::string("2")); 
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["temp"].value()), std::string("extra")); 
+             total++; passed += assert(yamlFile["node_list"]["1"]["extra"].items().size(), std::size_t(3));
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["extra"].items()[0]), std::string("extra1"));
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["extra"].items()[1]), std::string("extra2"));
+             total++; passed += assert(std::string(yamlFile["node_list"]["1"]["extra"].items()[2]), std::string("extra3"));
          }catch(const std::exception& e){
              std::cerr << e.what() << std::endl;
              return false;
@@ -15,93 +15,131 @@
  * Module: Tiny Yaml parser
  * Official Remote Repository: https://github.com/Mohido/Tiny_Yaml.git
  * How to Use:
- *	1) Create a yaml object: `TINY_YAML::Yaml
- *coolYamlObject(<yaml_file_path>);` 2) The object will parse the yaml file
- *during initialization 3) Then use the brackets `[]` to access the yaml data:
- *`coolYamlObject[<node_ID>][<node_ID>].getData<std::string>();` 4) In point 3,
- *we are accessing the value of the following yaml: <node_ID>: <node_ID>:
- *<value>
+ *	1) Create a yaml object: `TINY_YAML::Yaml coolYamlObject(<yaml_file_path>);`
+ *	2) The object will parse the yaml file during initialization
+ *	3) Then use the brackets `[]` to access the yaml data:
+ *	`coolYamlObject[<node_ID>][<node_ID>].value();`
  *
  * Notes:
- *	- All values are stored as strings. The developer will have to go
- *through changing a string to number if needed. (e.g: if value is 123, it is
- *stored as string)
- *	- At the moment there is no save into file function since it is using
- *the std::unordered_map for storing the children nodes.
- *	- This is a light-weight library, meaning that it will not handle
- *exceptions and missuse of data. For instance, accessing a node that does not
- *exist will not be handled by the library.
+ *	- The file is mapped into memory and parsed in a single pass. Node
+ *identifiers and values are std::string_view into that buffer, so they stay
+ *valid while the Yaml object lives. Lines have no length limit.
+ *	- Nodes are allocated from an arena owned by the Yaml object and keep
+ *their children in insertion order (getChildIds returns the file order).
+ *	- A dash starts a list only at the beginning of a line, so values such as
+ *`min: -5` or `expr: a - b` are plain values.
+ *	- All values are stored as strings. Accessing a node that does not exist
+ *returns an empty node.
  *
- *
- * Example Yaml file:
- *		|-------------------------------------|
- *		| object: | |   name: "mohido" | |   property: "cool as hell"
- *| | 									  | |
- *version: 123						  | | academy: "333"
- *| | 									  | |
- *list:								  | |   - item1
- *| |   - item2							  | |   - item3
- *| | 									  | |
- *node_list: 						  | |   - name : "node1"
- *| |     value: 1						  | |     hell:
- *| |       - item1: "sang"				  | |       - item1:
- *"mang"				  | |   - name : "node2"
- *| |     value: 2						  | |     temp:
- *extra					  | |     extra:
- *| |       - extra1					  | |       - extra2
- *| |       - extra3					  | |
- *|
- *		|-------------------------------------|
- *
- * -	value <"mohido"> in <object.name> can be accessed as follows:
- *		coolYamlObject["object"]["name"].getData<std::string>();
- * Note, this returns a reference to the data itself, the user can copy it
- *into a new object or use the object directly.
- *
- * - value <123> of the <version> can be accessed as follows:
- *		coolYamlObject["version"].getData<std::string>();
+ * - value <"mohido"> in <object.name> can be accessed as follows:
+ *		coolYamlObject["object"]["name"].value();
  *
  * - value <item1> of <list[0]> can be accessed as follows:
- *		coolYamlObject["list"].getData<std::vector<std::string>>()[0];
- *	// When a node contains a list of elements, it can be accessed via
- *`getData<std::vector<std::string>>`
+ *		coolYamlObject["list"].items()[0];
  *
  * - value <"node1"> of <node_list[0].name> can be accessed as follows:
- *		coolYamlObject["node_list"]["0"]["name"].getData<std::string>();
+ *		coolYamlObject["node_list"]["0"]["name"].value();
  *	// When a node contains a list of nodes, it can be access via
  *`["<nodes_index>"]`
- *
- * - value <extra3> of <node_list[1].extra[2]> can be accessed as follows:
- *		coolYamlObject["node_list"]["1"]["extra"].getData<std::vector<std::string>>()[2];
  */
 #include "yaml.hpp"
 
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
+#include <iterator>
 #include <memory>
-#include <stack>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <unordered_map>
 #include <vector>
 
 namespace TINY_YAML {
 
-/////////////////////////////// NODE CLASS METHODS
-//////////////////////////////////
-Node::Node(const std::string &identifier, std::shared_ptr<void> data)
-    : m_identifier(identifier), m_data(data) {}
+namespace {
+const unsigned int INDEX_THRESHOLD = 8; // children before building the index
+const std::size_t ARENA_BLOCK = 1024;   // nodes in one arena block
+const char *BLANKS = " \t\f\v\r";       // characters trimmed around tokens
+const std::size_t npos = std::string_view::npos;
 
-Node::~Node() { m_children.clear(); }
+/*
+ * Parent node on the stack: its indentation, if it holds list values and if
+ * it is a virtual node of a list item (`- key: value`)
+ */
+struct Parent {
+  Node *node;
+  long indent;
+  bool list;
+  bool item;
+};
+
+/*
+ * @brief Убрать пробельные символы по краям
+ */
+std::string_view trim(std::string_view text) {
+  std::size_t first = text.find_first_not_of(BLANKS);
+  if (first == npos)
+    return {};
+  return text.substr(first, text.find_last_not_of(BLANKS) - first + 1);
+}
+} // namespace
 
-std::string &Node::getID() { return this->m_identifier; }
+/////////////////////////////// NODE CLASS METHODS
+//////////////////////////////////
+Node::Node(std::string_view identifier, std::string_view value)
+    : m_identifier(identifier), m_value(value) {}
 
-bool Node::append(std::shared_ptr<Node> node) {
-  std::string &nid = node->getID();
-  if (this->m_children.find(nid) != this->m_children.end())
+bool Node::append(Node *node) {
+  if (find(node->m_identifier))
     return false;
-  this->m_children.insert({nid, node});
+
+  if (m_last)
+    m_last->m_next = node;
+  else
+    m_first = node;
+  m_last = node;
+  m_size++;
+
+  if (m_index) {
+    m_index->emplace(node->m_identifier, node);
+  } else if (m_size > INDEX_THRESHOLD) {
+    m_index = std::make_unique<std::unordered_map<std::string_view, Node *>>();
+    for (Node *child = m_first; child; child = child->m_next)
+      m_index->emplace(child->m_identifier, child);
+  }
   return true;
 }
 
+const Node *Node::find(std::string_view identifier) const {
+  if (m_index) {
+    auto it = m_index->find(identifier);
+    return it == m_index->end() ? nullptr : it->second;
+  }
+  for (const Node *child = m_first; child; child = child->m_next) {
+    if (child->m_identifier == identifier)
+      return child;
+  }
+  return nullptr;
+}
+
+const Node &Node::operator[](std::string_view identifier) const {
+  static const Node empty;
+  const Node *child = find(identifier);
+  return child ? *child : empty;
+}
+
+std::vector<std::string> Node::getChildIds() const {
+  std::vector<std::string> ids;
+  ids.reserve(m_size);
+  forEachChild(
+      [&](const Node &child) { ids.emplace_back(child.m_identifier); });
+  return ids;
+}
+
 /////////////////////////////// YAML CLASS METHODS
 //////////////////////////////////
 Yaml::Yaml(const std::string &filepath) {
@@ -110,87 +148,108 @@ Yaml::Yaml(const std::string &filepath) {
         "ERROR: Yaml Parser Object failed during parsing the given file!");
 }
 
-Yaml::~Yaml() { this->m_roots.clear(); }
+Yaml::~Yaml() { close(); }
 
-bool Yaml::load(const std::string &filepath) {
-  /*Variables*/
-  this->m_roots.clear();
-  std::ifstream file(filepath, std::ios_base::in);
-  std::stack<Triple<std::shared_ptr<Node>, unsigned int, bool>>
-      parentsStack; // Holds the parents stack pointers, their indentation and
-                    // if they contain list values.
-  char buf[MAX_CHARACTERS_IN_LINE];
-
-  /*Check the yaml file*/
-  if (!file.is_open()) {
+bool Yaml::open(const std::string &filepath) {
+  int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
     std::cerr << filepath << " cannot be opened" << std::endl;
-    file.close();
     return false;
   }
 
-  /*Read the yaml file line by line*/
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      m_data = static_cast<const char *>(address);
+      m_length = info.st_size;
+      m_mapped = true;
+    }
+  }
+  ::close(fd);
+
+  /*Empty files and special files can not be mapped, read them instead*/
+  if (!m_mapped) {
+    std::ifstream file(filepath, std::ios_base::in | std::ios_base::binary);
+    m_buffer.assign(std::istreambuf_iterator<char>(file),
+                    std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_length = m_buffer.size();
+  }
+  return true;
+}
+
+void Yaml::close() {
+  m_root = Node();
+  m_arena.clear();
+  m_used = 0;
+  m_names.clear();
+
+  if (m_mapped)
+    munmap(const_cast<char *>(m_data), m_length);
+  m_mapped = false;
+  m_data = nullptr;
+  m_length = 0;
+  m_buffer.clear();
+}
+
+Node *Yaml::create(std::string_view identifier, std::string_view value) {
+  if (m_arena.empty() || m_used == ARENA_BLOCK) {
+    m_arena.push_back(std::make_unique<Node[]>(ARENA_BLOCK));
+    m_used = 0;
+  }
+  Node *node = &m_arena.back()[m_used++];
+  node->m_identifier = identifier;
+  node->m_value = value;
+  return node;
+}
+
+bool Yaml::load(const std::string &filepath) {
+  close();
+  if (!open(filepath))
+    return false;
+  if (!parse()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool Yaml::parse() {
+  std::vector<Parent> parents = {{&m_root, -1, false, false}};
   unsigned int line = 0;
   bool faulty = false;
-  while (!file.eof() && !faulty) {
-    file.getline(buf, MAX_CHARACTERS_IN_LINE);
+  std::size_t begin = 0;
+
+  /*Read the contents line by line*/
+  while (begin < m_length && !faulty) {
+    const char *start = m_data + begin;
+    const void *end = std::memchr(start, '\n', m_length - begin);
+    std::size_t size =
+        end ? static_cast<const char *>(end) - start : m_length - begin;
+    std::string_view content(start, size);
+    begin += size + 1;
     line++;
-    if (buf[0] == '\0')
-      continue;
 
-    /*Get the positions of the yaml textmarks*/
-    std::string lineContent =
-        buf; // Transform it into a string to use C++ string methods
-
-    std::size_t hashPos = std::string::npos;
-    std::size_t fstQuotePos = std::string::npos;
-    std::size_t lstQuotePos = std::string::npos;
-    std::size_t dashPos = std::string::npos;
-    // Find special characters which takes NO affect if they are in "" or ''
-    for (size_t i = 0; i < lineContent.length(); i++) {
-      char c = lineContent[i];
-      switch (c) {
-      case '-': {
-        // DO NOT update If ' or " then comes and not ended. And if it is
-        // already assigned
-        if (!(fstQuotePos != std::string::npos &&
-              lstQuotePos == std::string::npos) &&
-            dashPos == std::string::npos) {
-          dashPos = i;
-        }
-      } break;
-      case '#': {
-        // DO NOT update If ' or " comes and not ended. And if # is already
-        // found
-        if (hashPos == std::string::npos &&
-            !(fstQuotePos != std::string::npos &&
-              lstQuotePos == std::string::npos)) {
-          hashPos = i;
-        }
-      } break;
-      case '\'':
-        if (hashPos == std::string::npos && lineContent[i - 1] != '\\') {
-          if (fstQuotePos == std::string::npos)
-            fstQuotePos = i;
-          else if (lstQuotePos == std::string::npos &&
-                   lineContent[fstQuotePos] == c)
-            lstQuotePos = i;
-        }
-        break;
-      case '\"':
-        if (hashPos == std::string::npos && lineContent[i - 1] != '\\') {
-          if (fstQuotePos == std::string::npos)
-            fstQuotePos = i;
-          else if (lstQuotePos == std::string::npos &&
-                   lineContent[fstQuotePos] == c)
-            lstQuotePos = i;
-        }
-        break;
-      default:
+    /*Find the comment and the first colon outside of '' or ""*/
+    char quote = '\0';
+    std::size_t colonPos = npos;
+    for (std::size_t i = 0; i < content.size(); i++) {
+      char c = content[i];
+      if (quote) {
+        if (c == quote && content[i - 1] != '\\')
+          quote = '\0';
+      } else if (c == '\'' || c == '\"') {
+        quote = c;
+      } else if (c == '#') {
+        content = content.substr(0, i);
         break;
+      } else if (c == ':' && colonPos == npos) {
+        colonPos = i;
       }
     }
 
-    if (fstQuotePos != std::string::npos && lstQuotePos == std::string::npos) {
+    if (quote) {
       std::cerr
           << "ERROR: unclosed quote found. Please close the quote and reparse."
           << std::endl;
@@ -198,167 +257,96 @@ bool Yaml::load(const std::string &filepath) {
       break;
     }
 
-    if (hashPos != std::string::npos)
-      lineContent.erase(hashPos);
-
-    std::size_t colonPos = lineContent.find(':');
-    std::size_t firstCharPos = lineContent.find_first_not_of(" -#\t\f\v\n\r");
-    std::size_t lastCharPos = lineContent.find_last_not_of(" #\t\f\v\n\r");
-
-    /*Validation layers*/
-    if (firstCharPos == std::string::npos) // If line is empty (Only white
-                                           // spaces), read next line
+    /*Skip empty lines and document markers (---)*/
+    std::size_t firstCharPos = content.find_first_not_of(BLANKS);
+    if (firstCharPos == npos)
+      continue;
+    content = content.substr(0, content.find_last_not_of(BLANKS) + 1);
+    if (content.find_first_not_of('-', firstCharPos) == npos)
       continue;
 
-    if (colonPos == dashPos &&
-        dashPos ==
-            std::string::npos) { // No dash and no colon in the line => Invalid
+    /*A dash starts a list item only at the beginning of the line*/
+    std::size_t dashPos = npos;
+    std::size_t keyPos = firstCharPos;
+    if (content[firstCharPos] == '-' &&
+        (firstCharPos + 1 == content.size() ||
+         content[firstCharPos + 1] == ' ' ||
+         content[firstCharPos + 1] == '\t')) {
+      dashPos = firstCharPos;
+      keyPos = content.find_first_not_of(BLANKS, dashPos + 1);
+    }
+
+    /*No dash and no colon in the line => Invalid*/
+    if (colonPos == npos && dashPos == npos) {
       faulty = true;
       break;
     }
 
-    /*Starting building the pnode*/
-    std::shared_ptr<Node> pnode;
-    std::size_t nodeLastCharPos =
-        (colonPos <= lastCharPos) ? colonPos : lastCharPos + 1;
-    std::string nodeID = lineContent.substr(
-        firstCharPos,
-        nodeLastCharPos -
-            firstCharPos); // Can be the pnode id or the array values.
-
     /* Layer up. (Current line has less indentation than the previous parent =
-     * does not belong to it)*/
-    while (parentsStack.size() != 0 &&
-           parentsStack.top().second >= firstCharPos) {
-      parentsStack.pop();
+     * does not belong to it). A list item closes the previous item on the same
+     * indentation, but may belong to the key on its own indentation*/
+    long indent = static_cast<long>(dashPos != npos ? dashPos : keyPos);
+    while (parents.back().indent > indent ||
+           (parents.back().indent == indent &&
+            (dashPos == npos || parents.back().item))) {
+      parents.pop_back();
     }
 
     /* List of nodes/items */
-    if (dashPos != std::string::npos) {
-      /*a dash should alway come in the beginning*/
-      if ((parentsStack.top().first->getSize() != 0 &&
-           !parentsStack.top().third) ||
-          parentsStack.size() == 0) {
-        faulty = true;
-        std::cerr << "ERROR: Variable " << nodeID
+    if (dashPos != npos) {
+      Parent &parent = parents.back();
+      if (parent.node == &m_root ||
+          (parent.node->getSize() != 0 && !parent.list)) {
+        std::cerr << "ERROR: Variable " << content.substr(keyPos)
                   << " contains a '-' at column " << dashPos
                   << ". A Dash must not exist there." << std::endl;
+        faulty = true;
         break;
       }
+      parent.list = true;
 
-      parentsStack.top().third =
-          true; // The current parrent is found to have list items
-      /*If dash comes with colon => we create a virtual node that has internal
-       * nodes */
-      if (colonPos != std::string::npos) {
-
-        /* Since the virtual nodes indentation = dashpos, we have to consider
-         * the dashpos now*/
-        while (parentsStack.size() != 0 &&
-               parentsStack.top().second >= dashPos) {
-          parentsStack.pop();
-        }
-
-        /*Create the virtual pnode*/
-        std::string id = std::to_string(
-            parentsStack.top().first->getSize()); // Create the virtual node ID
-        pnode =
-            std::make_shared<Node>(Node(id, nullptr)); // Create a virtual pnode
-
-        /*Append the node to the current parent*/
-        if (!parentsStack.top().first->append(pnode)) {
-          faulty = true;
-          break;
-        }
-        /*Make the current node the new parent*/
-        parentsStack.push(Triple<std::shared_ptr<Node>, unsigned int, bool>(
-            pnode, dashPos, true));
-        dashPos = std::string::npos;
-      } else { /* A list of elements inside the current parent pnode */
-        std::vector<std::string> *pvect =
-            &parentsStack.top()
-                 .first.get()
-                 ->getData<std::vector<std::string>>(); // Get the current data
-        if (pvect == nullptr) { // Create teh data if it is null
-          std::shared_ptr<void> temp =
-              std::make_shared<std::vector<std::string>>();
-          parentsStack.top().first.get()->setData(temp);
-        }
-        pvect = &parentsStack.top()
-                     .first.get()
-                     ->getData<std::vector<std::string>>();
-        pvect->push_back(nodeID);
+      /* A list of elements inside the current parent node */
+      if (colonPos == npos) {
+        parent.node->m_items.push_back(content.substr(keyPos));
         continue;
       }
-    }
 
-    /*If the current node is a parent node with children nodes*/
-    if (colonPos == lastCharPos && colonPos != std::string::npos) {
-      pnode = std::make_shared<Node>(Node(nodeID, nullptr));
-
-      if (parentsStack.size() == 0 &&
-          this->m_roots.find(nodeID) ==
-              this->m_roots.end()) { // If the node is at root level, we add it
-                                     // to the root
-        this->m_roots.insert({nodeID, pnode});
-      } else if (parentsStack.size() == 0 &&
-                 this->m_roots.find(nodeID) !=
-                     this->m_roots.end()) { // If it is at root level and it
-                                            // exists already, we return false
-        faulty = true;
-        break;
-      } else if (parentsStack.size() != 0 &&
-                 !parentsStack.top().first->append(
-                     pnode)) { // If it is not at root level and it is failed to
-                               // attach the current node to the current parent
+      /*If dash comes with colon => we create a virtual node that has internal
+       * nodes */
+      m_names.push_back(std::to_string(parent.node->getSize()));
+      Node *item = create(m_names.back(), {});
+      if (!parent.node->append(item)) {
         faulty = true;
         break;
       }
-      parentsStack.push(Triple<std::shared_ptr<Node>, unsigned int, bool>(
-          pnode, firstCharPos, false));
-      continue;
+      parents.push_back({item, indent, true, true});
     }
 
-    /*Single Node containing a value"*/
-    if (colonPos < lastCharPos && lastCharPos != std::string::npos) {
-      /*value extraction*/
-      std::string value = lineContent.substr(
-          colonPos + 1, lastCharPos - colonPos); // value extraction.
-      value.erase(0, value.find_first_not_of(" \t\f\v\n\r"));
-
-      /*Build pnode*/
-      pnode = std::make_shared<Node>(
-          Node(nodeID, std::make_shared<std::string>(value)));
-
-      if (parentsStack.size() == 0 &&
-          this->m_roots.find(nodeID) ==
-              this->m_roots.end()) { // Insert at root level
-        this->m_roots.insert({nodeID, pnode});
-      } else if (parentsStack.size() != 0 &&
-                 !parentsStack.top().first->append(
-                     pnode)) { // Insert at parent level
-        faulty = true;
-        break;
-      }
+    /*Key of a parent node (`key:`) or of a single node with a value*/
+    std::string_view nodeID =
+        trim(content.substr(keyPos, colonPos - keyPos));
+    std::string_view value = trim(content.substr(colonPos + 1));
+    if (nodeID.empty()) {
+      faulty = true;
+      break;
+    }
+
+    Node *node = create(nodeID, value);
+    if (!parents.back().node->append(node)) {
+      faulty = true;
+      break;
     }
+    if (value.empty())
+      parents.push_back({node, static_cast<long>(keyPos), false, false});
   }
 
   if (faulty) {
     std::cerr << "Yaml Parser: Error: Failed to parse file, invalid yaml "
                  "syntax at line: "
               << line << std::endl;
-    file.close();
-    this->m_roots.clear();
     return false;
   }
-
-  file.close();
   return true;
 }
 
-// For future release if needed.
-/*bool Yaml::save(const std::string& filepath) {
-        return true;
-}*/
-
 } // namespace TINY_YAML
@@ -15,217 +15,186 @@
  * Module: Tiny Yaml parser
  * Official Remote Repository: https://github.com/Mohido/Tiny_Yaml.git
  * How to Use:
- *	1) Create a yaml object: `TINY_YAML::Yaml
- *coolYamlObject(<yaml_file_path>);` 2) The object will parse the yaml file
- *during initialization 3) Then use the brackets `[]` to access the yaml data:
- *`coolYamlObject[<node_ID>][<node_ID>].getData<std::string>();` 4) In point 3,
- *we are accessing the value of the following yaml: <node_ID>: <node_ID>:
- *<value>
+ *	1) Create a yaml object: `TINY_YAML::Yaml coolYamlObject(<yaml_file_path>);`
+ *	2) The object will parse the yaml file during initialization
+ *	3) Then use the brackets `[]` to access the yaml data:
+ *	`coolYamlObject[<node_ID>][<node_ID>].value();`
  *
  * Notes:
- *	- All values are stored as strings. The developer will have to go
- *through changing a string to number if needed. (e.g: if value is 123, it is
- *stored as string)
- *	- At the moment there is no save into file function since it is using
- *the std::unordered_map for storing the children nodes.
- *	- This is a light-weight library, meaning that it will not handle
- *exceptions and missuse of data. For instance, accessing a node that does not
- *exist will not be handled by the library.
+ *	- The file is mapped into memory and parsed in a single pass. Node
+ *identifiers and values are std::string_view into that buffer, so they stay
+ *valid while the Yaml object lives. Lines have no length limit.
+ *	- Nodes are allocated from an arena owned by the Yaml object and keep
+ *their children in insertion order (getChildIds returns the file order).
+ *	- A dash starts a list only at the beginning of a line, so values such as
+ *`min: -5` or `expr: a - b` are plain values.
+ *	- All values are stored as strings. Accessing a node that does not exist
+ *returns an empty node.
  *
+ * - value <"mohido"> in <object.name> can be accessed as follows:
+ *		coolYamlObject["object"]["name"].value();
  *
- * Example Yaml file:
- *		|-------------------------------------|
- *		| object: | |   name: "mohido" | |   property: "cool as hell"
- *| | 									  | |
- *version: 123						  | | academy: "333"
- *| | 									  | |
- *list:								  | |   - item1
- *| |   - item2							  | |   - item3
- *| | 									  | |
- *node_list: 						  | |   - name : "node1"
- *| |     value: 1						  | |     hell:
- *| |       - item1: "sang"				  | |       - item1:
- *"mang"				  | |   - name : "node2"
- *| |     value: 2						  | |     temp:
- *extra					  | |     extra:
- *| |       - extra1					  | |       - extra2
- *| |       - extra3					  | |
- *|
- *		|-------------------------------------|
+ * - value <item1> of <list[0]> can be accessed as follows:
+ *		coolYamlObject["list"].items()[0];
  *
- * -	value <"mohido"> in <object.name> can be accessed as follows:
- *		coolYamlObject["object"]["name"].getData<std::string>();
- *
-*Note, this returns a reference to the data itself,
-    the user can copy it *into a new object or
-        use the object directly.* *
-            -value<123> of the<version> can be accessed as follows
-    : *coolYamlObject["version"]
-          .getData<std::string>();
-**-value<item1> of<list[0]> can be accessed as follows
-    : *coolYamlObject["list"]
-          .getData<std::vector<std::string>>()[0];
-* // When a node contains a list of elements, it can be accessed via
-    *`getData<std::vector<std::string>>` * *
-    -value<"node1"> of<node_list[0].name> can be accessed as follows
-    : *coolYamlObject["node_list"]["0"]["name"]
-          .getData<std::string>();
-* // When a node contains a list of nodes, it can be access via
-    *`["<nodes_index>"]` * *
-    -value<extra3> of<node_list[1].extra[2]> can be accessed as follows
-    : *coolYamlObject["node_list"]["1"]["extra"]
-          .getData<std::vector<std::string>>()[2];
-*/
+ * - value <"node1"> of <node_list[0].name> can be accessed as follows:
+ *		coolYamlObject["node_list"]["0"]["name"].value();
+ *	// When a node contains a list of nodes, it can be access via
+ *`["<nodes_index>"]`
+ */
 #pragma once
 
-#include <cstddef>
 #ifndef TINY_YAML_PARSER
 #define TINY_YAML_PARSER
 
-#define MAX_CHARACTERS_IN_LINE 512
-
+#include <cstddef>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace TINY_YAML {
 
+class Yaml;
+
 /// <summary>
 /// If a node is a leaf => it has data. Otherwise, it has only children nodes.
 /// </summary>
 class Node {
 private:
-  std::string m_identifier;     // name of the node
-  std::shared_ptr<void> m_data; // Contains the data of the node
-  std::unordered_map<std::string, std::shared_ptr<Node>>
-      m_children; // Holds data to the children nodes
+  std::string_view m_identifier;          // name of the node
+  std::string_view m_value;               // value of the leaf node
+  std::vector<std::string_view> m_items;  // list values of the node
+  Node *m_first = nullptr;                // first child node
+  Node *m_last = nullptr;                 // last child node
+  Node *m_next = nullptr;                 // next sibling node
+  unsigned int m_size = 0;                // number of children nodes
+  std::unique_ptr<std::unordered_map<std::string_view, Node *>>
+      m_index; // index of children, built once the node has many of them
+
+  friend class Yaml;
 
-public:
   /// <summary>
-  ///
+  /// Добавить дочерний узел в конец списка детей
   /// </summary>
-  /// <param name="identifier"></param>
-  /// <param name="data"></param>
-  /// <param name="size"></param>
-  Node(const std::string &identifier, std::shared_ptr<void> data);
-  ~Node();
+  /// <param name="node">Узел из арены документа</param>
+  /// <returns>false если узел с таким идентификатором уже есть</returns>
+  bool append(Node *node);
 
-  /// <summary>
-  ///
-  /// </summary>
-  /// <param name="node"></param>
-  /// <returns></returns>
-  bool append(std::shared_ptr<Node> node);
+public:
+  Node() = default;
+  Node(std::string_view identifier, std::string_view value);
 
   /// <summary>
-  ///
+  /// Найти дочерний узел
   /// </summary>
-  /// <returns></returns>
-  unsigned int getSize() { return this->m_children.size(); }
+  /// <param name="identifier">Идентификатор узла</param>
+  /// <returns>Указатель на узел или nullptr</returns>
+  const Node *find(std::string_view identifier) const;
 
   /// <summary>
-  ///
+  /// Количество дочерних узлов
   /// </summary>
-  /// <param name="result"></param>
-  /// <returns></returns>
-  std::string &getID();
+  unsigned int getSize() const { return m_size; }
 
   /// <summary>
-  ///
+  /// Идентификатор узла
   /// </summary>
-  /// <typeparam name="T"></typeparam>
-  /// <param name=""></param>
-  /// <returns></returns>
-  template <typename T> T &getData() {
-    return *std::static_pointer_cast<T>(m_data);
-  }
+  std::string_view getID() const { return m_identifier; }
 
   /// <summary>
-  ///
+  /// Значение узла (пустое, если узел не лист)
   /// </summary>
-  friend std::ostream &operator<<(std::ostream &os, const Node &node) {
-    os << node.m_identifier << " (" << &node << ")" << std::endl;
-    for (const auto &it : node.m_children) {
-      os << node.m_identifier << " : " << *it.second;
-    }
-    return os;
-  }
+  std::string_view value() const { return m_value; }
 
   /// <summary>
-  ///
+  /// Элементы списка узла (`- item`)
   /// </summary>
-  Node &operator[](const std::string &identifier) {
-    return *m_children[identifier];
-  }
+  const std::vector<std::string_view> &items() const { return m_items; }
 
   /// <summary>
-  ///
+  /// Получить дочерний узел
   /// </summary>
-  /// <param name="data"></param>
-  /// <returns></returns>
-  bool setData(std::shared_ptr<void> data) {
-    this->m_data = data;
-    return true;
-  }
+  /// <param name="identifier">Идентификатор узла</param>
+  /// <returns>Узел или пустой узел, если его нет</returns>
+  const Node &operator[](std::string_view identifier) const;
 
   /// <summary>
   /// Получить список всех идентификаторов дочерних узлов
   /// </summary>
-  /// <returns>Вектор идентификаторов</returns>
-  std::vector<std::string> getChildIds() {
-    size_t i = m_children.size() - 1;
-    std::vector<std::string> ids(i + 1);
-
-    for (auto it = m_children.begin(); it != m_children.end(); it++) {
-      ids[i] = (*it).first;
-      i--;
-    }
-    return ids;
-  }
+  /// <returns>Вектор идентификаторов в порядке файла</returns>
+  std::vector<std::string> getChildIds() const;
 
   /// <summary>
   /// Проверить существование дочернего узла
   /// </summary>
   /// <param name="identifier">Идентификатор узла</param>
   /// <returns>true если узел существует</returns>
-  bool hasChild(const std::string &identifier) {
-    return m_children.find(identifier) != m_children.end();
+  bool hasChild(std::string_view identifier) const {
+    return find(identifier) != nullptr;
+  }
+
+  /// <summary>
+  /// Обойти дочерние узлы в порядке файла
+  /// </summary>
+  /// <param name="func">Функция, принимающая const Node &</param>
+  template <typename F> void forEachChild(F func) const {
+    for (const Node *child = m_first; child; child = child->m_next)
+      func(*child);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const Node &node) {
+    os << node.m_identifier << " (" << &node << ")" << std::endl;
+    node.forEachChild(
+        [&](const Node &child) { os << node.m_identifier << " : " << child; });
+    return os;
   }
 };
 
 class Yaml {
-  std::unordered_map<std::string, std::shared_ptr<Node>>
-      m_roots; // The root nodes in the file.
+  std::vector<std::unique_ptr<Node[]>> m_arena; // blocks of the nodes
+  std::size_t m_used = 0;          // nodes taken from the last block
+  std::deque<std::string> m_names; // identifiers of the virtual list nodes
+  Node m_root;                     // holds the root nodes in the file
+  const char *m_data = nullptr;    // contents of the file
+  std::size_t m_length = 0;        // size of the contents
+  bool m_mapped = false;           // contents are mapped with mmap
+  std::string m_buffer;            // contents when mmap is not available
+
+  bool open(const std::string &filepath); // Maps the file into memory
+  void close();                           // Releases the contents and nodes
+  bool parse();                           // Builds the nodes in one pass
+  Node *create(std::string_view identifier, std::string_view value);
+
 public:
   Yaml(const std::string &filepath);
   ~Yaml();
+  Yaml(const Yaml &) = delete;
+  Yaml &operator=(const Yaml &) = delete;
 
   bool load(const std::string &filepath); // Loads data from a specific file
-  // bool save(const std::string& filepath);
-  // // Saves data too a specific file, For future release..
 
-  friend std::ostream &operator<<(std::ostream &os, Yaml &yaml) {
-    for (const auto &it : yaml.m_roots) {
-      os << *it.second;
-    }
+  friend std::ostream &operator<<(std::ostream &os, const Yaml &yaml) {
+    yaml.m_root.forEachChild([&](const Node &node) { os << node; });
     os << std::endl;
     return os;
   }
 
-  Node &operator[](const std::string &identifier) {
-    return *m_roots[identifier];
+  const Node &operator[](std::string_view identifier) const {
+    return m_root[identifier];
   }
-};
 
-template <typename F, typename S, typename T> struct Triple {
-  F first;
-  S second;
-  T third;
-
-  Triple(F first, S second, T third)
-      : first(first), second(second), third(third) {}
+  /// <summary>
+  /// Проверить существование корневого узла
+  /// </summary>
+  /// <param name="identifier">Идентификатор узла</param>
+  /// <returns>true если узел существует</returns>
+  bool hasRoot(std::string_view identifier) const {
+    return m_root.hasChild(identifier);
+  }
 };
 } // namespace TINY_YAML
 
@@ -1,6 +1,10 @@
 #include "include/router.h"
 
-int main() {
+int main(int argc, char *argv[]) {
+
+  // С аргументами командной строки - пакетный режим без ввода
+  if (argc > 1)
+    return SimpleDAG::runBatch(argc, argv);
 
   SimpleDAG::run();
 
@@ -16,4 +16,52 @@ cd ..
 
 cd utils
 ./test_utils.out
+cd ..
+
+cd column
+./test_column.out
+cd ..
+
+cd executor
+./test_executor.out
+cd ..
+
+cd plan
+./test_plan.out
+cd ..
+
+cd sketch
+./test_sketch.out
+cd ..
+
+cd groupby
+./test_groupby.out
+cd ..
+
+cd filter
+./test_filter.out
+cd ..
+
+cd expr
+./test_expr.out
+cd ..
+
+cd window
+./test_window.out
+cd ..
+
+cd sort
+./test_sort.out
+cd ..
+
+cd join
+./test_join.out
+cd ..
+
+cd topk
+./test_topk.out
+cd ..
+
+cd histogram
+./test_histogram.out
 cd ../..
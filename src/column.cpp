@@ -0,0 +1,239 @@
+#include "../include/column.h"
+#include "../include/kernels.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Создать маску валидности без установленных битов
+ * @param length количество строк
+ * @return маска валидности
+ */
+Bitmap createBitmap(size_t length) {
+  Bitmap bitmap;
+  bitmap.length = length;
+  bitmap.words.assign((length + 63) / 64, 0);
+  return bitmap;
+}
+
+/**
+ * @brief Отметить строку как содержащую значение
+ * @param bitmap маска валидности
+ * @param index номер строки
+ */
+void setBit(Bitmap &bitmap, size_t index) {
+  bitmap.words[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+/**
+ * @brief Проверить, есть ли значение в строке
+ * @param bitmap маска валидности
+ * @param index номер строки
+ * @return true, если значение присутствует (или маска пуста), false - иначе
+ */
+bool testBit(const Bitmap &bitmap, size_t index) {
+  if (bitmap.words.empty())
+    return true;
+  return (bitmap.words[index / 64] >> (index % 64)) & 1;
+}
+
+/**
+ * @brief Подсчитать количество присутствующих значений
+ * @param bitmap маска валидности
+ * @return количество установленных битов (length для пустой маски)
+ */
+size_t countBits(const Bitmap &bitmap) {
+  if (bitmap.words.empty())
+    return bitmap.length;
+  return maskedCount(bitmap.words.data(), bitmap.length);
+}
+
+/*
+ * @brief Сжать значения по маске в разреженное представление
+ * @param values значения по строкам
+ * @param validity маска присутствующих значений
+ * @param packed присутствующие значения
+ * @param rows номера строк присутствующих значений
+ */
+template <typename T>
+void packPresent(vector<T> &values, const Bitmap &validity, vector<T> &packed,
+                 vector<uint32_t> &rows) {
+  size_t present = countBits(validity);
+  packed.reserve(present);
+  rows.reserve(present);
+
+  for (size_t w = 0; w < validity.words.size(); w++) {
+    uint64_t word = validity.words[w];
+    // перебираем только установленные биты слова
+    while (word) {
+      size_t row = w * 64 + __builtin_ctzll(word);
+      packed.push_back(std::move(values[row]));
+      rows.push_back(static_cast<uint32_t>(row));
+      word &= word - 1;
+    }
+  }
+}
+
+/*
+ * @brief Проверить, стоит ли хранить столбец разреженно
+ * @param validity маска присутствующих значений
+ * @return true, если доля значений ниже SPARSE_DENSITY
+ */
+bool shouldBeSparse(const Bitmap &validity) {
+  if (validity.words.empty() or validity.length == 0)
+    return false;
+  return countBits(validity) < SPARSE_DENSITY * validity.length;
+}
+
+/**
+ * @brief Собрать числовой столбец, выбрав способ хранения по плотности
+ * @param values значения по строкам (length штук)
+ * @param validity маска присутствующих значений
+ * @return столбец в плотном или разреженном представлении
+ */
+NumericColumn makeNumericColumn(vector<float> values, Bitmap validity) {
+  NumericColumn column;
+  column.length = validity.length;
+
+  if (shouldBeSparse(validity)) {
+    column.layout = SPARSE;
+    packPresent(values, validity, column.values, column.rows);
+  } else {
+    column.layout = DENSE;
+    column.values = std::move(values);
+    // маска без пропусков не нужна ядрам
+    if (countBits(validity) != validity.length)
+      column.validity = std::move(validity);
+    else
+      column.validity.length = column.length;
+  }
+  return column;
+}
+
+/**
+ * @brief Собрать строковый столбец, выбрав способ хранения по плотности
+ * @param values значения по строкам (length штук)
+ * @param validity маска присутствующих значений
+ * @return столбец в плотном или разреженном представлении
+ */
+StringColumn makeStringColumn(vector<string> values, Bitmap validity) {
+  StringColumn column;
+  column.length = validity.length;
+
+  if (shouldBeSparse(validity)) {
+    column.layout = SPARSE;
+    packPresent(values, validity, column.values, column.rows);
+  } else {
+    column.layout = DENSE;
+    column.values = std::move(values);
+    if (countBits(validity) != validity.length)
+      column.validity = std::move(validity);
+    else
+      column.validity.length = column.length;
+  }
+  return column;
+}
+
+/**
+ * @brief Получить слова маски для передачи в вычислительные ядра
+ * @param column числовой столбец
+ * @return указатель на слова маски или nullptr, если все значения из values
+ * присутствуют
+ */
+const uint64_t *validityWords(const NumericColumn &column) {
+  if (column.layout == SPARSE or column.validity.words.empty())
+    return nullptr;
+  return column.validity.words.data();
+}
+
+/**
+ * @brief Получить слова маски для передачи в вычислительные ядра
+ * @param column строковый столбец
+ * @return указатель на слова маски или nullptr, если все значения из values
+ * присутствуют
+ */
+const uint64_t *validityWords(const StringColumn &column) {
+  if (column.layout == SPARSE or column.validity.words.empty())
+    return nullptr;
+  return column.validity.words.data();
+}
+
+/**
+ * @brief Подсчитать количество присутствующих значений столбца
+ * @param column числовой столбец
+ * @return количество значений
+ */
+size_t presentCount(const NumericColumn &column) {
+  return maskedCount(validityWords(column), column.values.size());
+}
+
+/**
+ * @brief Подсчитать количество присутствующих значений столбца
+ * @param column строковый столбец
+ * @return количество значений
+ */
+size_t presentCount(const StringColumn &column) {
+  return maskedCount(validityWords(column), column.values.size());
+}
+
+/**
+ * @brief Представление произвольного буфера
+ * @param values значения
+ * @param validity слова маски или nullptr
+ * @param length количество значений
+ */
+NumericView::NumericView(const float *values, const uint64_t *validity,
+                         size_t length)
+    : values(values), validity(validity), length(length),
+      row_count(length) {}
+
+/**
+ * @brief Представление вектора значений без пропусков
+ * @param values значения
+ */
+NumericView::NumericView(const vector<float> &values)
+    : values(values.data()), validity(nullptr), length(values.size()),
+      row_count(values.size()) {}
+
+/**
+ * @brief Представление присутствующих значений столбца
+ * @param column столбец
+ */
+NumericView::NumericView(const NumericColumn &column)
+    : values(column.values.data()), validity(validityWords(column)),
+      length(column.values.size()),
+      rows(column.layout == SPARSE ? column.rows.data() : nullptr),
+      row_count(column.length) {}
+
+/**
+ * @brief Представление произвольного буфера
+ * @param values строки
+ * @param validity слова маски или nullptr
+ * @param length количество строк
+ */
+StringView::StringView(const string *values, const uint64_t *validity,
+                       size_t length)
+    : values(values), validity(validity), length(length),
+      row_count(length) {}
+
+/**
+ * @brief Представление вектора строк без пропусков
+ * @param values строки
+ */
+StringView::StringView(const vector<string> &values)
+    : values(values.data()), validity(nullptr), length(values.size()),
+      row_count(values.size()) {}
+
+/**
+ * @brief Представление присутствующих строк столбца
+ * @param column столбец
+ */
+StringView::StringView(const StringColumn &column)
+    : values(column.values.data()), validity(validityWords(column)),
+      length(column.values.size()),
+      rows(column.layout == SPARSE ? column.rows.data() : nullptr),
+      row_count(column.length) {}
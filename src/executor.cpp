@@ -0,0 +1,601 @@
+#include "../include/executor.h"
+#include "../include/graph.h"
+#include "../include/join.h"
+#include "../include/operations.h"
+#include "../include/parser.h"
+#include "../include/plan.h"
+#include "../include/utils.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fnmatch.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+namespace executor {
+
+map<string, plan::Task> tasks_by_id;    // операции графа
+map<string, plan::SharedResult> merged; // объединенные результаты по id
+map<string, string> reused;             // id -> id владельца общего результата
+plan::Cache cache;                      // кэш результатов над текущей таблицей
+size_t skipped_count = 0;               // операции, пропущенные при записи
+const string CSV_EXTENSION = ".csv";    // расширение файлов данных
+const string GLOB_SYMBOLS = "*?[";      // символы шаблона имени файла
+
+/*
+ * @brief Получить список файлов данных по пути из конфигурации
+ * @param path путь к файлу, директории (все файлы .csv) или шаблон имени
+ * файла (*, ?, [...]) внутри директории
+ * @return отсортированный вектор путей к файлам
+ */
+vector<string> resolveShards(const string &path) {
+  vector<string> shards;
+  std::error_code error;
+
+  if (fs::is_directory(path, error)) {
+    for (const fs::directory_entry &entry :
+         fs::directory_iterator(path, error)) {
+      if (entry.is_regular_file() and
+          entry.path().extension() == CSV_EXTENSION)
+        shards.push_back(entry.path().string());
+    }
+  } else if (path.find_first_of(GLOB_SYMBOLS) != string::npos) {
+    fs::path pattern(path);
+    fs::path directory =
+        pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+    string name = pattern.filename().string();
+
+    for (const fs::directory_entry &entry :
+         fs::directory_iterator(directory, error)) {
+      string file = entry.path().filename().string();
+      if (entry.is_regular_file() and
+          fnmatch(name.c_str(), file.c_str(), 0) == 0)
+        shards.push_back(entry.path().string());
+    }
+  } else {
+    shards.push_back(path);
+  }
+
+  // порядок файлов определяет порядок объединения результатов
+  std::sort(shards.begin(), shards.end());
+  return shards;
+}
+
+/*
+ * @brief Собрать результаты по id операций
+ * @param tasks операции
+ * @param partials частичные результаты (по индексу в tasks)
+ * @param sources id операций, чьи результаты взяты из кэша
+ * @param errors ошибки выполнения (по индексу в tasks, пусто - без ошибки)
+ * @param reused_from id операции -> id операции, чей результат взят из кэша
+ * @param failed id операции -> ошибка выполнения
+ * @return частичный результат для каждого id операции
+ */
+map<string, plan::SharedResult>
+byId(const vector<plan::Task> &tasks,
+     const vector<plan::SharedResult> &partials, const vector<string> &sources,
+     const vector<string> &errors, map<string, string> *reused_from,
+     map<string, string> *failed) {
+  map<string, plan::SharedResult> results;
+
+  for (size_t t = 0; t < tasks.size(); t++) {
+    results[tasks[t].id] = partials[t];
+    if (reused_from and t < sources.size() and !sources[t].empty())
+      (*reused_from)[tasks[t].id] = sources[t];
+    if (failed and t < errors.size() and !errors[t].empty())
+      (*failed)[tasks[t].id] = errors[t];
+  }
+  return results;
+}
+
+/*
+ * @brief Проверить, зависят ли строки таблицы операции от основной таблицы:
+ * это сама основная таблица и соединения, левая таблица которых от нее
+ * зависит
+ * @param tasks операции
+ * @param name имя таблицы операции (пусто - основная)
+ * @return true, если таблица зависит от основной
+ */
+bool dependsOnMain(const vector<plan::Task> &tasks, const string &name) {
+  string current = name;
+  // шагов не больше, чем операций, даже если соединения ссылаются по кругу
+  for (size_t step = 0; step <= tasks.size(); step++) {
+    if (current.empty())
+      return true;
+    auto join = std::find_if(
+        tasks.begin(), tasks.end(), [&](const plan::Task &task) {
+          return task.id == current and isJoin(task.op);
+        });
+    if (join == tasks.end())
+      return false;
+    current = join->table;
+  }
+  return false;
+}
+
+/*
+ * @brief Выполнить соединение таблиц. Параметры соединения проверены при
+ * компиляции плана, но правая таблица могла не загрузиться
+ * @param task операция соединения
+ * @param left левая таблица
+ * @param target таблица результата (заполняется)
+ * @param error ошибка выполнения (заполняется при ошибке)
+ * @return частичный результат: количество строк соединения
+ */
+PartialResult evaluateJoin(const plan::Task &task, const table::Table &left,
+                           table::Table &target, string &error) {
+  PartialResult partial;
+  auto right = task.params.find(plan::PARAM_RIGHT);
+  table::Table *source = right == task.params.end()
+                             ? nullptr
+                             : table::namedTable(right->second);
+  if (!source) {
+    error = "Right table not found";
+    return partial;
+  }
+
+  int right_key = 0;
+  auto column = task.params.find(plan::PARAM_RIGHT_COLUMN);
+  if (column != task.params.end())
+    right_key = std::stoi(column->second);
+
+  table::assign(target, hashJoin(left, task.column, *source, right_key));
+  partial.type = STRING;
+  partial.count = target.rows.size();
+  return partial;
+}
+
+/*
+ * @brief Выполнить выбранные операции над их таблицами: сначала соединения
+ * (каждое - когда готова его левая таблица), затем операции каждой таблицы
+ * одним планом
+ * @param main основная таблица (nullptr, если ее операции не выбраны)
+ * @param tasks операции
+ * @param selected выполнять ли операцию (по индексу в tasks)
+ * @param cache кэш результатов запуска
+ * @param sources id операций, чьи результаты взяты из кэша (заполняется)
+ * @param errors ошибки выполнения по индексу в tasks (заполняется)
+ * @return частичный результат для каждой операции (по индексу в tasks)
+ */
+vector<plan::SharedResult> evaluateTables(table::Table *main,
+                                          const vector<plan::Task> &tasks,
+                                          const vector<bool> &selected,
+                                          plan::Cache &cache,
+                                          vector<string> &sources,
+                                          vector<string> &errors) {
+  // невыполненные операции получают одно общее пустое состояние
+  vector<plan::SharedResult> results(tasks.size(),
+                                     std::make_shared<const PartialResult>());
+  sources.assign(tasks.size(), "");
+  errors.assign(tasks.size(), "");
+  map<string, table::Table> joined; // id соединения -> его таблица
+
+  auto find = [&](const string &name) -> table::Table * {
+    if (name.empty())
+      return main;
+    auto join = joined.find(name);
+    return join != joined.end() ? &join->second : table::namedTable(name);
+  };
+
+  vector<bool> done(tasks.size(), false);
+  for (bool progress = true; progress;) {
+    progress = false;
+    for (size_t t = 0; t < tasks.size(); t++) {
+      if (!selected[t] or done[t] or !isJoin(tasks[t].op))
+        continue;
+      table::Table *left = find(tasks[t].table);
+      if (!left)
+        continue;
+      done[t] = progress = true;
+      results[t] = std::make_shared<const PartialResult>(
+          evaluateJoin(tasks[t], *left, joined[tasks[t].id], errors[t]));
+    }
+  }
+
+  // операции каждой таблицы выполняются одним планом
+  map<string, vector<size_t>> by_table;
+  for (size_t t = 0; t < tasks.size(); t++) {
+    if (selected[t] and isJoin(tasks[t].op) and !done[t])
+      errors[t] = "Table " + tasks[t].table + " not found";
+    else if (selected[t] and !isJoin(tasks[t].op))
+      by_table[tasks[t].table].push_back(t);
+  }
+
+  for (const auto &[name, indices] : by_table) {
+    table::Table *source = find(name);
+    if (!source) {
+      for (size_t t : indices) {
+        errors[t] = "Table " + name + " not found";
+      }
+      continue;
+    }
+
+    vector<plan::Task> subset;
+    for (size_t t : indices) {
+      subset.push_back(tasks[t]);
+    }
+    vector<string> subset_sources;
+    vector<plan::SharedResult> partials = plan::evaluate(
+        *source, subset, plan::groupByColumn(subset), cache, subset_sources);
+    for (size_t k = 0; k < indices.size(); k++) {
+      results[indices[k]] = std::move(partials[k]);
+      if (k < subset_sources.size())
+        sources[indices[k]] = subset_sources[k];
+    }
+  }
+  return results;
+}
+
+/*
+ * @brief Выполнить операции над одной таблицей и таблицами конфигурации
+ * @param source таблица
+ * @param tasks операции
+ * @param cache кэш результатов запуска
+ * @param reused_from id операции -> id операции, чей результат взят из кэша
+ * @param failed id операции -> ошибка выполнения
+ * @return частичный результат для каждого id операции
+ */
+map<string, plan::SharedResult> runTable(table::Table &source,
+                                         const vector<plan::Task> &tasks,
+                                         plan::Cache &cache,
+                                         map<string, string> *reused_from,
+                                         map<string, string> *failed) {
+  vector<string> sources;
+  vector<string> errors;
+  vector<plan::SharedResult> partials =
+      evaluateTables(&source, tasks, vector<bool>(tasks.size(), true), cache,
+                     sources, errors);
+
+  return byId(tasks, partials, sources, errors, reused_from, failed);
+}
+
+/*
+ * @brief Обработать файлы данных параллельно и объединить частичные
+ * результаты в порядке файлов
+ * @param shards пути к файлам данных
+ * @param tasks операции
+ * @param workers количество потоков (0 - по числу ядер)
+ * @param reused_from id операции -> id операции, чей результат взят из кэша
+ * @param failed id операции -> ошибка выполнения
+ * @return объединенный частичный результат для каждого id операции
+ */
+map<string, plan::SharedResult> runShards(const vector<string> &shards,
+                                          const vector<plan::Task> &tasks,
+                                          unsigned workers,
+                                          map<string, string> *reused_from,
+                                          map<string, string> *failed) {
+  // операции над файлами набора выполняются для каждого файла, а операции
+  // над таблицами конфигурации - один раз
+  vector<bool> per_shard(tasks.size());
+  vector<bool> once(tasks.size());
+  for (size_t t = 0; t < tasks.size(); t++) {
+    per_shard[t] = dependsOnMain(tasks, tasks[t].table);
+    once[t] = !per_shard[t];
+  }
+
+  vector<vector<plan::SharedResult>> partials(shards.size());
+  vector<vector<string>> sources(shards.size());
+  vector<vector<string>> errors(shards.size());
+  std::atomic<size_t> next(0);
+
+  // каждый поток берет следующий необработанный файл
+  auto worker = [&]() {
+    // файлы уже обрабатываются параллельно, поэтому ядра операций внутри
+    // файла выполняются в одном потоке
+    WorkerThreadScope scope(workers > 1);
+    for (size_t s = next++; s < shards.size(); s = next++) {
+      table::Table shard;
+      table::read(shard, shards[s]);
+
+      // у каждого файла своя версия данных, поэтому кэш локален для файла
+      plan::Cache shard_cache;
+      partials[s] = evaluateTables(&shard, tasks, per_shard, shard_cache,
+                                   sources[s], errors[s]);
+    }
+  };
+
+  workers = resolveWorkers(workers);
+  workers = std::min<size_t>(workers, std::max<size_t>(shards.size(), 1));
+
+  vector<std::thread> pool;
+  for (unsigned i = 1; i < workers; i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (std::thread &thread : pool) {
+    thread.join();
+  }
+
+  plan::Cache once_cache;
+  vector<string> once_sources;
+  vector<string> once_errors;
+  vector<plan::SharedResult> totals = evaluateTables(
+      nullptr, tasks, once, once_cache, once_sources, once_errors);
+  for (size_t t = 0; t < tasks.size(); t++) {
+    if (!per_shard[t])
+      continue;
+    PartialResult total;
+    for (size_t s = 0; s < shards.size(); s++) {
+      mergePartial(total, *partials[s][t]);
+    }
+    totals[t] = std::make_shared<const PartialResult>(std::move(total));
+    // повторы операций одинаковы во всех файлах, а ошибка берется из
+    // первого файла, где она возникла
+    once_sources[t] = sources.empty() ? "" : sources[0][t];
+    for (size_t s = 0; s < shards.size() and once_errors[t].empty(); s++) {
+      once_errors[t] = errors[s][t];
+    }
+  }
+  return byId(tasks, totals, once_sources, once_errors, reused_from, failed);
+}
+
+/*
+ * @brief Вычислить результаты всех операций графа, просматривая каждый
+ * столбец один раз
+ * @param shards пути к файлам данных (пустой вектор - текущая таблица)
+ */
+void run(const vector<string> &shards) {
+  // операции узлов берутся из плана, скомпилированного при загрузке;
+  // операции с ошибками конфигурации не выполняются
+  vector<plan::Task> tasks;
+  for (Node *node = firstNode(); node; node = node->next_head) {
+    const plan::Task *task = plan::taskOf(node);
+    if (task and task->error.empty())
+      tasks.push_back(*task);
+  }
+  for (const plan::Task &task : tasks) {
+    tasks_by_id[task.id] = task;
+  }
+
+  // ошибки выполнения записываются в операции и выводятся как ошибки
+  // конфигурации
+  map<string, string> failed;
+  if (shards.empty())
+    merged = runTable(table::currentTable(), tasks, cache, &reused, &failed);
+  else
+    merged = runShards(shards, tasks, 0, &reused, &failed);
+  for (const auto &[id, error] : failed) {
+    tasks_by_id[id].error = error;
+  }
+}
+
+/*
+ * @brief Собрать входные данные операции из результатов предыдущих узлов:
+ * числа дают числовой вход, а строки и столбцы - строковый (числа при этом
+ * записываются как текст). Столбцы читаются без копирования
+ * @param sources узлы, чьи результаты читает операция
+ * @param needs что вычислить, кроме суммы и количества
+ * @return частичный результат (тип UNKNOWN, если у источника нет результата)
+ */
+PartialResult upstreamState(const vector<Node *> &sources,
+                            const StateNeeds &needs) {
+  vector<float> numbers;
+  for (Node *source : sources) {
+    if (source->output.kind == NO_OUTPUT)
+      return PartialResult();
+    if (source->output.kind == NUMBER_OUTPUT)
+      numbers.push_back(source->output.number);
+  }
+  if (numbers.size() == sources.size())
+    return sources.empty() ? PartialResult()
+                           : partialOf(NumericView(numbers), needs);
+
+  // результаты объединяются в порядке источников
+  PartialResult state;
+  for (Node *source : sources) {
+    const NodeOutput &output = source->output;
+    if (output.kind == COLUMN_OUTPUT) {
+      StateNeeds pass = needs;
+      pass.stream = false;
+      PartialResult part = partialOf(StringView(*output.column), pass);
+      if (needs.stream)
+        part.pieces.push_back({output.column, Bitmap()});
+      mergePartial(state, part);
+      continue;
+    }
+
+    string value = output.text;
+    if (output.kind == NUMBER_OUTPUT) {
+      std::ostringstream text;
+      text << output.number;
+      value = text.str();
+    }
+    mergePartial(state, partialOf(StringView(vector<string>({value})), needs));
+  }
+  return state;
+}
+
+/*
+ * @brief Узлы, чьи результаты читает операция, или пустой вектор, если
+ * операция читает столбец таблицы (в том числе производный столбец,
+ * вычисленный планом)
+ * @param node узел операции
+ * @param task операция узла
+ * @return узлы-источники
+ */
+vector<Node *> upstreamSources(Node *node, const plan::Task &task) {
+  if (task.input == plan::INPUT_PARENTS)
+    return parentNodes(node);
+
+  auto input = tasks_by_id.find(task.input);
+  if (task.input.empty() or input == tasks_by_id.end() or
+      isTransform(input->second.op))
+    return {};
+
+  Node *source = getNodeById(task.input);
+  return source ? vector<Node *>({source}) : vector<Node *>();
+}
+
+/*
+ * @brief Вычислить результат операции над результатами предыдущих узлов
+ * @param task операция узла
+ * @param sources узлы-источники
+ * @param partial результат (заполняется)
+ * @return true, если у всех источников есть результат
+ */
+bool evaluateUpstream(const plan::Task &task, const vector<Node *> &sources,
+                      PartialResult &partial) {
+  // оконной операции нужен порядок строк таблицы, которого нет у
+  // результатов узлов-источников
+  if (isWindow(task.op))
+    return false;
+
+  // преобразование получает столбец единственного источника
+  if (isTransform(task.op)) {
+    if (sources.size() != 1 or sources[0]->output.kind != COLUMN_OUTPUT)
+      return false;
+    partial.type = STRING;
+    partial.column =
+        keepsColumn(task.op, *sources[0]->output.column, task.params)
+            ? sources[0]->output.column
+            : std::make_shared<const StringColumn>(callTransform(
+                  task.op, *sources[0]->output.column, task.params));
+    partial.count = presentCount(*partial.column);
+    return true;
+  }
+
+  partial = upstreamState(sources, needsOf(task.op, task.params));
+  return partial.type != UNKNOWN;
+}
+
+/*
+ * @brief Записать предупреждение о пропуске операции и учесть пропуск
+ * @param message предупреждение
+ */
+void skip(const string &message) {
+  skipped_count++;
+  logger::warning(message);
+}
+
+/*
+ * @brief Процедура записи объединенного результата операции в узле графа.
+ * Результат сохраняется в узле, чтобы его могли прочитать следующие узлы
+ * @param node указатель на узел графа
+ */
+void writeMerged(Node *node) {
+  string id = node->id;
+  node->output = NodeOutput();
+  const plan::Task *compiled = plan::taskOf(node);
+  if (compiled and !compiled->error.empty()) {
+    skip(compiled->error + " in " + id + ". Skipping " + id);
+    return;
+  }
+
+  auto result = merged.find(id);
+  auto task = tasks_by_id.find(id);
+
+  if (result == merged.end() or task == tasks_by_id.end()) {
+    skip("No result computed for " + id + ". Skipping " + id);
+    return;
+  }
+  if (!task->second.error.empty()) {
+    skip(task->second.error + " in " + id + ". Skipping " + id);
+    return;
+  }
+
+  // результат операции общий с кэшем и другими операциями, поэтому
+  // результат над предыдущими узлами вычисляется в отдельное состояние
+  const PartialResult *shared = result->second.get();
+  PartialResult upstream;
+  OperationId op = task->second.op;
+  const Params &params = task->second.params;
+
+  // цель отбора и группировка проверены при компиляции плана
+  vector<Node *> sources = upstreamSources(node, task->second);
+  if (!sources.empty() or task->second.input == plan::INPUT_PARENTS) {
+    if (!evaluateUpstream(task->second, sources, upstream)) {
+      skip("No upstream result for " + id + ". Skipping " + id);
+      return;
+    }
+    shared = &upstream;
+  }
+  const PartialResult &partial = *shared;
+
+  auto source = reused.find(id);
+  if (source != reused.end())
+    logger::cacheHit(id, source->second);
+
+  if (!acceptsInput(op, partial.type)) {
+    const string &input = task->second.input;
+    string where =
+        !sources.empty() ? "upstream results"
+        : input.compare(0, plan::INPUT_EXPR.size(), plan::INPUT_EXPR) == 0
+            ? "expression " + input.substr(plan::INPUT_EXPR.size())
+            : "column " + std::to_string(task->second.column);
+    skip("Unknown type found in " + where + ". Skipping " + id);
+    return;
+  }
+
+  // результаты по группам не передаются следующим узлам
+  if (task->second.group_by >= 0) {
+    logger::writeGroups(id, partial.groups.keys,
+                        finalizeGroups(op, partial, params));
+    return;
+  }
+
+  // строки пишутся в лог прямо из буферов столбцов и не передаются
+  // следующим узлам
+  if (streamsText(op, params)) {
+    vector<StringView> parts;
+    for (const TextPiece &piece : partial.pieces) {
+      parts.push_back(pieceView(piece));
+    }
+    logger::writeStream(id, parts);
+    return;
+  }
+
+  // отсортированные значения пишутся в лог по мере слияния серий и не
+  // передаются следующим узлам
+  if (op == OP_SORT) {
+    logger::writeSorted(id, partial.sorted, descendingParam(params));
+    return;
+  }
+
+  if (operationResult(op) == NUMERIC) {
+    node->output.kind = NUMBER_OUTPUT;
+    node->output.number = finalizeNumeric(op, partial, params);
+    logger::writeResult(id, node->output.number);
+  } else {
+    node->output.kind = TEXT_OUTPUT;
+    node->output.text = finalizeString(op, partial, params);
+    logger::writeResult(id, node->output.text);
+  }
+
+  // преобразование передает столбец, если он есть (при наборе файлов
+  // производные столбцы файлов не объединяются)
+  if (partial.column) {
+    node->output.kind = COLUMN_OUTPUT;
+    node->output.column = partial.column;
+  }
+}
+
+/*
+ * @brief Получить количество операций, пропущенных при записи результатов
+ * @return количество пропусков с последней очистки
+ */
+size_t skipped() { return skipped_count; }
+
+/*
+ * @brief Очистить объединенные результаты
+ */
+void clear() {
+  tasks_by_id.clear();
+  merged.clear();
+  reused.clear();
+  cache.clear();
+  skipped_count = 0;
+}
+
+}; // namespace executor
@@ -0,0 +1,432 @@
+#include "../include/expr.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+const size_t BATCH_WORDS = EXPR_BATCH / 64; // слов маски в пакете
+const string COLUMN_PREFIX = "col";         // начало ссылки на столбец
+
+/*
+ * @brief Состояние разбора выражения
+ */
+struct ExprParser {
+  const string &text;   // текст выражения
+  size_t pos;           // текущая позиция в тексте
+  ExprProgram &program; // заполняемое выражение
+  string error;         // описание первой ошибки
+};
+
+bool parseSum(ExprParser &parser);
+
+/*
+ * @brief Пропустить пробелы
+ * @param parser состояние разбора
+ * @return true, если текст закончился
+ */
+bool skipSpaces(ExprParser &parser) {
+  while (parser.pos < parser.text.size() and
+         std::isspace(static_cast<unsigned char>(parser.text[parser.pos]))) {
+    parser.pos++;
+  }
+  return parser.pos == parser.text.size();
+}
+
+/*
+ * @brief Пропустить пробелы и проверить следующий символ
+ * @param parser состояние разбора
+ * @param symbol ожидаемый символ
+ * @return true, если следующий символ равен symbol (он пропускается)
+ */
+bool accept(ExprParser &parser, char symbol) {
+  skipSpaces(parser);
+  if (parser.pos < parser.text.size() and parser.text[parser.pos] == symbol) {
+    parser.pos++;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * @brief Запомнить первую ошибку разбора
+ * @param parser состояние разбора
+ * @param message описание ошибки
+ * @return false
+ */
+bool fail(ExprParser &parser, const string &message) {
+  if (parser.error.empty())
+    parser.error = message + " at position " + std::to_string(parser.pos);
+  return false;
+}
+
+/*
+ * @brief Добавить инструкцию. Константа перед арифметической операцией
+ * сворачивается в операцию с константой, а смена знака константы - в
+ * константу
+ * @param program выражение
+ * @param op инструкция
+ */
+void emit(ExprProgram &program, ExprOp op) {
+  vector<ExprInstruction> &code = program.code;
+  bool after_const = !code.empty() and code.back().op == PUSH_CONST;
+
+  if (after_const and op == NEG) {
+    code.back().value = -code.back().value;
+    return;
+  }
+  if (after_const and (op == ADD or op == SUB or op == MUL or op == DIV)) {
+    static const ExprOp WITH_CONST[] = {ADD_CONST, SUB_CONST, MUL_CONST,
+                                        DIV_CONST};
+    code.back().op = WITH_CONST[op - ADD];
+    return;
+  }
+
+  ExprInstruction instruction;
+  instruction.op = op;
+  code.push_back(instruction);
+}
+
+/*
+ * @brief Разобрать число, столбец или выражение в скобках
+ * @param parser состояние разбора
+ * @return true, если разбор успешен
+ */
+bool parsePrimary(ExprParser &parser) {
+  if (accept(parser, '('))
+    return parseSum(parser) and
+           (accept(parser, ')') or fail(parser, "Expected ')'"));
+
+  const string &text = parser.text;
+  if (text.compare(parser.pos, COLUMN_PREFIX.size(), COLUMN_PREFIX) == 0) {
+    parser.pos += COLUMN_PREFIX.size();
+    if (!accept(parser, '['))
+      return fail(parser, "Expected '['");
+
+    const char *begin = text.c_str() + parser.pos;
+    char *end = nullptr;
+    long column = std::strtol(begin, &end, 10);
+    if (end == begin or column < 0)
+      return fail(parser, "Expected column number");
+    parser.pos += end - begin;
+    if (!accept(parser, ']'))
+      return fail(parser, "Expected ']'");
+
+    // каждый столбец загружается в слот один раз
+    ExprProgram &program = parser.program;
+    auto slot = std::find(program.columns.begin(), program.columns.end(),
+                          static_cast<int>(column));
+    if (slot == program.columns.end())
+      slot = program.columns.insert(slot, static_cast<int>(column));
+
+    ExprInstruction instruction;
+    instruction.op = PUSH_COLUMN;
+    instruction.slot = slot - program.columns.begin();
+    program.code.push_back(instruction);
+    return true;
+  }
+
+  const char *begin = text.c_str() + parser.pos;
+  char *end = nullptr;
+  float value = std::strtof(begin, &end);
+  if (end == begin)
+    return fail(parser, "Expected number, column or '('");
+  parser.pos += end - begin;
+
+  ExprInstruction instruction;
+  instruction.op = PUSH_CONST;
+  instruction.value = value;
+  parser.program.code.push_back(instruction);
+  return true;
+}
+
+/*
+ * @brief Разобрать значение с унарным минусом
+ * @param parser состояние разбора
+ * @return true, если разбор успешен
+ */
+bool parseUnary(ExprParser &parser) {
+  if (accept(parser, '-')) {
+    if (!parseUnary(parser))
+      return false;
+    emit(parser.program, NEG);
+    return true;
+  }
+  return parsePrimary(parser);
+}
+
+/*
+ * @brief Разобрать произведение и частное
+ * @param parser состояние разбора
+ * @return true, если разбор успешен
+ */
+bool parseProduct(ExprParser &parser) {
+  if (!parseUnary(parser))
+    return false;
+
+  while (true) {
+    ExprOp op;
+    if (accept(parser, '*'))
+      op = MUL;
+    else if (accept(parser, '/'))
+      op = DIV;
+    else
+      return true;
+
+    if (!parseUnary(parser))
+      return false;
+    emit(parser.program, op);
+  }
+}
+
+/*
+ * @brief Разобрать сумму и разность
+ * @param parser состояние разбора
+ * @return true, если разбор успешен
+ */
+bool parseSum(ExprParser &parser) {
+  if (!parseProduct(parser))
+    return false;
+
+  while (true) {
+    ExprOp op;
+    if (accept(parser, '+'))
+      op = ADD;
+    else if (accept(parser, '-'))
+      op = SUB;
+    else
+      return true;
+
+    if (!parseProduct(parser))
+      return false;
+    emit(parser.program, op);
+  }
+}
+
+/**
+ * @brief Разобрать и скомпилировать выражение. Поддерживаются числа,
+ * столбцы col[N], операции + - * /, унарный минус и скобки
+ * @param text текст выражения
+ * @param program скомпилированное выражение (заполняется)
+ * @param error описание ошибки разбора (заполняется при ошибке)
+ * @return true, если выражение скомпилировано
+ */
+bool compileExpression(const string &text, ExprProgram &program,
+                       string &error) {
+  program = ExprProgram();
+  program.text = text;
+
+  ExprParser parser = {text, 0, program, ""};
+  if (!parseSum(parser) or
+      (!skipSpaces(parser) and !fail(parser, "Unexpected symbol"))) {
+    error = parser.error;
+    program = ExprProgram();
+    return false;
+  }
+
+  // глубина стека вычисляется по готовому байт-коду
+  size_t depth = 0;
+  for (const ExprInstruction &instruction : program.code) {
+    if (instruction.op == PUSH_COLUMN or instruction.op == PUSH_CONST)
+      program.depth = std::max(program.depth, ++depth);
+    else if (instruction.op >= ADD and instruction.op <= DIV)
+      depth--;
+  }
+  return true;
+}
+
+/*
+ * @brief Загрузить пакет строк столбца в ячейку стека
+ * @param column столбец (nullptr - значения отсутствуют)
+ * @param base первая строка пакета
+ * @param count количество строк пакета
+ * @param values значения ячейки
+ * @param mask слова маски ячейки
+ */
+void loadBatch(const NumericColumn *column, size_t base, size_t count,
+               float *values, uint64_t *mask) {
+  size_t words = (count + 63) / 64;
+
+  if (!column) {
+    std::fill(values, values + count, 0.0f);
+    std::fill(mask, mask + words, 0);
+    return;
+  }
+
+  if (column->layout == DENSE) {
+    std::memcpy(values, column->values.data() + base, count * sizeof(float));
+    const vector<uint64_t> &validity = column->validity.words;
+    if (validity.empty())
+      std::fill(mask, mask + words, ~uint64_t(0));
+    else
+      std::memcpy(mask, validity.data() + base / 64, words * sizeof(uint64_t));
+    return;
+  }
+
+  // разреженный столбец: значения пакета раскладываются по строкам
+  std::fill(values, values + count, 0.0f);
+  std::fill(mask, mask + words, 0);
+  const vector<uint32_t> &rows = column->rows;
+  size_t i = std::lower_bound(rows.begin(), rows.end(), base) - rows.begin();
+  for (; i < rows.size() and rows[i] < base + count; i++) {
+    size_t offset = rows[i] - base;
+    values[offset] = column->values[i];
+    mask[offset / 64] |= uint64_t(1) << (offset % 64);
+  }
+}
+
+/*
+ * @brief Применить двуместную операцию к двум верхним ячейкам стека
+ * @param op операция
+ * @param left значения нижней ячейки (результат)
+ * @param right значения верхней ячейки
+ * @param count количество строк пакета
+ */
+void applyBinary(ExprOp op, float *left, const float *right, size_t count) {
+  switch (op) {
+  case ADD:
+    for (size_t i = 0; i < count; i++) {
+      left[i] += right[i];
+    }
+    break;
+  case SUB:
+    for (size_t i = 0; i < count; i++) {
+      left[i] -= right[i];
+    }
+    break;
+  case MUL:
+    for (size_t i = 0; i < count; i++) {
+      left[i] *= right[i];
+    }
+    break;
+  case DIV:
+    for (size_t i = 0; i < count; i++) {
+      left[i] /= right[i];
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/*
+ * @brief Применить операцию с константой к верхней ячейке стека
+ * @param op операция
+ * @param values значения ячейки
+ * @param value константа
+ * @param count количество строк пакета
+ */
+void applyConst(ExprOp op, float *values, float value, size_t count) {
+  switch (op) {
+  case ADD_CONST:
+    for (size_t i = 0; i < count; i++) {
+      values[i] += value;
+    }
+    break;
+  case SUB_CONST:
+    for (size_t i = 0; i < count; i++) {
+      values[i] -= value;
+    }
+    break;
+  case MUL_CONST:
+    for (size_t i = 0; i < count; i++) {
+      values[i] *= value;
+    }
+    break;
+  case DIV_CONST:
+    for (size_t i = 0; i < count; i++) {
+      values[i] /= value;
+    }
+    break;
+  case NEG:
+    for (size_t i = 0; i < count; i++) {
+      values[i] = -values[i];
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief Вычислить выражение по пакетам строк. Значение строки отсутствует,
+ * если в строке нет значения хотя бы одного столбца выражения
+ * @param program скомпилированное выражение
+ * @param columns столбцы по слотам program.columns
+ * @param length количество строк таблицы
+ * @return производный столбец, выровненный по строкам таблицы
+ */
+NumericColumn evaluateExpression(const ExprProgram &program,
+                                 const vector<const NumericColumn *> &columns,
+                                 size_t length) {
+  vector<float> result(length, 0);
+  Bitmap validity = createBitmap(length);
+  if (program.code.empty())
+    return makeNumericColumn(std::move(result), std::move(validity));
+
+  // ячейки стека: значения и маска пакета
+  vector<float> stack(program.depth * EXPR_BATCH);
+  vector<uint64_t> masks(program.depth * BATCH_WORDS);
+
+  for (size_t base = 0; base < length; base += EXPR_BATCH) {
+    size_t count = std::min(EXPR_BATCH, length - base);
+    size_t words = (count + 63) / 64;
+    size_t top = 0;
+
+    for (const ExprInstruction &instruction : program.code) {
+      // следующая свободная ячейка стека; верхняя занятая ячейка - перед ней
+      float *values = stack.data() + top * EXPR_BATCH;
+      uint64_t *mask = masks.data() + top * BATCH_WORDS;
+
+      switch (instruction.op) {
+      case PUSH_COLUMN:
+        loadBatch(instruction.slot < columns.size() ? columns[instruction.slot]
+                                                    : nullptr,
+                  base, count, values, mask);
+        top++;
+        break;
+      case PUSH_CONST:
+        std::fill(values, values + count, instruction.value);
+        std::fill(mask, mask + words, ~uint64_t(0));
+        top++;
+        break;
+      case ADD:
+      case SUB:
+      case MUL:
+      case DIV: {
+        float *right = values - EXPR_BATCH;
+        uint64_t *right_mask = mask - BATCH_WORDS;
+        uint64_t *left_mask = right_mask - BATCH_WORDS;
+        applyBinary(instruction.op, right - EXPR_BATCH, right, count);
+        // значение есть, только если оно есть у обоих операндов
+        for (size_t w = 0; w < words; w++) {
+          left_mask[w] &= right_mask[w];
+        }
+        top--;
+        break;
+      }
+      default:
+        applyConst(instruction.op, values - EXPR_BATCH, instruction.value,
+                   count);
+        break;
+      }
+    }
+
+    std::memcpy(validity.words.data() + base / 64, masks.data(),
+                words * sizeof(uint64_t));
+    // значения пропусков в плотном столбце равны 0
+    for (size_t i = 0; i < count; i++) {
+      result[base + i] = (masks[i / 64] >> (i % 64)) & 1 ? stack[i] : 0;
+    }
+  }
+
+  // биты за последней строкой не относятся к таблице
+  if (length % 64)
+    validity.words.back() &= (uint64_t(1) << (length % 64)) - 1;
+  return makeNumericColumn(std::move(result), std::move(validity));
+}
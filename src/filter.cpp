@@ -0,0 +1,214 @@
+#include "../include/filter.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * @brief Разобрать операцию сравнения
+ * @param text запись операции (==, !=, <, <=, >, >=)
+ * @param op операция (заполняется)
+ * @return true, если запись распознана
+ */
+bool parseCompare(const string &text, CompareOp &op) {
+  if (text == "==")
+    op = EQUAL;
+  else if (text == "!=")
+    op = NOT_EQUAL;
+  else if (text == "<")
+    op = LESS;
+  else if (text == "<=")
+    op = LESS_EQUAL;
+  else if (text == ">")
+    op = GREATER;
+  else if (text == ">=")
+    op = GREATER_EQUAL;
+  else
+    return false;
+  return true;
+}
+
+/*
+ * @brief Сравнить значения буфера и собрать результаты в слова маски
+ * @param values указатель на значения
+ * @param length количество значений
+ * @param compare условие
+ * @param words слова маски (заполняются)
+ */
+template <typename T, typename Compare>
+void matchWords(const T *values, size_t length, Compare compare,
+                vector<uint64_t> &words) {
+  words.assign((length + 63) / 64, 0);
+
+  for (size_t base = 0; base < length; base += 64) {
+    size_t end = std::min(length, base + 64);
+    uint64_t word = 0;
+    // без ветвлений: результат сравнения сдвигается в бит значения
+    for (size_t i = base; i < end; i++) {
+      word |= uint64_t(compare(values[i])) << (i - base);
+    }
+    words[base / 64] = word;
+  }
+}
+
+/*
+ * @brief Отметить значения буфера, удовлетворяющие условию. Операция
+ * выбирается один раз, а не для каждого значения
+ * @param values указатель на значения
+ * @param length количество значений
+ * @param op операция сравнения
+ * @param value значение справа от операции
+ * @return маска длины length
+ */
+template <typename T>
+Bitmap matchValues(const T *values, size_t length, CompareOp op,
+                   const T &value) {
+  Bitmap mask;
+  mask.length = length;
+
+  switch (op) {
+  case EQUAL:
+    matchWords(values, length, [&](const T &x) { return x == value; },
+               mask.words);
+    break;
+  case NOT_EQUAL:
+    matchWords(values, length, [&](const T &x) { return x != value; },
+               mask.words);
+    break;
+  case LESS:
+    matchWords(values, length, [&](const T &x) { return x < value; },
+               mask.words);
+    break;
+  case LESS_EQUAL:
+    matchWords(values, length, [&](const T &x) { return x <= value; },
+               mask.words);
+    break;
+  case GREATER:
+    matchWords(values, length, [&](const T &x) { return x > value; },
+               mask.words);
+    break;
+  case GREATER_EQUAL:
+    matchWords(values, length, [&](const T &x) { return x >= value; },
+               mask.words);
+    break;
+  }
+  return mask;
+}
+
+/*
+ * @brief Перевести маску значений столбца в маску строк таблицы, исключив
+ * строки без значения
+ * @param column столбец
+ * @param matched маска значений column.values, удовлетворяющих условию
+ * @return маска выбранных строк таблицы
+ */
+template <typename Column>
+Bitmap selectedRows(const Column &column, Bitmap matched) {
+  if (column.layout == DENSE) {
+    const vector<uint64_t> &validity = column.validity.words;
+    for (size_t w = 0; w < validity.size() and w < matched.words.size(); w++) {
+      matched.words[w] &= validity[w];
+    }
+    matched.length = column.length;
+    return matched;
+  }
+
+  Bitmap selection = createBitmap(column.length);
+  for (size_t w = 0; w < matched.words.size(); w++) {
+    uint64_t word = matched.words[w];
+    // перебираем только установленные биты слова
+    while (word) {
+      setBit(selection, column.rows[w * 64 + __builtin_ctzll(word)]);
+      word &= word - 1;
+    }
+  }
+  return selection;
+}
+
+/**
+ * @brief Отобрать строки числового столбца, значение которых удовлетворяет
+ * условию. Строки без значения не выбираются
+ * @param column столбец
+ * @param op операция сравнения
+ * @param value значение справа от операции
+ * @return маска выбранных строк таблицы (length строк столбца)
+ */
+Bitmap compareColumn(const NumericColumn &column, CompareOp op, float value) {
+  return selectedRows(column, matchValues(column.values.data(),
+                                          column.values.size(), op, value));
+}
+
+/**
+ * @brief Отобрать строки строкового столбца, значение которых удовлетворяет
+ * условию (строки сравниваются лексикографически). Строки без значения не
+ * выбираются
+ * @param column столбец
+ * @param op операция сравнения
+ * @param value значение справа от операции
+ * @return маска выбранных строк таблицы (length строк столбца)
+ */
+Bitmap compareColumn(const StringColumn &column, CompareOp op,
+                     const string &value) {
+  return selectedRows(column, matchValues(column.values.data(),
+                                          column.values.size(), op, value));
+}
+
+/*
+ * @brief Получить маску присутствующих и выбранных значений столбца
+ * @param column столбец
+ * @param selection маска выбранных строк таблицы
+ * @return маска длины column.values.size()
+ */
+template <typename Column>
+Bitmap maskOf(const Column &column, const Bitmap &selection) {
+  size_t length = column.values.size();
+
+  if (column.layout == DENSE) {
+    // значения выровнены по строкам: маски объединяются пословно
+    Bitmap mask = selection;
+    mask.length = length;
+    mask.words.resize((length + 63) / 64, 0);
+    const vector<uint64_t> &validity = column.validity.words;
+    for (size_t w = 0; w < validity.size() and w < mask.words.size(); w++) {
+      mask.words[w] &= validity[w];
+    }
+    return mask;
+  }
+
+  Bitmap mask = createBitmap(length);
+  for (size_t i = 0; i < length; i++) {
+    size_t row = column.rows[i];
+    uint64_t selected =
+        row < selection.length ? (selection.words[row / 64] >> (row % 64)) & 1
+                               : 0;
+    mask.words[i / 64] |= selected << (i % 64);
+  }
+  return mask;
+}
+
+/**
+ * @brief Получить маску значений столбца, которые присутствуют и выбраны:
+ * маска выровнена по column.values и передается ядрам вместо маски
+ * валидности
+ * @param column числовой столбец
+ * @param selection маска выбранных строк таблицы
+ * @return маска длины column.values.size()
+ */
+Bitmap selectedMask(const NumericColumn &column, const Bitmap &selection) {
+  return maskOf(column, selection);
+}
+
+/**
+ * @brief Получить маску значений столбца, которые присутствуют и выбраны:
+ * маска выровнена по column.values и передается ядрам вместо маски
+ * валидности
+ * @param column строковый столбец
+ * @param selection маска выбранных строк таблицы
+ * @return маска длины column.values.size()
+ */
+Bitmap selectedMask(const StringColumn &column, const Bitmap &selection) {
+  return maskOf(column, selection);
+}
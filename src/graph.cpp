@@ -1,4 +1,5 @@
 #include "../include/graph.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,7 @@ Node *createNode(string id) {
   new_node->next_head = nullptr;
   new_node->adjency_list_head = nullptr;
   new_node->adjency_list_tail = nullptr;
+  new_node->task = -1;
   return new_node;
 }
 
@@ -82,7 +84,7 @@ bool alreadyInGraph(Node *node) {
  * @return true, если узел найден, false - иначе
  */
 bool alreadyInGraph(string id) {
-  bool found;
+  bool found = false;
   Node *next = first_head_ptr;
 
   while (next and (not found)) {
@@ -129,6 +131,44 @@ vector<Node *> adjentNodes(Node *node) {
   return nodes;
 }
 
+/**
+ * @brief Получает вектор всех узлов, из которых есть связь в указанный узел
+ * @param node Указатель на узел
+ * @return Вектор указателей на предыдущие узлы в порядке списка заголовков
+ */
+vector<Node *> parentNodes(Node *node) {
+  vector<Node *> parents;
+
+  for (Node *head = first_head_ptr; head; head = head->next_head) {
+    for (Adjent *adjent = head->adjency_list_head; adjent;
+         adjent = adjent->next_adjent) {
+      if (adjent->my_head == node) {
+        parents.push_back(head);
+        break;
+      }
+    }
+  }
+  return parents;
+}
+
+/**
+ * @brief Связать два узла графа без поиска в списке заголовков (для
+ * массового построения графа): оба узла уже должны быть добавлены в граф
+ * @param node указатель на узел
+ * @param to_node узел, в который нужно попасть из node
+ */
+void link(Node *node, Node *to_node) {
+  Adjent *adjent = createAdjent(to_node);
+
+  if (!node->adjency_list_head) {
+    node->adjency_list_head = adjent;
+    node->adjency_list_tail = adjent;
+  } else {
+    node->adjency_list_tail->next_adjent = adjent;
+    node->adjency_list_tail = adjent;
+  }
+}
+
 /*
  * @brief Связать узел с другими
  * @param node указатель на узел
@@ -136,8 +176,6 @@ vector<Node *> adjentNodes(Node *node) {
  * нужно попасть из node
  */
 void connect(Node *node, vector<Node *> to_another_nodes) {
-  Adjent *adjent = nullptr;
-
   // Проверяем, что node добавлен в граф
   if (!alreadyInGraph(node)) {
     return;
@@ -145,17 +183,8 @@ void connect(Node *node, vector<Node *> to_another_nodes) {
 
   for (Node *to_node : to_another_nodes) {
 
-    if (alreadyInGraph(to_node)) {
-      adjent = createAdjent(to_node);
-
-      if (!node->adjency_list_head) {
-        node->adjency_list_head = adjent;
-        node->adjency_list_tail = adjent;
-      } else {
-        node->adjency_list_tail->next_adjent = adjent;
-        node->adjency_list_tail = adjent;
-      }
-    }
+    if (alreadyInGraph(to_node))
+      link(node, to_node);
   }
 }
 
@@ -166,7 +195,6 @@ void connect(Node *node, vector<Node *> to_another_nodes) {
  * нужно попасть из узла с идентификатором id
  */
 void connect(string id, vector<string> to_another_ids) {
-  Adjent *adjent = nullptr;
   Node *to_node;
   Node *node = getNodeById(id);
 
@@ -177,18 +205,9 @@ void connect(string id, vector<string> to_another_ids) {
 
   for (string to_id : to_another_ids) {
 
-    if (alreadyInGraph(to_id)) {
-      to_node = getNodeById(to_id);
-      adjent = createAdjent(to_node);
-
-      if (!node->adjency_list_head) {
-        node->adjency_list_head = adjent;
-        node->adjency_list_tail = adjent;
-      } else {
-        node->adjency_list_tail->next_adjent = adjent;
-        node->adjency_list_tail = adjent;
-      }
-    }
+    to_node = getNodeById(to_id);
+    if (to_node)
+      link(node, to_node);
   }
 }
 
@@ -441,3 +460,48 @@ void deepFirstSearch(void (*procedure)(Node *node)) {
 
   delete[] visited_nodes;
 }
+
+/*
+ * @brief Вспомогательная функция топологического обхода: посетить узел и
+ * перейти к следующим узлам, все родители которых уже посещены
+ * @param procedure указатель на функцию операции над узлом
+ * @param node указатель на посещаемый узел
+ * @param waiting количество еще не посещенных входящих связей узлов
+ */
+void topologicalSearchRecursive(void (*procedure)(Node *node), Node *node,
+                                std::map<Node *, int> &waiting) {
+  procedure(node);
+
+  for (Adjent *next = node->adjency_list_head; next;
+       next = next->next_adjent) {
+    if (--waiting[next->my_head] == 0)
+      topologicalSearchRecursive(procedure, next->my_head, waiting);
+  }
+}
+
+/**
+ * @brief Пройти по всем узлам графа так, чтобы каждый узел посещался после
+ * всех предыдущих узлов: обход в глубину от каждого узла без входящих
+ * связей, который откладывает узел до посещения последнего из его родителей
+ * @param procedure указатель на функцию операции над узлом
+ */
+void topologicalSearch(void (*procedure)(Node *node)) {
+  std::map<Node *, int> waiting;
+
+  for (Node *head = first_head_ptr; head; head = head->next_head) {
+    for (Adjent *adjent = head->adjency_list_head; adjent;
+         adjent = adjent->next_adjent) {
+      waiting[adjent->my_head]++;
+    }
+  }
+
+  // корни выбираются до обхода: у посещенных узлов счетчик тоже обнуляется
+  vector<Node *> roots;
+  for (Node *head = first_head_ptr; head; head = head->next_head) {
+    if (waiting[head] == 0)
+      roots.push_back(head);
+  }
+  for (Node *root : roots) {
+    topologicalSearchRecursive(procedure, root, waiting);
+  }
+}
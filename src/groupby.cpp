@@ -0,0 +1,198 @@
+#include "../include/groupby.h"
+#include "../include/filter.h"
+#include "../include/kernels.h"
+#include "../include/sketch.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+const size_t SERIAL_GROUP = 1 << 16; // размер для однопоточной группировки
+const size_t MIN_SLOTS = 16;         // начальное количество слотов
+
+/**
+ * @brief Создать пустую таблицу групп
+ * @param moments вычислять ли моменты (для дисперсии и асимметрии)
+ * @return таблица
+ */
+GroupTable createGroupTable(bool moments) {
+  GroupTable table;
+  table.moments = moments;
+  return table;
+}
+
+/*
+ * @brief Удвоить количество слотов и заново разместить группы
+ * @param table таблица групп
+ */
+void growSlots(GroupTable &table) {
+  size_t capacity = std::max(MIN_SLOTS, 2 * table.slots.size());
+  vector<GroupSlot> slots(capacity);
+
+  for (const GroupSlot &slot : table.slots) {
+    if (!slot.group)
+      continue;
+    size_t probe = slot.hash & (capacity - 1);
+    while (slots[probe].group) {
+      probe = (probe + 1) & (capacity - 1);
+    }
+    slots[probe] = slot;
+  }
+  table.slots.swap(slots);
+}
+
+/**
+ * @brief Найти группу по ключу, создав ее при отсутствии
+ * @param table таблица групп
+ * @param key ключ
+ * @param hash хэш ключа (hashBytes)
+ * @return номер группы
+ */
+size_t groupOf(GroupTable &table, const string &key, uint64_t hash) {
+  // коэффициент заполнения не выше 1/2
+  if (2 * (table.keys.size() + 1) > table.slots.size())
+    growSlots(table);
+
+  size_t mask = table.slots.size() - 1;
+  size_t probe = hash & mask;
+  while (table.slots[probe].group) {
+    const GroupSlot &slot = table.slots[probe];
+    if (slot.hash == hash and table.keys[slot.group - 1] == key)
+      return slot.group - 1;
+    probe = (probe + 1) & mask;
+  }
+
+  table.keys.push_back(key);
+  table.states.push_back(Moments());
+  table.slots[probe] = {hash, uint32_t(table.keys.size())};
+  return table.keys.size() - 1;
+}
+
+/**
+ * @brief Добавить таблицу следующей части данных: группы из from, которых
+ * нет в into, добавляются в конец в порядке from
+ * @param into накапливаемая таблица
+ * @param from таблица следующей части
+ */
+void groupMerge(GroupTable &into, const GroupTable &from) {
+  if (from.keys.empty())
+    return;
+  if (into.keys.empty()) {
+    into = from;
+    return;
+  }
+
+  into.moments = into.moments or from.moments;
+  for (size_t g = 0; g < from.keys.size(); g++) {
+    const string &key = from.keys[g];
+    size_t group = groupOf(into, key, hashBytes(key.data(), key.size()));
+    // без моментов средние равны нулю, и формулы Чана сводятся к сумме,
+    // количеству и экстремумам
+    mergeMoments(into.states[group], from.states[g]);
+  }
+}
+
+/*
+ * @brief Сгруппировать часть значений столбца
+ * @param table таблица групп потока
+ * @param values столбец значений
+ * @param keys столбец ключей
+ * @param validity слова маски значений values.values или nullptr
+ * @param begin первое значение части (индекс в values.values)
+ * @param end значение за последним
+ */
+void groupRange(GroupTable &table, const NumericColumn &values,
+                const StringColumn &keys, const uint64_t *validity,
+                size_t begin, size_t end) {
+  if (begin >= end)
+    return;
+
+  bool sparse_values = values.layout == SPARSE;
+  bool sparse_keys = keys.layout == SPARSE;
+
+  // номера строк возрастают, поэтому ключи разреженного столбца находятся
+  // одним проходом
+  size_t cursor = 0;
+  if (sparse_keys) {
+    size_t first = sparse_values ? values.rows[begin] : begin;
+    cursor = std::lower_bound(keys.rows.begin(), keys.rows.end(), first) -
+             keys.rows.begin();
+  }
+
+  for (size_t i = begin; i < end; i++) {
+    if (!isPresent(validity, i))
+      continue;
+    size_t row = sparse_values ? values.rows[i] : i;
+
+    const string *key = nullptr;
+    if (sparse_keys) {
+      while (cursor < keys.rows.size() and keys.rows[cursor] < row) {
+        cursor++;
+      }
+      if (cursor < keys.rows.size() and keys.rows[cursor] == row)
+        key = &keys.values[cursor];
+    } else if (row < keys.values.size() and testBit(keys.validity, row)) {
+      key = &keys.values[row];
+    }
+    if (!key)
+      continue;
+
+    Moments &state =
+        table.states[groupOf(table, *key, hashBytes(key->data(), key->size()))];
+    float value = values.values[i];
+
+    if (table.moments) {
+      addMoment(state, value);
+    } else {
+      state.count++;
+      state.sum += value;
+      state.min = std::min(state.min, value);
+      state.max = std::max(state.max, value);
+    }
+  }
+}
+
+/**
+ * @brief Сгруппировать значения числового столбца по ключам другого столбца.
+ * Строки делятся между потоками, каждый поток заполняет свою таблицу, затем
+ * таблицы объединяются в порядке строк. Строки без значения или без ключа
+ * пропускаются
+ * @param values столбец значений
+ * @param keys столбец ключей (выровнен по тем же строкам)
+ * @param moments вычислять ли моменты
+ * @param workers количество потоков (0 - по числу ядер)
+ * @param selection маска выбранных строк таблицы или nullptr (все строки)
+ * @return таблица групп
+ */
+GroupTable groupAggregate(const NumericColumn &values, const StringColumn &keys,
+                          bool moments, unsigned workers,
+                          const Bitmap *selection) {
+  size_t n = values.values.size();
+  workers = resolveWorkers(workers);
+  if (n < SERIAL_GROUP)
+    workers = 1;
+
+  // невыбранные значения пропускаются так же, как отсутствующие
+  Bitmap mask;
+  const uint64_t *validity = validityWords(values);
+  if (selection) {
+    mask = selectedMask(values, *selection);
+    validity = mask.words.data();
+  }
+
+  vector<GroupTable> parts(workers, createGroupTable(moments));
+  parallelChunks(workers, n, [&](unsigned w, size_t begin, size_t end) {
+    groupRange(parts[w], values, keys, validity, begin, end);
+  });
+
+  GroupTable table = std::move(parts[0]);
+  for (unsigned w = 1; w < workers; w++) {
+    groupMerge(table, parts[w]);
+  }
+  table.moments = moments;
+  return table;
+}
@@ -0,0 +1,163 @@
+#include "../include/histogram.h"
+#include "../include/kernels.h"
+#include <algorithm>
+#include <thread>
+
+// минимальная часть столбца одного потока при подсчете гистограммы
+const size_t PARALLEL_HISTOGRAM = 1 << 16;
+
+// счетчиков в строке кэша: массивы потоков разделены ею
+const size_t CACHE_LINE_COUNTS = 64 / sizeof(uint64_t);
+
+/*
+ * @brief Выполнить функцию над частями столбца в нескольких потоках: части
+ * начинаются на границе слова маски валидности
+ * @param workers количество потоков
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param body функция (номер потока, значения, маска, количество)
+ */
+template <typename Body>
+void parallelWords(unsigned workers, const float *values,
+                   const uint64_t *validity, size_t length, Body body) {
+  parallelChunks(workers, (length + 63) / 64,
+                 [&](unsigned w, size_t begin, size_t end) {
+                   size_t first = std::min(length, begin * 64);
+                   size_t last = std::min(length, end * 64);
+                   const uint64_t *words = validity ? validity + begin : nullptr;
+                   body(w, values + first, words, last - first);
+                 });
+}
+
+/*
+ * @brief Номер корзины значения
+ * @param value значение из диапазона [min, max]
+ * @param min нижняя граница
+ * @param max верхняя граница
+ * @param bins количество корзин
+ * @return номер корзины
+ */
+size_t binOf(float value, float min, float max, size_t bins) {
+  if (!(max > min))
+    return 0;
+  double position = (double(value) - min) / (double(max) - min) * bins;
+  return std::min(size_t(std::max(0.0, position)), bins - 1);
+}
+
+/**
+ * @brief Добавить присутствующие значения. Без заданного диапазона границы
+ * берутся из предварительного прохода по минимуму и максимуму. Каждый
+ * поток считает свою часть столбца в собственный массив счетчиков,
+ * отделенный от соседних строкой кэша, и массивы складываются в конце
+ * @param state гистограмма
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void histogramInsert(HistogramState &state, const float *values,
+                     const uint64_t *validity, size_t length,
+                     unsigned workers) {
+  size_t bins = std::max<size_t>(1, state.spec.bins);
+  workers = resolveWorkers(workers);
+  workers = unsigned(std::max<size_t>(
+      1, std::min<size_t>(workers, length / PARALLEL_HISTOGRAM)));
+
+  HistogramState part;
+  part.spec = state.spec;
+  part.min = state.spec.min;
+  part.max = state.spec.max;
+  if (!state.spec.fixed) {
+    vector<float> lows(workers, INFINITY);
+    vector<float> highs(workers, -INFINITY);
+    parallelWords(workers, values, validity, length,
+                  [&](unsigned w, const float *v, const uint64_t *m,
+                      size_t n) { maskedRange(v, m, n, lows[w], highs[w]); });
+    part.min = *std::min_element(lows.begin(), lows.end());
+    part.max = *std::max_element(highs.begin(), highs.end());
+  }
+
+  size_t present = maskedCount(validity, length);
+  if (part.min <= part.max) {
+    // массив потока занимает целое число строк кэша и еще одну строку
+    size_t stride =
+        (bins + CACHE_LINE_COUNTS - 1) / CACHE_LINE_COUNTS * CACHE_LINE_COUNTS +
+        CACHE_LINE_COUNTS;
+    vector<uint64_t> local(workers * stride, 0);
+    parallelWords(workers, values, validity, length,
+                  [&](unsigned w, const float *v, const uint64_t *m,
+                      size_t n) {
+                    maskedHistogram(v, m, n, part.min, part.max, bins,
+                                    local.data() + w * stride);
+                  });
+
+    part.counts.assign(bins, 0);
+    size_t inside = 0;
+    for (unsigned w = 0; w < workers; w++) {
+      for (size_t b = 0; b < bins; b++) {
+        part.counts[b] += local[w * stride + b];
+        inside += local[w * stride + b];
+      }
+    }
+    part.outside = present - inside;
+  } else {
+    part.outside = present;
+  }
+  histogramMerge(state, part);
+}
+
+/*
+ * @brief Перенести счетчики гистограммы в другие границы по серединам
+ * корзин
+ * @param from исходная гистограмма
+ * @param min нижняя граница результата
+ * @param max верхняя граница результата
+ * @param counts счетчики результата (увеличиваются)
+ */
+void rebin(const HistogramState &from, float min, float max,
+           vector<uint64_t> &counts) {
+  size_t bins = from.counts.size();
+  double width = (double(from.max) - from.min) / bins;
+  for (size_t b = 0; b < bins; b++) {
+    float middle = from.max > from.min ? float(from.min + (b + 0.5) * width)
+                                       : from.min;
+    counts[binOf(middle, min, max, counts.size())] += from.counts[b];
+  }
+}
+
+/**
+ * @brief Добавить гистограмму следующей части данных. Если границы частей
+ * различаются (диапазон из данных), корзины переносятся в объединенный
+ * диапазон по своим серединам, поэтому результат приближенный
+ * @param into накапливаемая гистограмма
+ * @param from гистограмма следующей части
+ */
+void histogramMerge(HistogramState &into, const HistogramState &from) {
+  into.outside += from.outside;
+  if (from.counts.empty())
+    return;
+  if (into.counts.empty()) {
+    into.spec = from.spec;
+    into.min = from.min;
+    into.max = from.max;
+    into.counts = from.counts;
+    return;
+  }
+
+  if (into.min == from.min and into.max == from.max) {
+    for (size_t b = 0; b < into.counts.size(); b++) {
+      into.counts[b] += from.counts[b];
+    }
+    return;
+  }
+
+  float min = std::min(into.min, from.min);
+  float max = std::max(into.max, from.max);
+  vector<uint64_t> counts(into.counts.size(), 0);
+  rebin(into, min, max, counts);
+  rebin(from, min, max, counts);
+  into.min = min;
+  into.max = max;
+  into.counts = std::move(counts);
+}
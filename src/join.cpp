@@ -0,0 +1,221 @@
+#include "../include/join.h"
+#include "../include/kernels.h"
+#include "../include/sketch.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+
+const size_t BLOOM_BITS_PER_KEY = 10; // бит фильтра Блума на ключ
+const int BLOOM_PROBES = 3;           // позиций бита на ключ
+
+// минимальная часть строк одного потока при проверке большей таблицы
+const size_t PARALLEL_PROBE = 1 << 14;
+
+/**
+ * @brief Создать пустой фильтр Блума
+ * @param keys ожидаемое количество ключей
+ * @return фильтр
+ */
+BloomFilter createBloom(size_t keys) {
+  size_t bits = 64;
+  while (bits < keys * BLOOM_BITS_PER_KEY) {
+    bits <<= 1;
+  }
+  BloomFilter filter;
+  filter.words.assign(bits / 64, 0);
+  return filter;
+}
+
+/*
+ * @brief Номер бита фильтра для одной из позиций ключа
+ * @param filter фильтр
+ * @param hash хэш ключа
+ * @param probe номер позиции
+ * @return номер бита
+ */
+inline size_t bloomBit(const BloomFilter &filter, uint64_t hash, int probe) {
+  uint64_t step = (hash >> 32) | 1;
+  return (hash + probe * step) & (filter.words.size() * 64 - 1);
+}
+
+/**
+ * @brief Добавить ключ в фильтр
+ * @param filter фильтр
+ * @param hash хэш ключа (hashBytes)
+ */
+void bloomInsert(BloomFilter &filter, uint64_t hash) {
+  for (int probe = 0; probe < BLOOM_PROBES; probe++) {
+    size_t bit = bloomBit(filter, hash, probe);
+    filter.words[bit / 64] |= uint64_t(1) << (bit % 64);
+  }
+}
+
+/**
+ * @brief Проверить, может ли ключ быть в фильтре
+ * @param filter фильтр
+ * @param hash хэш ключа (hashBytes)
+ * @return false, если ключа точно нет
+ */
+bool bloomContains(const BloomFilter &filter, uint64_t hash) {
+  for (int probe = 0; probe < BLOOM_PROBES; probe++) {
+    size_t bit = bloomBit(filter, hash, probe);
+    if (!(filter.words[bit / 64] >> (bit % 64) & 1))
+      return false;
+  }
+  return true;
+}
+
+/*
+ * @brief Слот хэш-таблицы соединения: хэш ключа и первая строка меньшей
+ * таблицы с этим ключом
+ */
+struct JoinSlot {
+  uint64_t hash = 0; // хэш ключа
+  uint32_t row = 0;  // номер первой строки + 1 (0 - пустой слот)
+};
+
+/*
+ * @brief Хэш-таблица меньшей таблицы: строки с одинаковым ключом связаны в
+ * цепочку в порядке таблицы
+ */
+struct JoinIndex {
+  vector<JoinSlot> slots; // слоты (размер - степень двойки)
+  vector<uint32_t> next;  // номер следующей строки с тем же ключом + 1
+  BloomFilter bloom;      // фильтр Блума ключей
+};
+
+/*
+ * @brief Получить ключ строки
+ * @param row строка таблицы
+ * @param column столбец ключа
+ * @return указатель на поле или nullptr, если ключа нет
+ */
+const string *keyOf(const vector<string> &row, int column) {
+  if (column < 0 or size_t(column) >= row.size() or row[column].empty())
+    return nullptr;
+  return &row[column];
+}
+
+/*
+ * @brief Построить хэш-таблицу по столбцу ключей таблицы
+ * @param rows строки таблицы
+ * @param column столбец ключа
+ * @return хэш-таблица с фильтром Блума
+ */
+JoinIndex buildIndex(const vector<vector<string>> &rows, int column) {
+  JoinIndex index;
+  size_t capacity = 16;
+  while (capacity < rows.size() * 2) {
+    capacity <<= 1;
+  }
+  index.slots.resize(capacity);
+  index.next.assign(rows.size(), 0);
+  index.bloom = createBloom(rows.size());
+
+  // строки добавляются с конца в начало цепочки, поэтому цепочка идет в
+  // порядке таблицы
+  for (size_t i = rows.size(); i-- > 0;) {
+    const string *key = keyOf(rows[i], column);
+    if (!key)
+      continue;
+
+    uint64_t hash = hashBytes(key->data(), key->size());
+    bloomInsert(index.bloom, hash);
+    size_t probe = hash & (capacity - 1);
+    while (index.slots[probe].row and
+           (index.slots[probe].hash != hash or
+            rows[index.slots[probe].row - 1][column] != *key)) {
+      probe = (probe + 1) & (capacity - 1);
+    }
+    index.next[i] = index.slots[probe].row;
+    index.slots[probe] = {hash, uint32_t(i + 1)};
+  }
+  return index;
+}
+
+/*
+ * @brief Собрать строку соединения
+ * @param left строка левой таблицы
+ * @param width ширина левой таблицы
+ * @param right строка правой таблицы
+ * @return поля левой строки, дополненные до ширины, и поля правой
+ */
+vector<string> joinRow(const vector<string> &left, size_t width,
+                       const vector<string> &right) {
+  vector<string> row;
+  row.reserve(width + right.size());
+  row.insert(row.end(), left.begin(), left.end());
+  row.resize(width);
+  row.insert(row.end(), right.begin(), right.end());
+  return row;
+}
+
+/**
+ * @brief Хэш-соединение (inner join) двух таблиц по равенству полей-ключей.
+ * Хэш-таблица строится по меньшей таблице, а строки большей делятся между
+ * потоками и проверяются сначала фильтром Блума, затем хэш-таблицей. Строки
+ * результата идут в порядке строк большей таблицы (совпадения - в порядке
+ * меньшей) и состоят из полей левой строки, дополненных пропусками до
+ * ширины левой таблицы, и полей правой строки. Ключи сравниваются как
+ * текст, строки без ключа не соединяются
+ * @param left левая таблица
+ * @param left_key столбец ключа левой таблицы
+ * @param right правая таблица
+ * @param right_key столбец ключа правой таблицы
+ * @param workers количество потоков (0 - по числу ядер)
+ * @return строки соединения
+ */
+vector<vector<string>> hashJoin(const table::Table &left, int left_key,
+                                const table::Table &right, int right_key,
+                                unsigned workers) {
+  size_t width = 0;
+  for (const vector<string> &row : left.rows) {
+    width = std::max(width, row.size());
+  }
+
+  bool build_left = left.rows.size() < right.rows.size();
+  const vector<vector<string>> &build = build_left ? left.rows : right.rows;
+  const vector<vector<string>> &probe = build_left ? right.rows : left.rows;
+  int build_key = build_left ? left_key : right_key;
+  int probe_key = build_left ? right_key : left_key;
+  JoinIndex index = buildIndex(build, build_key);
+  size_t mask = index.slots.size() - 1;
+
+  workers = resolveWorkers(workers);
+  workers = unsigned(std::max<size_t>(
+      1, std::min<size_t>(workers, probe.size() / PARALLEL_PROBE)));
+
+  // каждый поток соединяет свою часть строк большей таблицы
+  vector<vector<vector<string>>> parts(workers);
+  parallelChunks(workers, probe.size(),
+                 [&](unsigned w, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const string *key = keyOf(probe[i], probe_key);
+      if (!key)
+        continue;
+      uint64_t hash = hashBytes(key->data(), key->size());
+      if (!bloomContains(index.bloom, hash))
+        continue;
+
+      size_t slot = hash & mask;
+      while (index.slots[slot].row and
+             (index.slots[slot].hash != hash or
+              build[index.slots[slot].row - 1][build_key] != *key)) {
+        slot = (slot + 1) & mask;
+      }
+      for (uint32_t row = index.slots[slot].row; row;
+           row = index.next[row - 1]) {
+        const vector<string> &match = build[row - 1];
+        parts[w].push_back(build_left ? joinRow(match, width, probe[i])
+                                      : joinRow(probe[i], width, match));
+      }
+    }
+  });
+
+  vector<vector<string>> result;
+  for (vector<vector<string>> &part : parts) {
+    result.insert(result.end(), std::make_move_iterator(part.begin()),
+                  std::make_move_iterator(part.end()));
+  }
+  return result;
+}
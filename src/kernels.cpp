@@ -0,0 +1,685 @@
+#include "../include/kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define KERNELS_AVX2
+#endif
+
+#if defined(__SSE2__)
+/*
+ * Маски дорожек SSE-регистра для каждого из 16 значений полубайта маски
+ * валидности: дорожка k заполнена единицами, если установлен бит k
+ */
+alignas(16) static const uint32_t LANE_MASKS[16][4] = {
+    {0, 0, 0, 0},          {~0u, 0, 0, 0},          {0, ~0u, 0, 0},
+    {~0u, ~0u, 0, 0},      {0, 0, ~0u, 0},          {~0u, 0, ~0u, 0},
+    {0, ~0u, ~0u, 0},      {~0u, ~0u, ~0u, 0},      {0, 0, 0, ~0u},
+    {~0u, 0, 0, ~0u},      {0, ~0u, 0, ~0u},        {~0u, ~0u, 0, ~0u},
+    {0, 0, ~0u, ~0u},      {~0u, 0, ~0u, ~0u},      {0, ~0u, ~0u, ~0u},
+    {~0u, ~0u, ~0u, ~0u},
+};
+
+/*
+ * @brief Получить маску дорожек для четырех значений
+ * @param nibble четыре бита маски валидности
+ * @return маска регистра
+ */
+static inline __m128 laneMask(uint64_t nibble) {
+  return _mm_castsi128_ps(
+      _mm_load_si128(reinterpret_cast<const __m128i *>(LANE_MASKS[nibble])));
+}
+
+/*
+ * @brief Сумма блоков по 64 значения на SSE2: четыре независимых
+ * аккумулятора двойной точности
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @return сумма
+ */
+static double blockSumSse2(const float *values, const uint64_t *validity,
+                           size_t blocks) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  __m128d acc2 = _mm_setzero_pd();
+  __m128d acc3 = _mm_setzero_pd();
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 16; k += 2) {
+      __m128 v0 = _mm_and_ps(_mm_loadu_ps(block + 4 * k),
+                             laneMask((word >> (4 * k)) & 0xF));
+      __m128 v1 = _mm_and_ps(_mm_loadu_ps(block + 4 * k + 4),
+                             laneMask((word >> (4 * k + 4)) & 0xF));
+
+      acc0 = _mm_add_pd(acc0, _mm_cvtps_pd(v0));
+      acc1 = _mm_add_pd(acc1, _mm_cvtps_pd(_mm_movehl_ps(v0, v0)));
+      acc2 = _mm_add_pd(acc2, _mm_cvtps_pd(v1));
+      acc3 = _mm_add_pd(acc3, _mm_cvtps_pd(_mm_movehl_ps(v1, v1)));
+    }
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes,
+                _mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3)));
+  return lanes[0] + lanes[1];
+}
+
+/*
+ * Маски дорожек регистра двойной точности для двух битов маски валидности
+ */
+alignas(16) static const uint64_t PAIR_MASKS[4][2] = {
+    {0, 0}, {~uint64_t(0), 0}, {0, ~uint64_t(0)}, {~uint64_t(0), ~uint64_t(0)}};
+
+/*
+ * @brief Получить маску дорожек для двух значений двойной точности
+ * @param pair два бита маски валидности
+ * @return маска регистра
+ */
+static inline __m128d pairMask(uint64_t pair) {
+  return _mm_castsi128_pd(
+      _mm_load_si128(reinterpret_cast<const __m128i *>(PAIR_MASKS[pair])));
+}
+
+/*
+ * @brief Отклонения от среднего и экстремумы блоков по 64 значения на SSE2
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @param moments моменты части с вычисленным средним
+ */
+static void blockDeviationsSse2(const float *values, const uint64_t *validity,
+                                size_t blocks, Moments &moments) {
+  const __m128d mean = _mm_set1_pd(moments.mean);
+  const __m128 positive = _mm_set1_ps(INFINITY);
+  const __m128 negative = _mm_set1_ps(-INFINITY);
+  __m128d m2 = _mm_setzero_pd();
+  __m128d m3 = _mm_setzero_pd();
+  __m128 low = positive;
+  __m128 high = negative;
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 16; k++) {
+      uint64_t nibble = (word >> (4 * k)) & 0xF;
+      __m128 v = _mm_loadu_ps(block + 4 * k);
+      __m128 mask = laneMask(nibble);
+
+      // отсутствующие значения не меняют экстремумы
+      low = _mm_min_ps(low, _mm_or_ps(_mm_and_ps(mask, v),
+                                      _mm_andnot_ps(mask, positive)));
+      high = _mm_max_ps(high, _mm_or_ps(_mm_and_ps(mask, v),
+                                        _mm_andnot_ps(mask, negative)));
+
+      // и дают нулевые отклонения
+      __m128d d0 = _mm_and_pd(_mm_sub_pd(_mm_cvtps_pd(v), mean),
+                              pairMask(nibble & 3));
+      __m128d d1 =
+          _mm_and_pd(_mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), mean),
+                     pairMask(nibble >> 2));
+      __m128d s0 = _mm_mul_pd(d0, d0);
+      __m128d s1 = _mm_mul_pd(d1, d1);
+
+      m2 = _mm_add_pd(m2, _mm_add_pd(s0, s1));
+      m3 = _mm_add_pd(m3, _mm_add_pd(_mm_mul_pd(s0, d0), _mm_mul_pd(s1, d1)));
+    }
+  }
+
+  double m2_lanes[2], m3_lanes[2];
+  float low_lanes[4], high_lanes[4];
+  _mm_storeu_pd(m2_lanes, m2);
+  _mm_storeu_pd(m3_lanes, m3);
+  _mm_storeu_ps(low_lanes, low);
+  _mm_storeu_ps(high_lanes, high);
+
+  moments.m2 += m2_lanes[0] + m2_lanes[1];
+  moments.m3 += m3_lanes[0] + m3_lanes[1];
+  for (int i = 0; i < 4; i++) {
+    moments.min = std::min(moments.min, low_lanes[i]);
+    moments.max = std::max(moments.max, high_lanes[i]);
+  }
+}
+#endif
+
+#if defined(KERNELS_AVX2)
+/*
+ * @brief Маска дорожек AVX-регистра для восьми значений
+ * @param byte восемь битов маски валидности
+ * @return маска регистра
+ */
+__attribute__((target("avx2"))) static inline __m256
+laneMask8(uint64_t byte) {
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  __m256i spread = _mm256_and_si256(_mm256_set1_epi32(int(byte)), bits);
+  return _mm256_castsi256_ps(_mm256_cmpeq_epi32(spread, bits));
+}
+
+/*
+ * @brief Сумма блоков по 64 значения на AVX2: четыре независимых
+ * аккумулятора двойной точности по четыре дорожки
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @return сумма
+ */
+__attribute__((target("avx2"))) static double
+blockSumAvx2(const float *values, const uint64_t *validity, size_t blocks) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  __m256d acc2 = _mm256_setzero_pd();
+  __m256d acc3 = _mm256_setzero_pd();
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 8; k += 2) {
+      __m256 v0 = _mm256_and_ps(_mm256_loadu_ps(block + 8 * k),
+                                laneMask8((word >> (8 * k)) & 0xFF));
+      __m256 v1 = _mm256_and_ps(_mm256_loadu_ps(block + 8 * k + 8),
+                                laneMask8((word >> (8 * k + 8)) & 0xFF));
+
+      __m128 v0_low = _mm256_castps256_ps128(v0);
+      __m128 v0_high = _mm256_extractf128_ps(v0, 1);
+      __m128 v1_low = _mm256_castps256_ps128(v1);
+      __m128 v1_high = _mm256_extractf128_ps(v1, 1);
+
+      acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(v0_low));
+      acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(v0_high));
+      acc2 = _mm256_add_pd(acc2, _mm256_cvtps_pd(v1_low));
+      acc3 = _mm256_add_pd(acc3, _mm256_cvtps_pd(v1_high));
+    }
+  }
+
+  __m256d total = _mm256_add_pd(_mm256_add_pd(acc0, acc1),
+                                _mm256_add_pd(acc2, acc3));
+  double lanes[4];
+  _mm256_storeu_pd(lanes, total);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+/*
+ * @brief Проверить поддержку AVX2 процессором (один раз за запуск)
+ * @return true, если AVX2 доступен
+ */
+static bool hasAvx2() {
+  static const bool supported = []() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+#endif
+
+/*
+ * @brief Обнулить значение без ветвления, если бит маски сброшен
+ * @param value значение
+ * @param bit бит маски (0 или 1)
+ * @return value или 0
+ */
+static inline float maskValue(float value, uint64_t bit) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits &= 0u - static_cast<uint32_t>(bit);
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+}
+
+/*
+ * @brief Получить бит маски валидности
+ * @param validity слова маски или nullptr
+ * @param index номер значения
+ * @return 1, если значение присутствует, 0 - иначе
+ */
+static inline uint64_t validBit(const uint64_t *validity, size_t index) {
+  return validity ? (validity[index / 64] >> (index % 64)) & 1 : 1;
+}
+
+#if !defined(__SSE2__)
+/*
+ * @brief Сумма блоков по 64 значения без SIMD: четыре независимых
+ * аккумулятора двойной точности
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @return сумма
+ */
+static double blockSumScalar(const float *values, const uint64_t *validity,
+                             size_t blocks) {
+  double acc[4] = {0, 0, 0, 0};
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 64; k += 4) {
+      acc[0] += maskValue(block[k], (word >> k) & 1);
+      acc[1] += maskValue(block[k + 1], (word >> (k + 1)) & 1);
+      acc[2] += maskValue(block[k + 2], (word >> (k + 2)) & 1);
+      acc[3] += maskValue(block[k + 3], (word >> (k + 3)) & 1);
+    }
+  }
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+#endif
+
+/**
+ * @brief Сумма присутствующих значений
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return сумма
+ */
+double maskedSum(const float *values, const uint64_t *validity,
+                 size_t length) {
+  size_t blocks = length / 64;
+  double total;
+
+#if defined(KERNELS_AVX2)
+  if (hasAvx2())
+    total = blockSumAvx2(values, validity, blocks);
+  else
+    total = blockSumSse2(values, validity, blocks);
+#elif defined(__SSE2__)
+  total = blockSumSse2(values, validity, blocks);
+#else
+  total = blockSumScalar(values, validity, blocks);
+#endif
+
+  // хвост короче одного слова маски
+  for (size_t i = blocks * 64; i < length; i++) {
+    total += maskValue(values[i], validBit(validity, i));
+  }
+  return total;
+}
+
+/*
+ * @brief Отклонения от среднего и экстремумы значений без SIMD
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param begin номер первого значения
+ * @param end номер значения после последнего
+ * @param moments моменты части с вычисленным средним
+ */
+static void deviationsScalar(const float *values, const uint64_t *validity,
+                             size_t begin, size_t end, Moments &moments) {
+  for (size_t i = begin; i < end; i++) {
+    if (!validBit(validity, i))
+      continue;
+
+    double d = values[i] - moments.mean;
+    moments.m2 += d * d;
+    moments.m3 += d * d * d;
+    moments.min = std::min(moments.min, values[i]);
+    moments.max = std::max(moments.max, values[i]);
+  }
+}
+
+/**
+ * @brief Моменты и экстремумы присутствующих значений за один проход по
+ * памяти: каждая часть из MOMENTS_CHUNK значений сначала суммируется, а затем,
+ * пока находится в кэше, дает отклонения от своего среднего
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return моменты
+ */
+Moments maskedMoments(const float *values, const uint64_t *validity,
+                      size_t length) {
+  Moments total;
+
+  for (size_t start = 0; start < length; start += MOMENTS_CHUNK) {
+    size_t size = std::min(MOMENTS_CHUNK, length - start);
+    const float *chunk_values = values + start;
+    const uint64_t *chunk_validity = validity ? validity + start / 64 : nullptr;
+
+    Moments chunk;
+    chunk.count = maskedCount(chunk_validity, size);
+    if (chunk.count == 0)
+      continue;
+    chunk.sum = maskedSum(chunk_values, chunk_validity, size);
+    chunk.mean = chunk.sum / chunk.count;
+
+    size_t blocks = size / 64;
+#if defined(__SSE2__)
+    blockDeviationsSse2(chunk_values, chunk_validity, blocks, chunk);
+#else
+    deviationsScalar(chunk_values, chunk_validity, 0, blocks * 64, chunk);
+#endif
+    deviationsScalar(chunk_values, chunk_validity, blocks * 64, size, chunk);
+
+    mergeMoments(total, chunk);
+  }
+  return total;
+}
+
+/**
+ * @brief Добавить моменты следующей части данных (формулы Чана)
+ * @param into накапливаемые моменты
+ * @param from моменты следующей части
+ */
+void mergeMoments(Moments &into, const Moments &from) {
+  if (from.count == 0)
+    return;
+  if (into.count == 0) {
+    into = from;
+    return;
+  }
+
+  double na = into.count;
+  double nb = from.count;
+  double n = na + nb;
+  double delta = from.mean - into.mean;
+
+  // m3 зависит от m2 обеих частей до объединения
+  into.m3 += from.m3 + delta * delta * delta * na * nb * (na - nb) / (n * n) +
+             3 * delta * (na * from.m2 - nb * into.m2) / n;
+  into.m2 += from.m2 + delta * delta * na * nb / n;
+  into.mean += delta * nb / n;
+  into.sum += from.sum;
+  into.count += from.count;
+  into.min = std::min(into.min, from.min);
+  into.max = std::max(into.max, from.max);
+}
+
+/**
+ * @brief Добавить одно значение к моментам (обновление Уэлфорда)
+ * @param into накапливаемые моменты
+ * @param value значение
+ */
+void addMoment(Moments &into, float value) {
+  double n = ++into.count;
+  double delta = value - into.mean;
+  double delta_n = delta / n;
+  double term = delta * delta_n * (n - 1);
+
+  // m3 использует m2 до обновления
+  into.m3 += term * delta_n * (n - 2) - 3 * delta_n * into.m2;
+  into.m2 += term;
+  into.mean += delta_n;
+  into.sum += value;
+  into.min = std::min(into.min, value);
+  into.max = std::max(into.max, value);
+}
+
+/**
+ * @brief Количество присутствующих значений
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @return количество установленных битов
+ */
+size_t maskedCount(const uint64_t *validity, size_t length) {
+  if (!validity)
+    return length;
+
+  size_t count = 0;
+  size_t full_words = length / 64;
+
+  for (size_t w = 0; w < full_words; w++) {
+    count += __builtin_popcountll(validity[w]);
+  }
+  if (length % 64) {
+    uint64_t tail = validity[full_words] & ((uint64_t(1) << (length % 64)) - 1);
+    count += __builtin_popcountll(tail);
+  }
+  return count;
+}
+
+#if defined(__SSE2__)
+/*
+ * @brief Накопленная сумма блоков по 64 значения на SSE2: префиксы
+ * считаются внутри пар значений, а затем к паре прибавляется сумма всех
+ * предыдущих значений
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @param out указатель на результат
+ * @return сумма всех значений блоков
+ */
+static double blockPrefixSumSse2(const float *values, const uint64_t *validity,
+                                 size_t blocks, float *out) {
+  const __m128d zero = _mm_setzero_pd();
+  __m128d total = zero;
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 16; k++) {
+      __m128 v = _mm_and_ps(_mm_loadu_ps(block + 4 * k),
+                            laneMask((word >> (4 * k)) & 0xF));
+      __m128d lo = _mm_cvtps_pd(v);
+      __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+
+      // префиксы пар: {a, a + b}
+      lo = _mm_add_pd(lo, _mm_unpacklo_pd(zero, lo));
+      hi = _mm_add_pd(hi, _mm_unpacklo_pd(zero, hi));
+      lo = _mm_add_pd(lo, total);
+      hi = _mm_add_pd(hi, _mm_unpackhi_pd(lo, lo));
+      total = _mm_unpackhi_pd(hi, hi);
+
+      _mm_storeu_ps(out + b * 64 + 4 * k,
+                    _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+    }
+  }
+  return _mm_cvtsd_f64(total);
+}
+#endif
+
+/**
+ * @brief Накопленная сумма присутствующих значений: out[i] - сумма
+ * присутствующих значений с номерами от 0 до i. Сумма накапливается в
+ * двойной точности
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param out указатель на результат (length значений)
+ */
+void maskedPrefixSum(const float *values, const uint64_t *validity,
+                     size_t length, float *out) {
+  size_t done = 0;
+  double total = 0;
+
+#if defined(__SSE2__)
+  done = length / 64 * 64;
+  total = blockPrefixSumSse2(values, validity, length / 64, out);
+#endif
+
+  for (size_t i = done; i < length; i++) {
+    total += maskValue(values[i], validBit(validity, i));
+    out[i] = total;
+  }
+}
+
+#if defined(__SSE2__)
+/*
+ * @brief Минимум и максимум блоков по 64 значения на SSE2: отсутствующие
+ * значения заменяются бесконечностями, а NaN не проходит сравнение
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @param min минимум (уменьшается)
+ * @param max максимум (увеличивается)
+ */
+static void blockRangeSse2(const float *values, const uint64_t *validity,
+                           size_t blocks, float &min, float &max) {
+  const __m128 infinity = _mm_set1_ps(INFINITY);
+  const __m128 negative = _mm_set1_ps(-INFINITY);
+  __m128 low = infinity;
+  __m128 high = negative;
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 16; k++) {
+      __m128 v = _mm_loadu_ps(block + 4 * k);
+      __m128 mask = laneMask((word >> (4 * k)) & 0xF);
+      // при NaN в первом аргументе _mm_min_ps возвращает второй
+      low = _mm_min_ps(
+          _mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, infinity)), low);
+      high = _mm_max_ps(
+          _mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, negative)), high);
+    }
+  }
+
+  float low_lanes[4], high_lanes[4];
+  _mm_storeu_ps(low_lanes, low);
+  _mm_storeu_ps(high_lanes, high);
+  for (int i = 0; i < 4; i++) {
+    min = std::min(min, low_lanes[i]);
+    max = std::max(max, high_lanes[i]);
+  }
+}
+
+/*
+ * @brief Гистограмма блоков по 64 значения на SSE2: маска попадания в
+ * диапазон и номера корзин считаются для четырех значений сразу, а счетчики
+ * увеличиваются на бит маски без ветвления
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param blocks количество блоков по 64 значения
+ * @param min нижняя граница
+ * @param max верхняя граница
+ * @param scale количество корзин на единицу значения
+ * @param bins количество корзин
+ * @param counts счетчики корзин
+ */
+static void blockHistogramSse2(const float *values, const uint64_t *validity,
+                               size_t blocks, float min, float max,
+                               float scale, size_t bins, uint64_t *counts) {
+  const __m128 low = _mm_set1_ps(min);
+  const __m128 high = _mm_set1_ps(max);
+  const __m128 factor = _mm_set1_ps(scale);
+  const __m128 last = _mm_set1_ps(float(bins - 1));
+  alignas(16) int32_t index[4];
+
+  for (size_t b = 0; b < blocks; b++) {
+    const float *block = values + b * 64;
+    uint64_t word = validity ? validity[b] : ~uint64_t(0);
+
+    for (int k = 0; k < 16; k++) {
+      __m128 v = _mm_loadu_ps(block + 4 * k);
+      __m128 inside =
+          _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(v, low), _mm_cmple_ps(v, high)),
+                     laneMask((word >> (4 * k)) & 0xF));
+      int lanes = _mm_movemask_ps(inside);
+      if (!lanes)
+        continue;
+
+      // значения вне диапазона получают корзину 0 и прибавляют 0
+      __m128 bin = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(v, low), factor), last);
+      _mm_store_si128(reinterpret_cast<__m128i *>(index),
+                      _mm_cvttps_epi32(_mm_and_ps(bin, inside)));
+      counts[index[0]] += lanes & 1;
+      counts[index[1]] += (lanes >> 1) & 1;
+      counts[index[2]] += (lanes >> 2) & 1;
+      counts[index[3]] += (lanes >> 3) & 1;
+    }
+  }
+}
+#endif
+
+/**
+ * @brief Минимум и максимум присутствующих значений (NaN пропускаются)
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param min минимум (INFINITY, если значений нет)
+ * @param max максимум (-INFINITY, если значений нет)
+ */
+void maskedRange(const float *values, const uint64_t *validity, size_t length,
+                 float &min, float &max) {
+  size_t done = 0;
+  min = INFINITY;
+  max = -INFINITY;
+
+#if defined(__SSE2__)
+  done = length / 64 * 64;
+  blockRangeSse2(values, validity, length / 64, min, max);
+#endif
+
+  for (size_t i = done; i < length; i++) {
+    if (validBit(validity, i) and !std::isnan(values[i])) {
+      min = std::min(min, values[i]);
+      max = std::max(max, values[i]);
+    }
+  }
+}
+
+/**
+ * @brief Добавить присутствующие значения из диапазона [min, max] в bins
+ * равных корзин: номера корзин четырех значений вычисляются за одну
+ * SIMD-операцию, значение max попадает в последнюю корзину. Значения вне
+ * диапазона и NaN не учитываются
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param min нижняя граница
+ * @param max верхняя граница
+ * @param bins количество корзин
+ * @param counts счетчики корзин (bins значений, увеличиваются)
+ */
+void maskedHistogram(const float *values, const uint64_t *validity,
+                     size_t length, float min, float max, size_t bins,
+                     uint64_t *counts) {
+  if (bins == 0 or !(min <= max))
+    return;
+  // все значения вырожденного диапазона попадают в первую корзину
+  float scale = max > min ? float(bins) / (max - min) : 0;
+  size_t done = 0;
+
+#if defined(__SSE2__)
+  done = length / 64 * 64;
+  blockHistogramSse2(values, validity, length / 64, min, max, scale, bins,
+                     counts);
+#endif
+
+  for (size_t i = done; i < length; i++) {
+    float value = values[i];
+    if (validBit(validity, i) and value >= min and value <= max)
+      counts[std::min(size_t((value - min) * scale), bins - 1)]++;
+  }
+}
+
+// поток выполняет часть параллельной работы (файл набора или часть диапазона)
+thread_local bool worker_thread = false;
+
+/**
+ * @brief Пока объект жив, текущий поток считается рабочим потоком
+ * параллельной части (файла набора или части parallelChunks): ядра в нем
+ * выполняются в одном потоке, чтобы вложенный параллелизм не порождал N×N
+ * потоков
+ */
+WorkerThreadScope::WorkerThreadScope(bool active) : previous(worker_thread) {
+  if (active)
+    worker_thread = true;
+}
+
+WorkerThreadScope::~WorkerThreadScope() { worker_thread = previous; }
+
+/**
+ * @brief Количество потоков для параллельного ядра
+ * @param workers запрошенное количество (0 - по числу ядер)
+ * @return 1 в рабочем потоке параллельной части, иначе workers или число
+ * ядер
+ */
+unsigned resolveWorkers(unsigned workers) {
+  if (worker_thread)
+    return 1;
+  if (workers == 0)
+    return std::max(1u, std::thread::hardware_concurrency());
+  return workers;
+}
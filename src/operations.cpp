@@ -1,93 +1,1352 @@
 #include "../include/operations.h"
+#include "../include/kernels.h"
+#include "../include/window.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <variant>
 #include <vector>
 
-using std::function;
-using std::get_if;
 using std::runtime_error;
 using std::string;
 using std::vector;
 
-map<string, FunctionVariant> operation_map = {
-    {"sum", function<float(vector<float>)>(sum)},
-    {"average", function<float(vector<float>)>(average)},
-    {"concatinate", function<string(vector<string>)>(concatinate)},
+/*
+ * @brief Выборочная дисперсия по моментам
+ * @param moments моменты
+ * @return дисперсия или NaN, если значений меньше двух
+ */
+double sampleVariance(const Moments &moments) {
+  if (moments.count < 2)
+    return NAN;
+  return moments.m2 / (moments.count - 1);
+}
+
+const string PARAM_Q = "q";               // параметр уровня квантиля
+const string PARAM_ACCURACY = "accuracy"; // параметр точности скетча
+const string PARAM_EXACT = "exact";       // параметр точного режима
+const string PARAM_FIND = "find";         // параметр искомой подстроки
+const string PARAM_REPLACE = "replace";   // параметр строки замены
+const string PARAM_OP = "op";             // параметр операции сравнения
+const string PARAM_VALUE = "value";       // параметр значения сравнения
+const string PARAM_STREAM = "stream";     // параметр потоковой записи
+const string PARAM_WINDOW = "window";     // параметр размера окна
+const string PARAM_MEMORY = "memory";     // параметр бюджета памяти, МБ
+const string PARAM_ORDER = "order";       // параметр порядка сортировки
+const string PARAM_K = "k";               // параметр количества значений
+const string PARAM_BINS = "bins";         // параметр количества корзин
+const string PARAM_MIN = "min";           // параметр нижней границы
+const string PARAM_MAX = "max";           // параметр верхней границы
+
+/*
+ * @brief Получить числовой параметр операции
+ * @param params параметры операции
+ * @param name имя параметра
+ * @param fallback значение по умолчанию
+ * @return значение параметра или fallback, если параметр не задан или не число
+ */
+double numericParam(const Params &params, const string &name,
+                    double fallback) {
+  auto param = params.find(name);
+  if (param == params.end())
+    return fallback;
+
+  try {
+    return std::stod(param->second);
+  } catch (const std::exception &e) {
+    return fallback;
+  }
+}
+
+/*
+ * @brief Проверить числовой параметр операции
+ * @param params параметры операции
+ * @param name имя параметра
+ * @param min наименьшее допустимое значение
+ * @param max наибольшее допустимое значение
+ * @return true, если параметр не задан или задан конечным числом из
+ * диапазона [min, max]
+ */
+bool paramInRange(const Params &params, const string &name, double min,
+                  double max) {
+  if (!params.count(name))
+    return true;
+  double value = numericParam(params, name, NAN);
+  return value >= min and value <= max;
+}
+
+/*
+ * @brief Получить параметр-количество операции
+ * @param params параметры операции
+ * @param name имя параметра
+ * @param fallback значение по умолчанию
+ * @param min наименьшее значение
+ * @param max наибольшее значение
+ * @return значение параметра, приведенное к диапазону [min, max], или
+ * fallback, если параметр не задан или не конечное число
+ */
+size_t countParam(const Params &params, const string &name, size_t fallback,
+                  size_t min, size_t max) {
+  double value = numericParam(params, name, fallback);
+  if (!std::isfinite(value))
+    return fallback;
+  return std::clamp(value, double(min), double(max));
+}
+
+/*
+ * @brief Получить параметры гистограммы: диапазон задан, только если оба
+ * параметра min и max - числа и min не больше max
+ * @param params параметры операции
+ * @return параметры гистограммы
+ */
+HistogramSpec histogramParam(const Params &params) {
+  HistogramSpec spec;
+  spec.bins = countParam(params, PARAM_BINS, DEFAULT_BINS, 1, MAX_BINS);
+  spec.min = numericParam(params, PARAM_MIN, NAN);
+  spec.max = numericParam(params, PARAM_MAX, NAN);
+  spec.fixed = spec.min <= spec.max;
+  return spec;
+}
+
+/*
+ * @brief Проверить, задан ли точный режим квантилей
+ * @param params параметры операции
+ * @return true, если параметр exact равен true
+ */
+bool exactParam(const Params &params) {
+  auto param = params.find(PARAM_EXACT);
+  return param != params.end() and param->second == "true";
+}
+
+/*
+ * @brief Получить квантиль из частичного результата
+ * @param op номер операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return квантиль по скетчу или точный квантиль в режиме exact
+ */
+float quantileOf(OperationId op, const PartialResult &partial,
+                 const Params &params) {
+  double q = operationInfo(op).quantile;
+  if (q < 0)
+    q = numericParam(params, PARAM_Q, 0.5);
+
+  // значения состояния отсортированы, поэтому запрос их не копирует
+  if (exactParam(params))
+    return sortedQuantile(partial.values, q);
+  return sketchQuantile(partial.sketch, q);
+}
+
+/*
+ * @brief Завершение операции с числовым результатом: для каждой операции
+ * компилируется отдельная функция без выбора операции во время вызова
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции op
+ */
+template <OperationId op>
+float finalizeNumericOp(const PartialResult &partial, const Params &params) {
+  const Moments &moments = partial.moments;
+
+  if constexpr (op == OP_SUM)
+    return partial.sum;
+  else if constexpr (op == OP_AVERAGE)
+    return partial.sum / partial.count;
+  else if constexpr (op == OP_MIN)
+    return moments.count ? moments.min : NAN;
+  else if constexpr (op == OP_MAX)
+    return moments.count ? moments.max : NAN;
+  else if constexpr (op == OP_COUNT or op == OP_ROLLING_SUM or
+                     op == OP_ROLLING_AVERAGE or op == OP_CUMULATIVE_SUM)
+    // оконная операция пишет количество значений производного столбца
+    return float(partial.count);
+  else if constexpr (op == OP_VARIANCE)
+    return sampleVariance(moments);
+  else if constexpr (op == OP_STDDEV)
+    return std::sqrt(sampleVariance(moments));
+  else if constexpr (op == OP_SKEWNESS) {
+    if (moments.count < 2 or moments.m2 == 0)
+      return NAN;
+    return std::sqrt(double(moments.count)) * moments.m3 /
+           std::pow(moments.m2, 1.5);
+  } else
+    return quantileOf(op, partial, params);
+}
+
+/*
+ * @brief Собрать части потоковой записи в строку точного размера
+ * @param partial объединенный частичный результат
+ * @return объединение строк частей
+ */
+string joinPieces(const PartialResult &partial) {
+  size_t size = 0;
+  for (const TextPiece &piece : partial.pieces) {
+    StringView view = pieceView(piece);
+    for (size_t i = 0; i < view.length; i++) {
+      size += isPresent(view.validity, i) * view.values[i].size();
+    }
+  }
+  string result;
+  result.reserve(size);
+  for (const TextPiece &piece : partial.pieces) {
+    StringView view = pieceView(piece);
+    for (size_t i = 0; i < view.length; i++) {
+      if (isPresent(view.validity, i))
+        result.append(view.values[i]);
+    }
+  }
+  return result;
+}
+
+/*
+ * @brief Проверить, задан ли порядок по убыванию (order: desc)
+ * @param params параметры операции
+ * @return true для order: desc
+ */
+bool descendingParam(const Params &params) {
+  auto order = params.find(PARAM_ORDER);
+  return order != params.end() and order->second == "desc";
+}
+
+/*
+ * @brief Собрать отсортированные значения через запятую (по убыванию с
+ * параметром order: desc). Слияние сразу идет в нужном порядке, поэтому
+ * значения дописываются в строку результата без промежуточного вектора
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return значения по порядку
+ */
+string sortedText(const PartialResult &partial, const Params &params) {
+  string result;
+  bool first = true;
+  forEachSorted(partial.sorted, descendingParam(params),
+                [&](const string &value) {
+                  if (!first)
+                    result += ',';
+                  result += value;
+                  first = false;
+                });
+  return result;
+}
+
+/*
+ * @brief Проверить, задан ли порядок по возрастанию (order: asc)
+ * @param params параметры операции
+ * @return true для order: asc
+ */
+bool ascendingParam(const Params &params) {
+  auto order = params.find(PARAM_ORDER);
+  return order != params.end() and order->second == "asc";
+}
+
+/*
+ * @brief Собрать лучшие значения top_k через запятую: числа с номерами строк
+ * или строки с частотами и номером первой строки
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return значения от лучшего к худшему
+ */
+string topKText(const PartialResult &partial, const Params &params) {
+  const TopKState &state =
+      ascendingParam(params) ? partial.bottom : partial.top;
+  std::ostringstream text;
+
+  if (partial.type == STRING) {
+    vector<pair<string, TopCount>> values = topKStrings(state);
+    for (size_t i = 0; i < values.size(); i++) {
+      text << (i ? ", " : "") << values[i].first << ": "
+           << values[i].second.count << " (row " << values[i].second.row
+           << ")";
+    }
+  } else {
+    vector<TopEntry> values = topKValues(state);
+    for (size_t i = 0; i < values.size(); i++) {
+      text << (i ? ", " : "") << values[i].value << " (row " << values[i].row
+           << ")";
+    }
+  }
+  return text.str();
+}
+
+/*
+ * @brief Записать счетчики гистограммы компактно: границы, затем счетчики
+ * через запятую, где серия из трех и более пустых корзин записывается как
+ * 0*N, и количество значений вне диапазона, если они есть
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return например, "0..10: 4,0*3,1, outside: 2"
+ */
+string histogramText(const PartialResult &partial, const Params &params) {
+  HistogramSpec spec = histogramParam(params);
+  auto state = std::find_if(
+      partial.histograms.begin(), partial.histograms.end(),
+      [&](const HistogramState &histogram) { return histogram.spec == spec; });
+  if (state == partial.histograms.end())
+    return "";
+
+  std::ostringstream text;
+  const vector<uint64_t> &counts = state->counts;
+  if (!counts.empty())
+    text << state->min << ".." << state->max << ": ";
+  for (size_t b = 0; b < counts.size();) {
+    size_t run = 0;
+    while (b + run < counts.size() and counts[b + run] == 0) {
+      run++;
+    }
+    text << (b ? "," : "");
+    if (run >= 3) {
+      text << "0*" << run;
+      b += run;
+    } else {
+      text << counts[b++];
+    }
+  }
+  if (state->outside)
+    text << (counts.empty() ? "" : ", ") << "outside: " << state->outside;
+  return text.str();
+}
+
+/*
+ * @brief Завершение операции со строковым результатом
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции op
+ */
+template <OperationId op>
+string finalizeStringOp(const PartialResult &partial, const Params &params) {
+  if constexpr (op == OP_CONCATINATE)
+    // вне потоковой записи части собираются в строку точного размера
+    return streamsText(op, params) ? joinPieces(partial) : partial.text;
+  else if constexpr (op == OP_COUNT_DISTINCT_APPROX)
+    return std::to_string(std::llround(distinctEstimate(partial.distinct)));
+  else if constexpr (op == OP_COUNT_DISTINCT)
+    return std::to_string(partial.distinct_set.values.size());
+  else if constexpr (op == OP_SORT)
+    return sortedText(partial, params);
+  else if constexpr (op == OP_TOP_K)
+    return topKText(partial, params);
+  else if constexpr (op == OP_HISTOGRAM)
+    return histogramText(partial, params);
+  else
+    // преобразование пишет количество значений производного столбца, отбор -
+    // количество выбранных строк, а соединение - количество строк таблицы
+    return std::to_string(partial.count);
+}
+
+// таблица операций по номерам OperationId; последняя запись - OP_UNKNOWN
+const OperationInfo OPERATIONS[OP_UNKNOWN + 1] = {
+    {"sum", NUMERIC, NUMERIC, true, false, 0, finalizeNumericOp<OP_SUM>},
+    {"average", NUMERIC, NUMERIC, true, false, 0,
+     finalizeNumericOp<OP_AVERAGE>},
+    {"min", NUMERIC, NUMERIC, true, true, 0, finalizeNumericOp<OP_MIN>},
+    {"max", NUMERIC, NUMERIC, true, true, 0, finalizeNumericOp<OP_MAX>},
+    {"count", NUMERIC, NUMERIC, true, false, 0, finalizeNumericOp<OP_COUNT>},
+    {"variance", NUMERIC, NUMERIC, true, true, 0,
+     finalizeNumericOp<OP_VARIANCE>},
+    {"stddev", NUMERIC, NUMERIC, true, true, 0, finalizeNumericOp<OP_STDDEV>},
+    {"skewness", NUMERIC, NUMERIC, true, true, 0,
+     finalizeNumericOp<OP_SKEWNESS>},
+    {"median", NUMERIC, NUMERIC, false, false, 0.5,
+     finalizeNumericOp<OP_MEDIAN>},
+    {"p95", NUMERIC, NUMERIC, false, false, 0.95, finalizeNumericOp<OP_P95>},
+    {"p99", NUMERIC, NUMERIC, false, false, 0.99, finalizeNumericOp<OP_P99>},
+    {"quantile", NUMERIC, NUMERIC, false, false, -1,
+     finalizeNumericOp<OP_QUANTILE>},
+    {"concatinate", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_CONCATINATE>},
+    {"count_distinct_approx", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_COUNT_DISTINCT_APPROX>},
+    {"count_distinct", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_COUNT_DISTINCT>},
+    {"find_replace", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_FIND_REPLACE>, findReplaceColumn},
+    {"filter", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_FILTER>, nullptr, filterRows},
+    {"rolling_sum", NUMERIC, NUMERIC, false, false, 0,
+     finalizeNumericOp<OP_ROLLING_SUM>, nullptr, nullptr, nullptr,
+     rollingSumColumn},
+    {"rolling_average", NUMERIC, NUMERIC, false, false, 0,
+     finalizeNumericOp<OP_ROLLING_AVERAGE>, nullptr, nullptr, nullptr,
+     rollingAverageColumn},
+    {"cumulative_sum", NUMERIC, NUMERIC, false, false, 0,
+     finalizeNumericOp<OP_CUMULATIVE_SUM>, nullptr, nullptr, nullptr,
+     cumulativeSumColumn},
+    // сортировка и top_k читают столбец в его типе: числа - как числа
+    {"sort", UNKNOWN, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_SORT>},
+    {"join", STRING, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_JOIN>},
+    {"top_k", UNKNOWN, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_TOP_K>},
+    {"histogram", NUMERIC, STRING, false, false, 0, nullptr,
+     finalizeStringOp<OP_HISTOGRAM>},
+    {"", UNKNOWN, UNKNOWN, false, false, 0},
 };
 
 /*
- * @brief Вызвать операцию из словаря операций
- * @param op_name указатель на ключ операции
- * @param arg входной параметр вызываемой операции
- * @return результат работы вызываемой функции
+ * @brief Разрешить ключ операции в номер (при загрузке конфигурации)
+ * @param op_name ключ операции
+ * @return номер операции или OP_UNKNOWN
+ */
+OperationId resolveOperation(const string &op_name) {
+  for (int op = 0; op < OP_UNKNOWN; op++) {
+    if (op_name == OPERATIONS[op].name)
+      return OperationId(op);
+  }
+  return OP_UNKNOWN;
+}
+
+/*
+ * @brief Получить запись таблицы операций
+ * @param op номер операции
+ * @return запись (для OP_UNKNOWN - запись без функций с типом UNKNOWN)
+ */
+const OperationInfo &operationInfo(OperationId op) {
+  return OPERATIONS[op < OP_UNKNOWN ? op : OP_UNKNOWN];
+}
+
+/*
+ * @brief Получить тип столбца, который принимает операция
+ * @param op номер операции
+ * @return NUMERIC, STRING или UNKNOWN для неизвестной операции
+ */
+ColumnType operationInput(OperationId op) { return operationInfo(op).input; }
+
+/*
+ * @brief Получить тип столбца, который принимает операция
+ * @param op_name ключ операции
+ * @return NUMERIC, STRING или UNKNOWN для неизвестной операции
+ */
+ColumnType operationInput(const string &op_name) {
+  return operationInput(resolveOperation(op_name));
+}
+
+/*
+ * @brief Получить тип результата операции
+ * @param op номер операции
+ * @return NUMERIC, STRING или UNKNOWN для неизвестной операции
+ */
+ColumnType operationResult(OperationId op) { return operationInfo(op).result; }
+
+/*
+ * @brief Проверить, принимает ли операция столбец данного типа: сортировка
+ * и top_k принимают и числовые, и строковые столбцы
+ * @param op номер операции
+ * @param type тип столбца в обработанных данных
+ * @return true, если операцию можно завершить над столбцом
+ */
+bool acceptsInput(OperationId op, ColumnType type) {
+  if (op >= OP_UNKNOWN or type == UNKNOWN)
+    return false;
+  ColumnType input = operationInput(op);
+  return input == UNKNOWN or type == input;
+}
+
+/*
+ * @brief Определить, что нужно вычислить за проход по столбцу для операции
+ * @param op номер операции
+ * @param params параметры операции
+ * @return требования к частичному результату
+ */
+StateNeeds needsOf(OperationId op, const Params &params) {
+  const OperationInfo &info = operationInfo(op);
+  StateNeeds needs;
+  needs.moments = info.moments;
+  needs.stream = streamsText(op, params);
+  needs.text = op == OP_CONCATINATE and !needs.stream;
+  needs.distinct = op == OP_COUNT_DISTINCT_APPROX;
+  needs.distinct_set = op == OP_COUNT_DISTINCT;
+  if (op == OP_SORT) {
+    double megabytes = numericParam(params, PARAM_MEMORY, DEFAULT_SORT_MEMORY);
+    needs.sort = std::max(1.0, megabytes * (1 << 20));
+  }
+  if (op == OP_TOP_K) {
+    size_t k = countParam(params, PARAM_K, DEFAULT_TOP_K, 1, MAX_TOP_K);
+    (ascendingParam(params) ? needs.bottom_k : needs.top_k) = k;
+  }
+  if (op == OP_HISTOGRAM)
+    needs.histograms.push_back(histogramParam(params));
+
+  if (info.quantile != 0) {
+    if (exactParam(params))
+      needs.values = true;
+    else
+      needs.sketch = countParam(params, PARAM_ACCURACY, DEFAULT_ACCURACY,
+                                MIN_ACCURACY, MAX_ACCURACY);
+  }
+  return needs;
+}
+
+/*
+ * @brief Определить, что нужно вычислить за проход по столбцу для операции
+ * @param op_name ключ операции
+ * @param params параметры операции
+ * @return требования к частичному результату
  */
-float callOperation(const string &op_name, vector<float> arg) {
-  auto map_elem = operation_map.find(op_name);
-  if (map_elem == operation_map.end())
+StateNeeds needsOf(const string &op_name, const Params &params) {
+  return needsOf(resolveOperation(op_name), params);
+}
+
+/*
+ * @brief Проверить параметры операции при загрузке конфигурации, чтобы
+ * ошибка была найдена до выполнения, а не при вычислении столбца
+ * @param op номер операции
+ * @param params параметры операции
+ * @return описание ошибки или пустая строка, если параметры верны
+ */
+string paramError(OperationId op, const Params &params) {
+  CompareOp compare;
+  auto op_param = params.find(PARAM_OP);
+  if (isFilter(op) and op_param != params.end() and
+      !parseCompare(op_param->second, compare))
+    return "Unknown comparison " + op_param->second;
+  if (operationInfo(op).quantile < 0 and !paramInRange(params, PARAM_Q, 0, 1))
+    return "Parameter q must be a number from 0 to 1";
+  if ((op == OP_ROLLING_SUM or op == OP_ROLLING_AVERAGE) and
+      (!params.count(PARAM_WINDOW) or
+       !paramInRange(params, PARAM_WINDOW, 1, MAX_WINDOW)))
+    return "Parameter window must be a number of rows from 1 to " +
+           std::to_string(MAX_WINDOW);
+  if (op == OP_TOP_K and !paramInRange(params, PARAM_K, 1, MAX_TOP_K))
+    return "Parameter k must be a number from 1 to " +
+           std::to_string(MAX_TOP_K);
+  if (op == OP_HISTOGRAM and !paramInRange(params, PARAM_BINS, 1, MAX_BINS))
+    return "Parameter bins must be a number from 1 to " +
+           std::to_string(MAX_BINS);
+  if (operationInfo(op).quantile != 0 and !exactParam(params) and
+      !paramInRange(params, PARAM_ACCURACY, MIN_ACCURACY, MAX_ACCURACY))
+    return "Parameter accuracy must be a number from " +
+           std::to_string(MIN_ACCURACY) + " to " +
+           std::to_string(MAX_ACCURACY);
+  return "";
+}
+
+/*
+ * @brief Проверить, пишется ли строковый результат операции в лог потоком,
+ * без сборки в одну строку (concatinate с параметром stream: true)
+ * @param op номер операции
+ * @param params параметры операции
+ * @return true для потоковой записи
+ */
+bool streamsText(OperationId op, const Params &params) {
+  if (op != OP_CONCATINATE)
+    return false;
+  auto param = params.find(PARAM_STREAM);
+  return param != params.end() and param->second == "true";
+}
+
+/*
+ * @brief Проверить, совпадает ли производный столбец преобразования с
+ * входным (find_replace с пустым find, с replace, равным find, или без
+ * вхождений find): такой столбец не вычисляется и не копируется
+ * @param op номер операции
+ * @param source входной столбец
+ * @param params параметры операции
+ * @return true, если преобразование не меняет столбец
+ */
+bool keepsColumn(OperationId op, const StringColumn &source,
+                 const Params &params) {
+  if (op != OP_FIND_REPLACE)
+    return false;
+  auto find = params.find(PARAM_FIND);
+  if (find == params.end() or find->second.empty())
+    return true;
+  auto replace = params.find(PARAM_REPLACE);
+  if (replace != params.end() and replace->second == find->second)
+    return true;
+
+  // проход поиска без выделения памяти
+  for (const string &value : source.values) {
+    if (value.find(find->second) != string::npos)
+      return false;
+  }
+  return true;
+}
+
+/*
+ * @brief Проверить, пишется ли строковый результат операции в лог потоком,
+ * без сборки в одну строку (concatinate с параметром stream: true)
+ * @param op_name ключ операции
+ * @param params параметры операции
+ * @return true для потоковой записи
+ */
+bool streamsText(const string &op_name, const Params &params) {
+  return streamsText(resolveOperation(op_name), params);
+}
+
+/*
+ * @brief Получить представление части строкового результата
+ * @param piece часть
+ * @return представление присутствующих (и выбранных) строк части
+ */
+StringView pieceView(const TextPiece &piece) {
+  const StringColumn &column = *piece.column;
+  const uint64_t *validity = piece.mask.words.empty()
+                                 ? validityWords(column)
+                                 : piece.mask.words.data();
+  return StringView(column.values.data(), validity, column.values.size());
+}
+
+/*
+ * @brief Объединить требования нескольких операций над одним столбцом
+ * @param into накапливаемые требования
+ * @param from требования следующей операции
+ */
+void addNeeds(StateNeeds &into, const StateNeeds &from) {
+  into.moments = into.moments or from.moments;
+  into.sketch = std::max(into.sketch, from.sketch);
+  into.values = into.values or from.values;
+  into.text = into.text or from.text;
+  into.stream = into.stream or from.stream;
+  into.distinct = into.distinct or from.distinct;
+  into.distinct_set = into.distinct_set or from.distinct_set;
+  into.sort = std::max(into.sort, from.sort);
+  into.top_k = std::max(into.top_k, from.top_k);
+  into.bottom_k = std::max(into.bottom_k, from.bottom_k);
+  for (const HistogramSpec &spec : from.histograms) {
+    if (std::find(into.histograms.begin(), into.histograms.end(), spec) ==
+        into.histograms.end())
+      into.histograms.push_back(spec);
+  }
+}
+
+/*
+ * @brief Вычислить частичный результат над числовыми данными
+ * @param source представление данных
+ * @param needs что вычислить, кроме суммы и количества
+ * @return сумма и количество присутствующих значений
+ */
+PartialResult partialOf(NumericView source, const StateNeeds &needs) {
+  PartialResult partial;
+  partial.type = NUMERIC;
+
+  if (needs.moments) {
+    partial.moments =
+        maskedMoments(source.values, source.validity, source.length);
+    partial.sum = partial.moments.sum;
+    partial.count = partial.moments.count;
+  } else {
+    partial.sum = maskedSum(source.values, source.validity, source.length);
+    partial.count = maskedCount(source.validity, source.length);
+  }
+
+  if (needs.sketch) {
+    partial.sketch = createSketch(needs.sketch);
+    sketchInsert(partial.sketch, source.values, source.validity,
+                 source.length);
+  }
+  if (needs.sort) {
+    partial.sorted.budget = needs.sort;
+    sortInsert(partial.sorted, source.values, source.validity, source.length);
+  }
+  partial.rows = source.row_count;
+  if (needs.top_k) {
+    partial.top.k = needs.top_k;
+    topKInsert(partial.top, source.values, source.validity, source.length,
+               source.rows);
+  }
+  if (needs.bottom_k) {
+    partial.bottom.k = needs.bottom_k;
+    partial.bottom.ascending = true;
+    topKInsert(partial.bottom, source.values, source.validity, source.length,
+               source.rows);
+  }
+  for (const HistogramSpec &spec : needs.histograms) {
+    HistogramState histogram;
+    histogram.spec = spec;
+    histogramInsert(histogram, source.values, source.validity, source.length);
+    partial.histograms.push_back(std::move(histogram));
+  }
+  // значения сортируются один раз при построении состояния: точные
+  // квантили общего состояния читают их без копирования
+  if (needs.values) {
+    partial.values.reserve(partial.count);
+    for (size_t i = 0; i < source.length; i++) {
+      if (isPresent(source.validity, i))
+        partial.values.push_back(source.values[i]);
+    }
+    radixSort(partial.values);
+  }
+  return partial;
+}
+
+/*
+ * @brief Вычислить частичный результат над строковыми данными
+ * @param source представление данных
+ * @param needs что вычислить, кроме количества
+ * @return количество присутствующих строк и требуемые состояния
+ */
+PartialResult partialOf(StringView source, const StateNeeds &needs) {
+  PartialResult partial;
+  partial.type = STRING;
+  partial.count = maskedCount(source.validity, source.length);
+
+  if (needs.text)
+    partial.text = concatinate(source);
+  // представление не владеет строками, поэтому часть получает их копию;
+  // столбцы таблицы передаются частями без копирования (plan::evaluate)
+  if (needs.stream) {
+    StringColumn copy;
+    for (size_t i = 0; i < source.length; i++) {
+      if (isPresent(source.validity, i))
+        copy.values.push_back(source.values[i]);
+    }
+    copy.length = copy.values.size();
+    copy.validity.length = copy.length;
+    partial.pieces.push_back(
+        {std::make_shared<const StringColumn>(std::move(copy)), Bitmap()});
+  }
+  if (needs.distinct)
+    distinctInsert(partial.distinct, source.values, source.validity,
+                   source.length);
+  if (needs.distinct_set)
+    distinctSetInsert(partial.distinct_set, source.values, source.validity,
+                      source.length);
+  if (needs.sort) {
+    partial.sorted.budget = needs.sort;
+    sortInsert(partial.sorted, source.values, source.validity, source.length);
+  }
+  partial.rows = source.row_count;
+  if (needs.top_k) {
+    partial.top.k = needs.top_k;
+    topKInsert(partial.top, source.values, source.validity, source.length,
+               source.rows);
+  }
+  if (needs.bottom_k) {
+    partial.bottom.k = needs.bottom_k;
+    partial.bottom.ascending = true;
+    topKInsert(partial.bottom, source.values, source.validity, source.length,
+               source.rows);
+  }
+  return partial;
+}
+
+/*
+ * @brief Добавить частичный результат следующей части данных
+ * @param into накапливаемый результат
+ * @param from результат следующей части
+ */
+void mergePartial(PartialResult &into, const PartialResult &from) {
+  // строковый тип вытесняет числовой, числовой - неизвестный
+  if (from.type == STRING or (from.type == NUMERIC and into.type == UNKNOWN))
+    into.type = from.type;
+
+  into.sum += from.sum;
+  into.count += from.count;
+  into.text += from.text;
+  into.pieces.insert(into.pieces.end(), from.pieces.begin(), from.pieces.end());
+  mergeMoments(into.moments, from.moments);
+  sketchMerge(into.sketch, from.sketch);
+  size_t sorted = into.values.size();
+  into.values.insert(into.values.end(), from.values.begin(), from.values.end());
+  std::inplace_merge(into.values.begin(), into.values.begin() + sorted,
+                     into.values.end());
+  distinctMerge(into.distinct, from.distinct);
+  distinctSetMerge(into.distinct_set, from.distinct_set);
+  groupMerge(into.groups, from.groups);
+  sortMerge(into.sorted, from.sorted);
+  topKMerge(into.top, from.top, into.rows);
+  topKMerge(into.bottom, from.bottom, into.rows);
+  into.rows += from.rows;
+  for (const HistogramState &histogram : from.histograms) {
+    auto same = std::find_if(into.histograms.begin(), into.histograms.end(),
+                             [&](const HistogramState &state) {
+                               return state.spec == histogram.spec;
+                             });
+    if (same == into.histograms.end())
+      into.histograms.push_back(histogram);
+    else
+      histogramMerge(*same, histogram);
+  }
+}
+
+/*
+ * @brief Получить функцию завершения операции с числовым результатом
+ * @param op номер операции
+ * @return функция завершения
+ */
+NumericFinalize numericFinalize(OperationId op) {
+  if (op >= OP_UNKNOWN)
     throw runtime_error("Operation not found");
+  NumericFinalize func = operationInfo(op).numeric;
+  if (!func)
+    throw runtime_error("Invalid operation type");
+  return func;
+}
+
+/*
+ * @brief Получить числовой результат операции из частичного результата
+ * @param op номер операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+float finalizeNumeric(OperationId op, const PartialResult &partial,
+                      const Params &params) {
+  return numericFinalize(op)(partial, params);
+}
 
-  auto *func = get_if<function<float(vector<float>)>>(&map_elem->second);
+/*
+ * @brief Получить числовой результат операции из частичного результата
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+float finalizeNumeric(const string &op_name, const PartialResult &partial,
+                      const Params &params) {
+  return finalizeNumeric(resolveOperation(op_name), partial, params);
+}
+
+/*
+ * @brief Получить строковый результат операции из частичного результата
+ * @param op номер операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+string finalizeString(OperationId op, const PartialResult &partial,
+                      const Params &params) {
+  if (op >= OP_UNKNOWN)
+    throw runtime_error("Operation not found");
+  StringFinalize func = operationInfo(op).text;
   if (!func)
-    throw std::runtime_error("Invalid operation type");
+    throw runtime_error("Invalid operation type");
+  return func(partial, params);
+}
+
+/*
+ * @brief Получить строковый результат операции из частичного результата
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат
+ * @param params параметры операции
+ * @return результат операции
+ */
+string finalizeString(const string &op_name, const PartialResult &partial,
+                      const Params &params) {
+  return finalizeString(resolveOperation(op_name), partial, params);
+}
+
+/*
+ * @brief Проверить, может ли операция вычисляться по группам
+ * @param op номер операции
+ * @return true, если результат операции выражается через сумму, количество,
+ * экстремумы и моменты
+ */
+bool isGroupable(OperationId op) { return operationInfo(op).groupable; }
+
+/*
+ * @brief Проверить, может ли операция вычисляться по группам
+ * @param op_name ключ операции
+ * @return true, если результат операции выражается через сумму, количество,
+ * экстремумы и моменты
+ */
+bool isGroupable(const string &op_name) {
+  return isGroupable(resolveOperation(op_name));
+}
+
+/*
+ * @brief Получить числовые результаты операции для каждой группы: функция
+ * завершения выбирается один раз для всех групп
+ * @param op номер операции
+ * @param partial объединенный частичный результат с таблицей групп
+ * @param params параметры операции
+ * @return результаты в порядке partial.groups.keys
+ */
+vector<float> finalizeGroups(OperationId op, const PartialResult &partial,
+                             const Params &params) {
+  NumericFinalize finalize = numericFinalize(op);
+  vector<float> results;
+  results.reserve(partial.groups.states.size());
 
-  return (*func)(arg);
+  PartialResult group;
+  group.type = NUMERIC;
+  for (const Moments &state : partial.groups.states) {
+    group.sum = state.sum;
+    group.count = state.count;
+    group.moments = state;
+    results.push_back(finalize(group, params));
+  }
+  return results;
 }
 
 /*
- * @brief Вызвать операцию из словаря операций
- * @param op_name указатель на ключ операции
- * @param arg входной параметр вызываемой операции
- * @return результат работы вызываемой функции
+ * @brief Получить числовые результаты операции для каждой группы
+ * @param op_name ключ операции
+ * @param partial объединенный частичный результат с таблицей групп
+ * @param params параметры операции
+ * @return результаты в порядке partial.groups.keys
  */
-string callOperation(const string &op_name, vector<string> arg) {
-  auto map_elem = operation_map.find(op_name);
-  if (map_elem == operation_map.end())
+vector<float> finalizeGroups(const string &op_name,
+                             const PartialResult &partial,
+                             const Params &params) {
+  return finalizeGroups(resolveOperation(op_name), partial, params);
+}
+
+/*
+ * @brief Проверить, является ли операция преобразованием столбца (в том
+ * числе оконной операцией)
+ * @param op номер операции
+ * @return true, если операция создает производный столбец
+ */
+bool isTransform(OperationId op) {
+  const OperationInfo &info = operationInfo(op);
+  return info.transform != nullptr or info.window != nullptr;
+}
+
+/*
+ * @brief Проверить, является ли операция преобразованием столбца
+ * @param op_name ключ операции
+ * @return true, если операция создает производный столбец
+ */
+bool isTransform(const string &op_name) {
+  return isTransform(resolveOperation(op_name));
+}
+
+/*
+ * @brief Вызвать преобразование столбца из таблицы операций
+ * @param op номер операции
+ * @param source исходный столбец
+ * @param params параметры операции
+ * @return производный столбец
+ */
+StringColumn callTransform(OperationId op, const StringColumn &source,
+                           const Params &params) {
+  if (op >= OP_UNKNOWN)
     throw runtime_error("Operation not found");
+  TransformCall func = operationInfo(op).transform;
+  if (!func)
+    throw runtime_error("Invalid operation type");
+  return func(source, params);
+}
 
-  auto *func = get_if<function<string(vector<string>)>>(&map_elem->second);
+/*
+ * @brief Проверить, является ли операция оконной: она создает производный
+ * числовой столбец из числового столбца
+ * @param op номер операции
+ * @return true для оконной операции
+ */
+bool isWindow(OperationId op) { return operationInfo(op).window != nullptr; }
+
+/*
+ * @brief Вызвать оконную операцию из таблицы операций
+ * @param op номер операции
+ * @param source исходный числовой столбец
+ * @param params параметры операции
+ * @return производный числовой столбец
+ */
+NumericColumn callWindow(OperationId op, const NumericColumn &source,
+                         const Params &params) {
+  if (op >= OP_UNKNOWN)
+    throw runtime_error("Operation not found");
+  WindowCall func = operationInfo(op).window;
   if (!func)
-    throw std::runtime_error("Invalid operation type");
+    throw runtime_error("Invalid operation type");
+  return func(source, params);
+}
+
+/*
+ * @brief Проверить, является ли операция соединением таблиц: ее результат -
+ * таблица, которую обрабатывают операции с параметром table
+ * @param op номер операции
+ * @return true для соединения
+ */
+bool isJoin(OperationId op) { return op == OP_JOIN; }
+
+/*
+ * @brief Проверить, является ли операция отбором строк
+ * @param op номер операции
+ * @return true, если операция создает маску выбранных строк
+ */
+bool isFilter(OperationId op) { return operationInfo(op).filter != nullptr; }
 
-  return (*func)(arg);
+/*
+ * @brief Проверить, является ли операция отбором строк
+ * @param op_name ключ операции
+ * @return true, если операция создает маску выбранных строк
+ */
+bool isFilter(const string &op_name) {
+  return isFilter(resolveOperation(op_name));
+}
+
+/*
+ * @brief Вызвать отбор строк из таблицы операций
+ * @param op номер операции
+ * @param source таблица
+ * @param column номер столбца условия
+ * @param params параметры операции
+ * @return маска выбранных строк таблицы
+ */
+Bitmap callFilter(OperationId op, table::Table &source, int column,
+                  const Params &params) {
+  if (op >= OP_UNKNOWN)
+    throw runtime_error("Operation not found");
+  FilterCall func = operationInfo(op).filter;
+  if (!func)
+    throw runtime_error("Invalid operation type");
+  return func(source, column, params);
 }
 
 /**
- * @brief Вычисляет сумму элементов числового вектора
- * @param source Входной вектор числовых данных
+ * @brief Вычисляет сумму присутствующих элементов числовых данных
+ * @param source Представление числовых данных
  * @return Сумма всех элементов
  */
-float sum(vector<float> source) {
-  float sum = 0;
-  for (float num : source) {
-    sum += num;
-  }
-  return sum;
+float sum(NumericView source) {
+  return maskedSum(source.values, source.validity, source.length);
 }
 
 /**
- * @brief Вычисляет среднее арифметическое элементов числового вектора
- * @param source Входной вектор числовых данных
+ * @brief Вычисляет среднее арифметическое присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
  * @return Среднее значение элементов
  */
-float average(vector<float> source) {
-  float sum = 0;
-  for (float num : source) {
-    sum += num;
+float average(NumericView source) {
+  return maskedSum(source.values, source.validity, source.length) /
+         maskedCount(source.validity, source.length);
+}
+
+/**
+ * @brief Объединяет присутствующие строки в одну строку
+ * @param source Представление строковых данных
+ * @return Результирующая объединенная строка
+ */
+string concatinate(StringView source) {
+  // размер результата вычисляется заранее, и строка выделяется один раз
+  size_t size = 0;
+  for (size_t i = 0; i < source.length; i++) {
+    size += isPresent(source.validity, i) * source.values[i].size();
+  }
+
+  string result;
+  result.reserve(size);
+  for (size_t i = 0; i < source.length; i++) {
+    if (isPresent(source.validity, i))
+      result.append(source.values[i]);
+  }
+  return result;
+}
+
+/**
+ * @brief Оценивает количество уникальных присутствующих строк по скетчу
+ * HyperLogLog (фиксированная память, ошибка около 1.6%)
+ * @param source Представление строковых данных
+ * @return Оценка количества уникальных строк
+ */
+string countDistinctApprox(StringView source) {
+  StateNeeds needs = needsOf(OP_COUNT_DISTINCT_APPROX, Params());
+  return finalizeString(OP_COUNT_DISTINCT_APPROX, partialOf(source, needs));
+}
+
+/**
+ * @brief Подсчитывает уникальные присутствующие строки точно
+ * @param source Представление строковых данных
+ * @return Количество уникальных строк
+ */
+string countDistinct(StringView source) {
+  StateNeeds needs = needsOf(OP_COUNT_DISTINCT, Params());
+  return finalizeString(OP_COUNT_DISTINCT, partialOf(source, needs));
+}
+
+/*
+ * @brief Выполнить числовую операцию с параметрами по умолчанию
+ * @param op номер операции
+ * @param source представление данных
+ * @return результат операции
+ */
+float evaluateDefault(OperationId op, NumericView source) {
+  return finalizeNumeric(op, partialOf(source, needsOf(op, Params())));
+}
+
+/**
+ * @brief Находит минимум присутствующих элементов числовых данных
+ * @param source Представление числовых данных
+ * @return Минимальное значение (NaN для пустых данных)
+ */
+float minimum(NumericView source) {
+  return evaluateDefault(OP_MIN, source);
+}
+
+/**
+ * @brief Находит максимум присутствующих элементов числовых данных
+ * @param source Представление числовых данных
+ * @return Максимальное значение (NaN для пустых данных)
+ */
+float maximum(NumericView source) {
+  return evaluateDefault(OP_MAX, source);
+}
+
+/**
+ * @brief Подсчитывает присутствующие элементы числовых данных
+ * @param source Представление числовых данных
+ * @return Количество элементов
+ */
+float countPresent(NumericView source) {
+  return maskedCount(source.validity, source.length);
+}
+
+/**
+ * @brief Вычисляет выборочную дисперсию присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
+ * @return Дисперсия (NaN, если элементов меньше двух)
+ */
+float variance(NumericView source) {
+  return evaluateDefault(OP_VARIANCE, source);
+}
+
+/**
+ * @brief Вычисляет выборочное стандартное отклонение присутствующих элементов
+ * числовых данных
+ * @param source Представление числовых данных
+ * @return Стандартное отклонение (NaN, если элементов меньше двух)
+ */
+float stddev(NumericView source) {
+  return evaluateDefault(OP_STDDEV, source);
+}
+
+/**
+ * @brief Вычисляет коэффициент асимметрии присутствующих элементов числовых
+ * данных
+ * @param source Представление числовых данных
+ * @return Асимметрия (NaN для постоянных или пустых данных)
+ */
+float skewness(NumericView source) {
+  return evaluateDefault(OP_SKEWNESS, source);
+}
+
+/**
+ * @brief Находит медиану присутствующих элементов числовых данных по скетчу
+ * квантилей
+ * @param source Представление числовых данных
+ * @return Медиана (NaN для пустых данных)
+ */
+float median(NumericView source) { return evaluateDefault(OP_MEDIAN, source); }
+
+/**
+ * @brief Находит 95-й процентиль присутствующих элементов числовых данных по
+ * скетчу квантилей
+ * @param source Представление числовых данных
+ * @return Процентиль (NaN для пустых данных)
+ */
+float p95(NumericView source) { return evaluateDefault(OP_P95, source); }
+
+/**
+ * @brief Находит 99-й процентиль присутствующих элементов числовых данных по
+ * скетчу квантилей
+ * @param source Представление числовых данных
+ * @return Процентиль (NaN для пустых данных)
+ */
+float p99(NumericView source) { return evaluateDefault(OP_P99, source); }
+
+/**
+ * @brief Находит квантиль присутствующих элементов числовых данных по скетчу
+ * квантилей (уровень задается параметром q, по умолчанию 0.5)
+ * @param source Представление числовых данных
+ * @return Квантиль (NaN для пустых данных)
+ */
+float quantile(NumericView source) {
+  return evaluateDefault(OP_QUANTILE, source);
+}
+
+/*
+ * @brief Найти все непересекающиеся вхождения подстроки: memchr ищет первый
+ * символ образца (векторизован в стандартной библиотеке), memcmp проверяет
+ * остаток
+ * @param source строка
+ * @param find непустая подстрока
+ * @param positions позиции вхождений (дописываются в конец)
+ */
+void findAll(const string &source, const string &find,
+             vector<size_t> &positions) {
+  const char *begin = source.data();
+  const char *end = begin + source.size();
+  const char *cursor = begin;
+  size_t length = find.size();
+
+  while (size_t(end - cursor) >= length) {
+    const void *found =
+        std::memchr(cursor, find[0], size_t(end - cursor) - length + 1);
+    if (!found)
+      break;
+
+    cursor = static_cast<const char *>(found);
+    if (std::memcmp(cursor + 1, find.data() + 1, length - 1) == 0) {
+      positions.push_back(cursor - begin);
+      cursor += length;
+    } else {
+      cursor++;
+    }
   }
-  return sum / source.size();
+}
+
+/*
+ * @brief Записать строку с заменами в буфер точного размера копированием
+ * частей
+ * @param source строка
+ * @param find подстрока
+ * @param replace строка замены
+ * @param positions позиции вхождений find в source
+ * @param count количество вхождений
+ * @param out буфер результата
+ */
+void replaceAt(const string &source, const string &find,
+               const string &replace, const size_t *positions, size_t count,
+               char *out) {
+  size_t from = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    std::memcpy(out, source.data() + from, positions[i] - from);
+    out += positions[i] - from;
+    std::memcpy(out, replace.data(), replace.size());
+    out += replace.size();
+    from = positions[i] + find.size();
+  }
+  std::memcpy(out, source.data() + from, source.size() - from);
 }
 
 /**
- * @brief Объединяет строки из вектора в одну строку
+ * @brief Выполняет поиск и замену в векторе строк
  * @param source Входной вектор строк
- * @return Результирующая объединенная строка
+ * @param find Строка для поиска
+ * @param replace Строка для замены
+ * @return Вектор с выполненными заменами
  */
-string concatinate(vector<string> source) {
-  string result = "";
-  for (string str : source) {
-    result += str;
+vector<string> findReplace(const vector<string> &source, const string &find,
+                           const string &replace) {
+  if (find.empty())
+    return source;
+
+  // первый проход собирает вхождения всех строк в один буфер позиций со
+  // смещениями по строкам, второй выделяет каждую строку результата один
+  // раз точного размера
+  vector<size_t> positions;
+  vector<size_t> offsets(source.size() + 1, 0);
+  for (size_t i = 0; i < source.size(); i++) {
+    findAll(source[i], find, positions);
+    offsets[i + 1] = positions.size();
+  }
+
+  vector<string> result(source.size());
+  for (size_t i = 0; i < source.size(); i++) {
+    size_t count = offsets[i + 1] - offsets[i];
+    if (count == 0) {
+      result[i] = source[i];
+      continue;
+    }
+    result[i].resize(source[i].size() + count * replace.size() -
+                     count * find.size());
+    replaceAt(source[i], find, replace, positions.data() + offsets[i], count,
+              &result[i][0]);
   }
   return result;
 }
+
+/**
+ * @brief Выполняет поиск и замену в строковом столбце (параметры find и
+ * replace)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец того же размера и способа хранения
+ */
+StringColumn findReplaceColumn(const StringColumn &source,
+                               const Params &params) {
+  auto find = params.find(PARAM_FIND);
+  auto replace = params.find(PARAM_REPLACE);
+  if (find == params.end() or find->second.empty())
+    return source;
+
+  // строки читаются по ссылке, и каждая строка результата выделяется один
+  // раз; столбец без замен план не вычисляет, а передает входной столбец
+  // (keepsColumn)
+  StringColumn result;
+  result.length = source.length;
+  result.layout = source.layout;
+  result.rows = source.rows;
+  result.validity = source.validity;
+  result.values = findReplace(source.values, find->second,
+                              replace == params.end() ? "" : replace->second);
+  return result;
+}
+
+/**
+ * @brief Отбирает строки таблицы по условию на столбец (параметры op и
+ * value). Числовой столбец сравнивается с числом, иначе значения
+ * сравниваются как строки
+ * @param source Таблица
+ * @param column Номер столбца условия
+ * @param params Параметры операции
+ * @return Маска выбранных строк таблицы
+ */
+Bitmap filterRows(table::Table &source, int column, const Params &params) {
+  CompareOp op = EQUAL;
+  auto op_param = params.find(PARAM_OP);
+  if (op_param != params.end() and !parseCompare(op_param->second, op))
+    throw runtime_error("Unknown comparison " + op_param->second);
+
+  auto value_param = params.find(PARAM_VALUE);
+  string value = value_param == params.end() ? "" : value_param->second;
+
+  ColumnType type = table::getTypeOfColumn(source, column);
+  if (type == UNKNOWN)
+    return createBitmap(source.rows.size());
+
+  if (type == NUMERIC) {
+    char *end = nullptr;
+    float number = std::strtof(value.c_str(), &end);
+    if (!value.empty() and *end == '\0')
+      return compareColumn(table::numericColumn(source, column), op, number);
+  }
+  return compareColumn(table::stringColumn(source, column), op, value);
+}
+
+/*
+ * @brief Получить размер окна из параметра window: параметр проверяется при
+ * загрузке (paramError), поэтому здесь значение только приводится к
+ * диапазону от 1 до MAX_WINDOW
+ * @param params параметры операции
+ * @return размер окна в строках
+ */
+size_t windowParam(const Params &params) {
+  return countParam(params, PARAM_WINDOW, 1, 1, MAX_WINDOW);
+}
+
+/**
+ * @brief Вычисляет скользящую сумму по окну из window строк (параметр
+ * window)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn rollingSumColumn(const NumericColumn &source,
+                               const Params &params) {
+  return rollingSum(source, windowParam(params));
+}
+
+/**
+ * @brief Вычисляет скользящее среднее по окну из window строк (параметр
+ * window)
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn rollingAverageColumn(const NumericColumn &source,
+                                   const Params &params) {
+  return rollingAverage(source, windowParam(params));
+}
+
+/**
+ * @brief Вычисляет накопленную сумму от первой строки
+ * @param source Исходный столбец
+ * @param params Параметры операции
+ * @return Производный столбец, выровненный по строкам исходного
+ */
+NumericColumn cumulativeSumColumn(const NumericColumn &source,
+                                  const Params &) {
+  return cumulativeSum(source);
+}
@@ -2,7 +2,9 @@
 #include "../include/graph.h"
 #include "../include/operations.h"
 #include "../libs/Tiny_Yaml/yaml/yaml.hpp"
+#include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
 #include <map>
@@ -10,6 +12,10 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 using std::string;
@@ -25,6 +31,21 @@ const string SOURCE = "source";         // поле файлов csv для об
 const string FUNC = "func";             // поле - название функции
 const string COLUMN = "column";         // поле - номер столбца
 const string PATH = "path";             // поле - путь к файлу csv для обработки
+const string TABLES = "tables";         // поле именованных таблиц
+const string DEPENDS_ON = "depends_on"; // поле зависимостей операции
+
+/*
+ * @brief Получить значение скаляра без одной пары окружающих кавычек:
+ * `expr: "col[0] * 2"` и `op: ">"` читаются как текст внутри кавычек
+ * @param value значение поля в том виде, в котором оно записано в файле
+ * @return значение поля
+ */
+string scalar(std::string_view value) {
+  if (value.size() >= 2 and (value.front() == '"' or value.front() == '\'') and
+      value.back() == value.front())
+    value = value.substr(1, value.size() - 2);
+  return string(value);
+}
 
 /*
  * @brief Загрузить конфигурацию
@@ -57,7 +78,7 @@ std::vector<std::string> getIds() {
   }
 
   try {
-    TINY_YAML::Node &operationsNode = (*root)[OPERATIONS];
+    const TINY_YAML::Node &operationsNode = (*root)[OPERATIONS];
     ids = operationsNode.getChildIds();
 
   } catch (const std::exception &e) {
@@ -87,7 +108,7 @@ map<string, string> checkFunctions() {
     for (string id : ids) {
       func = getFuncById(id);
 
-      if (operation_map.count(func) == 0) {
+      if (resolveOperation(func) == OP_UNKNOWN) {
         unknown.insert({id, func});
       }
     }
@@ -110,14 +131,14 @@ int getColumnById(string id) {
   }
 
   try {
-    TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
+    const TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
 
     if (!operation.hasChild(COLUMN)) {
       std::cerr << "Operation " << id << " has no column defined" << std::endl;
       return -1;
     }
 
-    std::string columnStr = operation[COLUMN].getData<std::string>();
+    std::string columnStr = scalar(operation[COLUMN].value());
     return std::stoi(columnStr);
 
   } catch (const std::exception &e) {
@@ -139,14 +160,14 @@ string getFuncById(string id) {
   }
 
   try {
-    TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
+    const TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
 
     if (!operation.hasChild(FUNC)) {
       std::cerr << "Operation " << id << " has no function defined"
                 << std::endl;
       return "";
     }
-    return operation[FUNC].getData<std::string>();
+    return scalar(operation[FUNC].value());
 
   } catch (const std::exception &e) {
     std::cerr << "Error getting function for operation " << id << ": "
@@ -155,6 +176,58 @@ string getFuncById(string id) {
   }
 }
 
+/*
+ * @brief Получить дополнительные параметры операции (все поля, кроме func и
+ * column)
+ * @param id уникальный идентификатор операции
+ * @return словарь параметр -> значение
+ */
+map<string, string> getParamsById(string id) {
+  map<string, string> params;
+
+  if (!root) {
+    std::cerr << "Config not loaded" << std::endl;
+    return params;
+  }
+
+  try {
+    const TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
+
+    operation.forEachChild([&](const TINY_YAML::Node &field) {
+      if (field.getID() != FUNC and field.getID() != COLUMN and
+          field.getID() != DEPENDS_ON)
+        params[string(field.getID())] = scalar(field.value());
+    });
+  } catch (const std::exception &e) {
+    std::cerr << "Error getting parameters for operation " << id << ": "
+              << e.what() << std::endl;
+  }
+  return params;
+}
+
+/*
+ * @brief Получить значение поля column без преобразования в число (номер
+ * столбца или id операции-преобразования)
+ * @param id уникальный идентификатор операции
+ * @return значение поля или пустая строка
+ */
+string getColumnFieldById(string id) {
+  if (!root) {
+    std::cerr << "Config not loaded" << std::endl;
+    return "";
+  }
+
+  try {
+    const TINY_YAML::Node &operation = (*root)[OPERATIONS][id];
+    if (operation.hasChild(COLUMN))
+      return scalar(operation[COLUMN].value());
+  } catch (const std::exception &e) {
+    std::cerr << "Error getting column for operation " << id << ": " << e.what()
+              << std::endl;
+  }
+  return "";
+}
+
 /*
  * @brief Получить путь к файлу csv для обработки
  * @return путь к файлу
@@ -166,8 +239,8 @@ string getCSV() {
   }
 
   try {
-    TINY_YAML::Node &data = (*root)[PATH];
-    return data.getData<string>();
+    const TINY_YAML::Node &data = (*root)[PATH];
+    return scalar(data.value());
 
   } catch (const std::exception &e) {
     std::cerr << "Error getting path to data" << std::endl;
@@ -175,19 +248,103 @@ string getCSV() {
   }
 }
 
+/*
+ * @brief Получить именованные таблицы из раздела tables
+ * @return имя таблицы -> путь к файлу csv (пустой словарь, если раздела нет)
+ */
+map<string, string> getTables() {
+  map<string, string> tables;
+
+  if (!root) {
+    std::cerr << "Config not loaded" << std::endl;
+    return tables;
+  }
+  if (!root->hasRoot(TABLES))
+    return tables;
+
+  try {
+    const TINY_YAML::Node &section = (*root)[TABLES];
+    section.forEachChild([&](const TINY_YAML::Node &table) {
+      tables[string(table.getID())] = scalar(table.value());
+    });
+  } catch (const std::exception &e) {
+    std::cerr << "Error getting tables: " << e.what() << std::endl;
+  }
+  return tables;
+}
+
+/*
+ * @brief Получить зависимости операций из поля depends_on (список `[a, b]`,
+ * одно значение или блочный список `- a`)
+ * @return id операции -> id операций, от которых она зависит (только
+ * операции, в которых поле задано; пустой словарь, если поле не задано нигде)
+ */
+map<string, vector<string>> getDependencies() {
+  map<string, vector<string>> depends;
+
+  if (!root) {
+    std::cerr << "Config not loaded" << std::endl;
+    return depends;
+  }
+
+  (*root)[OPERATIONS].forEachChild([&](const TINY_YAML::Node &operation) {
+    const TINY_YAML::Node *field = operation.find(DEPENDS_ON);
+    if (!field)
+      return;
+
+    vector<string> &ids = depends[string(operation.getID())];
+    for (std::string_view item : field->items())
+      ids.push_back(scalar(item));
+
+    string value(field->value());
+    if (!value.empty() and value.front() == '[' and value.back() == ']')
+      value = value.substr(1, value.size() - 2);
+    for (string id : split(value, ",")) {
+      size_t first = id.find_first_not_of(" \t\"'");
+      if (first != string::npos)
+        ids.push_back(id.substr(first, id.find_last_not_of(" \t\"'") -
+                                           first + 1));
+    }
+  });
+  return depends;
+}
+
 }; // namespace config
 
 // ======================================================================
 
 namespace table {
 
-vector<vector<string>> table;
+Table current;                      // таблица операций графа
+map<string, Table> named;            // именованные таблицы конфигурации
+std::atomic<size_t> next_version(1); // версия данных следующего чтения
+
+/*
+ * @brief Сбросить кэши столбцов после изменения строк и обновить версию
+ * данных
+ * @param target таблица
+ */
+void invalidate(Table &target) {
+  target.column_types.clear();
+  target.numeric_columns.clear();
+  target.string_columns.clear();
+  target.derived_columns.clear();
+  target.version = next_version++;
+}
 
 /**
  * @brief Инициализировать объкт документа
  * @param path путь к документу
  */
-void read(string path, char delimiter) {
+void read(string path, char delimiter) { read(current, path, delimiter); }
+
+/**
+ * @brief Считать файл csv в отдельную таблицу
+ * @param target таблица для заполнения
+ * @param path путь к документу
+ * @param delimiter разделитель полей
+ */
+void read(Table &target, string path, char delimiter) {
   std::ifstream file(path);
   string buffer;
   vector<string> row;
@@ -205,16 +362,59 @@ void read(string path, char delimiter) {
       row.push_back(buffer);
     }
 
-    table.push_back(row);
+    target.rows.push_back(row);
     row.clear();
   }
   file.close();
+  invalidate(target);
 }
 
 /**
- * @brief Очистить таблицу
+ * @brief Заполнить таблицу готовыми строками (например, результатом
+ * соединения): кэши столбцов сбрасываются, а версия данных обновляется
+ * @param target таблица для заполнения
+ * @param rows строки таблицы
  */
-void clear() { table.clear(); }
+void assign(Table &target, vector<vector<string>> rows) {
+  target.rows = std::move(rows);
+  invalidate(target);
+}
+
+/**
+ * @brief Считать файл csv в именованную таблицу конфигурации
+ * @param name имя таблицы
+ * @param path путь к документу
+ * @param delimiter разделитель полей
+ */
+void readNamed(const string &name, string path, char delimiter) {
+  Table &target = named[name];
+  target.rows.clear();
+  read(target, path, delimiter);
+}
+
+/**
+ * @brief Получить именованную таблицу конфигурации
+ * @param name имя таблицы
+ * @return указатель на таблицу или nullptr, если таблицы нет
+ */
+Table *namedTable(const string &name) {
+  auto found = named.find(name);
+  return found == named.end() ? nullptr : &found->second;
+}
+
+/**
+ * @brief Очистить таблицу и именованные таблицы
+ */
+void clear() {
+  current = Table();
+  named.clear();
+}
+
+/**
+ * @brief Получить текущую таблицу, с которой работают операции графа
+ * @return ссылка на таблицу
+ */
+Table &currentTable() { return current; }
 
 /**
  * @brief Определить, является ли строка числом
@@ -233,6 +433,16 @@ bool isNumneric(string &s) {
   }
 }
 
+/*
+ * @brief Проверить, отсутствует ли значение в ячейке
+ * @param row строка таблицы
+ * @param column номер столбца
+ * @return true, если строка короче столбца или поле пустое
+ */
+bool isMissing(const vector<string> &row, int column) {
+  return static_cast<size_t>(column) >= row.size() or row[column].empty();
+}
+
 /**
  * @brief Определяет тип данных столбца
  * @param reader указатель на объкт обработки файла csv
@@ -240,55 +450,258 @@ bool isNumneric(string &s) {
  * @return Тип данных столбца
  */
 ColumnType getTypeOfColumn(int column) {
+  return getTypeOfColumn(current, column);
+}
+
+/**
+ * @brief Определяет тип данных столбца отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return Тип данных столбца
+ */
+ColumnType getTypeOfColumn(Table &source, int column) {
+  auto cached = source.column_types.find(column);
+  if (cached != source.column_types.end())
+    return cached->second;
+
   bool has_numbers = false;
   bool has_strings = false;
 
-  for (vector<string> &row : table) {
+  // пропуски не влияют на тип столбца
+  for (vector<string> &row : source.rows) {
+    if (isMissing(row, column))
+      continue;
+
+    if (isNumneric(row[column])) {
+      has_numbers = true;
+    } else {
+      has_strings = true;
+      break;
+    }
+  }
+
+  ColumnType type = UNKNOWN;
+  if (has_strings)
+    type = STRING;
+  else if (has_numbers)
+    type = NUMERIC;
 
-    if (column < row.size()) {
+  source.column_types[column] = type;
+  return type;
+}
 
-      string field = row[column];
-      if (isNumneric(row[column])) {
-        has_numbers = true;
-      } else {
-        has_strings = true;
-      }
+/**
+ * @brief Получить числовой столбец, выровненный по строкам таблицы
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится до table::clear)
+ */
+const NumericColumn &numericColumn(int column) {
+  return numericColumn(current, column);
+}
+
+/**
+ * @brief Получить числовой столбец отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится вместе с таблицей)
+ */
+const NumericColumn &numericColumn(Table &source, int column) {
+  auto cached = source.numeric_columns.find(column);
+  if (cached != source.numeric_columns.end())
+    return cached->second;
+
+  vector<vector<string>> &rows = source.rows;
+  vector<float> values(rows.size(), 0);
+  Bitmap validity = createBitmap(rows.size());
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (isMissing(rows[i], column))
+      continue;
+
+    const string &field = rows[i][column];
+    char *end = nullptr;
+    float value = std::strtof(field.c_str(), &end);
+
+    // нечисловые поля считаются пропусками
+    if (end == field.c_str() + field.size()) {
+      values[i] = value;
+      setBit(validity, i);
     }
-    if (has_numbers and has_strings == false)
-      return NUMERIC;
-    if (has_strings)
-      return STRING;
   }
 
-  return UNKNOWN;
+  return source.numeric_columns[column] =
+             makeNumericColumn(std::move(values), std::move(validity));
+}
+
+/**
+ * @brief Получить строковый столбец, выровненный по строкам таблицы
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится до table::clear)
+ */
+const StringColumn &stringColumn(int column) {
+  return stringColumn(current, column);
+}
+
+/**
+ * @brief Получить строковый столбец отдельной таблицы
+ * @param source таблица
+ * @param column номер столбца
+ * @return столбец с маской валидности (хранится вместе с таблицей)
+ */
+const StringColumn &stringColumn(Table &source, int column) {
+  return *sharedStringColumn(source, column);
 }
 
 /*
- * @brief Считать столбец чисел из файла
+ * @brief Записать значения числового столбца в текст
+ * @param column числовой столбец
+ * @return строковый столбец с той же маской валидности
+ */
+StringColumn formatColumn(const NumericColumn &column) {
+  vector<string> values(column.length);
+  Bitmap validity = createBitmap(column.length);
+  const uint64_t *present = validityWords(column);
+
+  for (size_t i = 0; i < column.values.size(); i++) {
+    if (!isPresent(present, i))
+      continue;
+    size_t row = column.layout == SPARSE ? column.rows[i] : i;
+    std::ostringstream text;
+    text << column.values[i];
+    values[row] = text.str();
+    setBit(validity, row);
+  }
+  return makeStringColumn(std::move(values), std::move(validity));
+}
+
+/**
+ * @brief Получить строковый столбец отдельной таблицы во владение: буфер не
+ * копируется и остается доступным после очистки таблицы
+ * @param source таблица
  * @param column номер столбца
- * @return вектор чисел столбца
+ * @return указатель на столбец со счетчиком ссылок
+ */
+shared_ptr<const StringColumn> sharedStringColumn(Table &source, int column) {
+  auto cached = source.string_columns.find(column);
+  if (cached != source.string_columns.end())
+    return cached->second;
+
+  // производный числовой столбец записывается в текст по значениям
+  auto numeric = source.numeric_columns.find(column);
+  if (column >= DERIVED_COLUMN and numeric != source.numeric_columns.end())
+    return source.string_columns[column] =
+               std::make_shared<const StringColumn>(
+                   formatColumn(numeric->second));
+
+  vector<vector<string>> &rows = source.rows;
+  vector<string> values(rows.size());
+  Bitmap validity = createBitmap(rows.size());
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (isMissing(rows[i], column))
+      continue;
+
+    values[i] = rows[i][column];
+    setBit(validity, i);
+  }
+
+  return source.string_columns[column] = std::make_shared<const StringColumn>(
+             makeStringColumn(std::move(values), std::move(validity)));
+}
+
+/**
+ * @brief Добавить производный столбец в кэши таблицы: тип определяется по
+ * значениям, числовой столбец строится сразу, если все значения - числа
+ * @param source таблица
+ * @param column номер производного столбца (от DERIVED_COLUMN)
+ * @param values значения, выровненные по строкам таблицы
+ */
+void addDerivedColumn(Table &source, int column, StringColumn values) {
+  const uint64_t *validity = validityWords(values);
+  bool has_numbers = false;
+  bool has_strings = false;
+
+  // пустые строки после замены считаются пропусками, как и пустые поля файла
+  for (size_t i = 0; i < values.values.size() and !has_strings; i++) {
+    if (!isPresent(validity, i) or values.values[i].empty())
+      continue;
+    if (isNumneric(values.values[i]))
+      has_numbers = true;
+    else
+      has_strings = true;
+  }
+
+  ColumnType type = has_strings ? STRING : has_numbers ? NUMERIC : UNKNOWN;
+  source.column_types[column] = type;
+
+  if (type == NUMERIC) {
+    vector<float> numbers(values.length, 0);
+    Bitmap present = createBitmap(values.length);
+
+    for (size_t i = 0; i < values.values.size(); i++) {
+      if (!isPresent(validity, i) or values.values[i].empty())
+        continue;
+      size_t row = values.layout == SPARSE ? values.rows[i] : i;
+      numbers[row] = std::strtof(values.values[i].c_str(), nullptr);
+      setBit(present, row);
+    }
+    source.numeric_columns[column] =
+        makeNumericColumn(std::move(numbers), std::move(present));
+  }
+
+  source.string_columns[column] =
+      std::make_shared<const StringColumn>(std::move(values));
+}
+
+/**
+ * @brief Добавить производный числовой столбец (например, значения
+ * выражения) в кэши таблицы. Строковый столбец строится при первом запросе
+ * @param source таблица
+ * @param column номер производного столбца (от DERIVED_COLUMN)
+ * @param values значения, выровненные по строкам таблицы
+ */
+void addDerivedColumn(Table &source, int column, NumericColumn values) {
+  source.column_types[column] =
+      presentCount(values) > 0 ? NUMERIC : UNKNOWN;
+  source.numeric_columns[column] = std::move(values);
+}
+
+/*
+ * @brief Считать присутствующие значения числового столбца
+ * @param column номер столбца
+ * @return вектор чисел столбца без пропусков
  */
 vector<float> readNumericColumn(int column) {
+  const NumericColumn &source = numericColumn(column);
   vector<float> values;
 
-  for (vector<string> &row : table) {
-    if (column < row.size())
-      values.push_back(stod(row[column]));
+  if (source.layout == SPARSE)
+    return source.values;
+
+  values.reserve(presentCount(source));
+  for (size_t i = 0; i < source.values.size(); i++) {
+    if (testBit(source.validity, i))
+      values.push_back(source.values[i]);
   }
   return values;
 }
 
 /*
- * @brief Считать столбец строк из файла
+ * @brief Считать присутствующие значения строкового столбца
  * @param column номер столбца
- * @return вектор чисел столбца
+ * @return вектор строк столбца без пропусков
  */
 vector<string> readStringColumn(int column) {
+  const StringColumn &source = stringColumn(column);
   vector<string> values;
 
-  for (vector<string> &row : table) {
-    if (column < row.size())
-      values.push_back(row[column]);
+  if (source.layout == SPARSE)
+    return source.values;
+
+  values.reserve(presentCount(source));
+  for (size_t i = 0; i < source.values.size(); i++) {
+    if (testBit(source.validity, i))
+      values.push_back(source.values[i]);
   }
   return values;
 }
@@ -409,8 +822,10 @@ void createGraphFromScheme(vector<string> scheme) {
 
   for (const string node : scheme) {
     id = split(node, "->");
-    atom = createNode(id[0]);
-    addNode(atom);
+    if (!alreadyInGraph(id[0])) {
+      atom = createNode(id[0]);
+      addNode(atom);
+    }
 
     for (size_t i = 1; i < id.size(); i++) {
       if (!alreadyInGraph(id[i])) {
@@ -434,8 +849,10 @@ void createGraphFromScheme(vector<string> scheme, vector<string> ids) {
 
   for (const string node : scheme) {
     indexes = split(node, "->");
-    atom = createNode(ids[std::stoi(indexes[0]) - 1]);
-    addNode(atom);
+    if (!alreadyInGraph(ids[std::stoi(indexes[0]) - 1])) {
+      atom = createNode(ids[std::stoi(indexes[0]) - 1]);
+      addNode(atom);
+    }
 
     for (size_t i = 1; i < indexes.size(); i++) {
       if (!alreadyInGraph(ids[std::stoi(indexes[i]) - 1])) {
@@ -447,3 +864,96 @@ void createGraphFromScheme(vector<string> scheme, vector<string> ids) {
     }
   }
 }
+
+/*
+ * @brief Проверить зависимости операций: все id существуют, операция не
+ * зависит от себя, и граф не содержит циклов
+ * @param ids id операций
+ * @param depends id операции -> id операций, от которых она зависит
+ * @return сообщения об ошибках (пустой вектор - ошибок нет)
+ */
+vector<string> checkDependencies(const vector<string> &ids,
+                                 const map<string, vector<string>> &depends) {
+  vector<string> errors;
+  std::unordered_map<string, size_t> index;
+  for (size_t i = 0; i < ids.size(); i++)
+    index[ids[i]] = i;
+
+  // связи от зависимости к операции и число входящих связей
+  vector<vector<size_t>> next(ids.size());
+  vector<size_t> waiting(ids.size(), 0);
+  for (const auto &[id, parents] : depends) {
+    auto node = index.find(id);
+    if (node == index.end()) {
+      errors.push_back(id + ": operation not found");
+      continue;
+    }
+    for (const string &parent : parents) {
+      auto from = index.find(parent);
+      if (from == index.end()) {
+        errors.push_back(id + ": unknown dependency " + parent);
+      } else if (from->second == node->second) {
+        errors.push_back(id + ": depends on itself");
+      } else {
+        next[from->second].push_back(node->second);
+        waiting[node->second]++;
+      }
+    }
+  }
+
+  // алгоритм Кана: операции, оставшиеся с входящими связями, лежат на цикле
+  // или зависят от него
+  vector<size_t> ready;
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (waiting[i] == 0)
+      ready.push_back(i);
+  }
+  while (!ready.empty()) {
+    size_t current = ready.back();
+    ready.pop_back();
+    for (size_t to : next[current]) {
+      if (--waiting[to] == 0)
+        ready.push_back(to);
+    }
+  }
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (waiting[i] > 0)
+      errors.push_back(ids[i] + ": dependency cycle");
+  }
+  return errors;
+}
+
+/**
+ * @brief Создать граф из всех операций конфигурации по их зависимостям за
+ * один проход: каждая зависимость становится связью от нее к операции
+ * @param ids id операций (порядок узлов в графе)
+ * @param depends id операции -> id операций, от которых она зависит
+ */
+void createGraphFromDependencies(const vector<string> &ids,
+                                 const map<string, vector<string>> &depends) {
+  std::unordered_map<string, Node *> nodes;
+  nodes.reserve(ids.size());
+
+  for (const string &id : ids) {
+    if (nodes.count(id))
+      continue;
+    Node *atom = createNode(id);
+    addNode(atom);
+    nodes[id] = atom;
+  }
+
+  for (const string &id : ids) {
+    auto parents = depends.find(id);
+    if (parents == depends.end())
+      continue;
+
+    // повторяющиеся зависимости дают одну связь
+    std::unordered_set<Node *> linked;
+    for (const string &parent : parents->second) {
+      auto from = nodes.find(parent);
+      if (from != nodes.end() and from->second != nodes[id] and
+          linked.insert(from->second).second)
+        link(from->second, nodes[id]);
+    }
+  }
+}
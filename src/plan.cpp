@@ -0,0 +1,715 @@
+#include "../include/plan.h"
+#include "../include/expr.h"
+#include "../include/filter.h"
+#include "../include/operations.h"
+#include "../include/parser.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace plan {
+
+vector<Task> compiled;        // скомпилированный план: операции по номерам
+map<string, int> compiled_of; // id операции -> номер в плане
+
+/*
+ * @brief Разрешить операции по конфигурации
+ * @param ids уникальные идентификаторы операций
+ * @return вектор операций
+ */
+vector<Task> collectTasks(const vector<string> &ids) {
+  vector<Task> tasks;
+  std::unordered_set<string> known(ids.begin(), ids.end());
+
+  for (const string &id : ids) {
+    Task task;
+    task.id = id;
+    task.func = config::getFuncById(id);
+    task.params = config::getParamsById(id);
+
+    auto table = task.params.find(PARAM_TABLE);
+    if (table != task.params.end())
+      task.table = table->second;
+
+    // выражение компилируется один раз при разборе конфигурации, а его
+    // значения вычисляются как производный столбец; операция с ошибкой в
+    // выражении не получает результата
+    auto expr = task.params.find(PARAM_EXPR);
+    if (expr != task.params.end()) {
+      string error;
+      if (!compileExpression(expr->second, task.expr, error)) {
+        task.error = "Error compiling expression: " + error;
+        std::cerr << "Error compiling expression for operation " << id
+                  << ": " << error << std::endl;
+      }
+      task.input = INPUT_EXPR + expr->second;
+      tasks.push_back(task);
+      continue;
+    }
+
+    // столбец задается номером, id узла из того же графа или INPUT_PARENTS
+    string field = config::getColumnFieldById(id);
+    if (field == INPUT_PARENTS or known.count(field))
+      task.input = field;
+    else if ((task.column = config::getColumnById(id)) < 0)
+      task.error = "Invalid column";
+
+    auto where = task.params.find(PARAM_WHERE);
+    if (where != task.params.end())
+      task.where = where->second;
+
+    auto group_by = task.params.find(PARAM_GROUP_BY);
+    if (group_by != task.params.end()) {
+      try {
+        task.group_by = std::stoi(group_by->second);
+      } catch (const std::exception &e) {
+        task.error = "Invalid group_by";
+        std::cerr << "Error getting group_by for operation " << id << ": "
+                  << e.what() << std::endl;
+      }
+    }
+    tasks.push_back(task);
+  }
+  resolveOperations(tasks);
+  return tasks;
+}
+
+/*
+ * @brief Скомпилировать операции конфигурации в плоский план один раз при
+ * загрузке: ключи функций, столбцы, параметры и выражения разбираются и
+ * проверяются здесь, а узлы графа затем читают только массив операций
+ * @param ids уникальные идентификаторы операций
+ * @return количество операций с ошибками
+ */
+size_t compile(const vector<string> &ids) {
+  compiled = collectTasks(ids);
+  compiled_of.clear();
+  for (size_t t = 0; t < compiled.size(); t++) {
+    compiled_of[compiled[t].id] = t;
+  }
+
+  // таблица операции - именованная таблица конфигурации или соединение
+  map<string, string> tables = config::getTables();
+  size_t errors = 0;
+  for (Task &task : compiled) {
+    if (task.error.empty() and task.op == OP_UNKNOWN)
+      task.error = "Unknown operation " + task.func;
+    if (task.error.empty())
+      task.error = paramError(task.op, task.params);
+    if (task.error.empty() and !task.table.empty() and
+        !tables.count(task.table)) {
+      auto join = compiled_of.find(task.table);
+      if (join == compiled_of.end() or !isJoin(compiled[join->second].op))
+        task.error = "Table " + task.table + " not found";
+    }
+    // правая таблица соединения - только именованная таблица конфигурации
+    if (task.error.empty() and isJoin(task.op)) {
+      auto right = task.params.find(PARAM_RIGHT);
+      auto right_column = task.params.find(PARAM_RIGHT_COLUMN);
+      if (right == task.params.end() or !tables.count(right->second)) {
+        task.error = "Right table not found";
+      } else if (right_column != task.params.end()) {
+        try {
+          std::stoi(right_column->second);
+        } catch (const std::exception &) {
+          task.error = "Invalid right_column";
+        }
+      }
+    }
+    // отбор строк задает операция filter того же плана
+    if (task.error.empty() and !task.where.empty()) {
+      auto filter = compiled_of.find(task.where);
+      if (filter == compiled_of.end() or
+          !isFilter(compiled[filter->second].op))
+        task.error = "Filter " + task.where + " not found";
+    }
+    if (task.error.empty() and task.group_by >= 0 and !isGroupable(task.op))
+      task.error = "Operation " + task.func + " can't be grouped";
+    // результаты предыдущих узлов (не производный столбец преобразования)
+    // нельзя сгруппировать или отобрать
+    auto input = compiled_of.find(task.input);
+    bool upstream = task.input == INPUT_PARENTS or
+                    (input != compiled_of.end() and
+                     !isTransform(compiled[input->second].op));
+    if (task.error.empty() and upstream and
+        (task.group_by >= 0 or !task.where.empty()))
+      task.error = "Operation " + task.func +
+                   " can't be grouped or filtered over upstream results";
+  }
+
+  // операция, читающая столбец, отбор или соединение операции с ошибкой,
+  // тоже не выполняется
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (Task &task : compiled) {
+      if (!task.error.empty())
+        continue;
+      for (const string &id : {task.input, task.where, task.table}) {
+        auto found = compiled_of.find(id);
+        if (found != compiled_of.end() and
+            !compiled[found->second].error.empty()) {
+          task.error = "Operation " + id + " has errors";
+          progress = true;
+          break;
+        }
+      }
+    }
+  }
+
+  for (const Task &task : compiled) {
+    if (!task.error.empty()) {
+      std::cerr << "Operation " << task.id << ": " << task.error << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+
+/*
+ * @brief Получить номер операции в скомпилированном плане
+ * @param id уникальный идентификатор операции
+ * @return номер или -1, если операции нет
+ */
+int taskIndex(const string &id) {
+  auto found = compiled_of.find(id);
+  return found == compiled_of.end() ? -1 : found->second;
+}
+
+/*
+ * @brief Получить операцию скомпилированного плана
+ * @param index номер операции
+ * @return указатель на операцию или nullptr, если номера нет
+ */
+const Task *compiledTask(int index) {
+  if (index < 0 or size_t(index) >= compiled.size())
+    return nullptr;
+  return &compiled[index];
+}
+
+/*
+ * @brief Получить операцию узла графа: номер операции находится по id один
+ * раз и запоминается в узле
+ * @param node узел графа
+ * @return указатель на операцию или nullptr, если операции нет
+ */
+const Task *taskOf(Node *node) {
+  if (node->task < 0)
+    node->task = taskIndex(node->id);
+  return compiledTask(node->task);
+}
+
+/*
+ * @brief Очистить скомпилированный план
+ */
+void clear() {
+  compiled.clear();
+  compiled_of.clear();
+}
+
+/*
+ * @brief Разрешить функции операций в номера таблицы операций: план и
+ * исполнитель вызывают функции по номеру, а не по ключу
+ * @param tasks операции
+ */
+void resolveOperations(vector<Task> &tasks) {
+  for (Task &task : tasks) {
+    task.op = resolveOperation(task.func);
+  }
+}
+
+/*
+ * @brief Сгруппировать операции по читаемому столбцу
+ * @param tasks операции
+ * @return группы в порядке первого появления столбца
+ */
+vector<ColumnGroup> groupByColumn(const vector<Task> &tasks) {
+  vector<ColumnGroup> groups;
+  map<std::pair<int, string>, size_t> group_of_column;
+
+  for (size_t t = 0; t < tasks.size(); t++) {
+    std::pair<int, string> column = {tasks[t].column, tasks[t].input};
+    auto found = group_of_column.find(column);
+
+    if (found == group_of_column.end()) {
+      found = group_of_column.insert({column, groups.size()}).first;
+      groups.push_back(ColumnGroup());
+      groups.back().column = column.first;
+      groups.back().input = column.second;
+    }
+
+    groups[found->second].tasks.push_back(t);
+  }
+  return groups;
+}
+
+/*
+ * @brief Сравнить ключи кэша
+ * @param other другой ключ
+ * @return true, если ключ меньше other
+ */
+bool CacheKey::operator<(const CacheKey &other) const {
+  if (version != other.version)
+    return version < other.version;
+  if (column != other.column)
+    return column < other.column;
+  return func < other.func;
+}
+
+/*
+ * @brief Получить ключ результата операции: функция и ее параметры
+ * @param task операция
+ * @return строка вида func(name=value,...)
+ */
+string taskKey(const Task &task) {
+  string key = task.func + "(";
+  for (const auto &param : task.params) {
+    key += param.first + "=" + param.second + ",";
+  }
+  return key + ")";
+}
+
+/*
+ * @brief Получить часть ключа состояния с параметрами гистограмм
+ * @param needs что вычисляется, кроме суммы и количества
+ * @return "/b" и параметры каждой гистограммы
+ */
+string histogramsKey(const StateNeeds &needs) {
+  string key;
+  for (const HistogramSpec &spec : needs.histograms) {
+    key += "/b" + std::to_string(spec.bins);
+    if (spec.fixed)
+      key += ":" + std::to_string(spec.min) + ":" + std::to_string(spec.max);
+  }
+  return key;
+}
+
+/*
+ * @brief Получить ключ общего состояния столбца
+ * @param input тип входных данных операций
+ * @param needs что вычисляется, кроме суммы и количества
+ * @return NUMERIC_STATE или STRING_STATE с описанием требований
+ */
+string stateKey(ColumnType input, const StateNeeds &needs) {
+  if (input != NUMERIC)
+    return STRING_STATE + "/t" + std::to_string(needs.text) + "/p" +
+           std::to_string(needs.stream) + "/d" +
+           std::to_string(needs.distinct) + "/s" +
+           std::to_string(needs.distinct_set) + "/o" +
+           std::to_string(needs.sort) + "/h" + std::to_string(needs.top_k) +
+           "," + std::to_string(needs.bottom_k);
+  return NUMERIC_STATE + "/m" + std::to_string(needs.moments) + "/k" +
+         std::to_string(needs.sketch) + "/v" + std::to_string(needs.values) +
+         "/o" + std::to_string(needs.sort) + "/h" +
+         std::to_string(needs.top_k) + "," + std::to_string(needs.bottom_k) +
+         histogramsKey(needs);
+}
+
+/*
+ * @brief Маска отбора строк и ключ, который отличает ее в кэше
+ */
+struct Selection {
+  string key;  // отбор с параметрами и столбец условия
+  Bitmap rows; // выбранные строки таблицы
+};
+
+/*
+ * @brief Вычислить частичный результат над выбранными строками столбца:
+ * маска отбора заменяет маску валидности, и ядра пропускают невыбранные
+ * значения так же, как пропуски
+ * @param column столбец
+ * @param selection отбор строк или nullptr
+ * @param needs что вычислить, кроме суммы и количества
+ * @return частичный результат
+ */
+template <typename Column, typename View>
+PartialResult selectedState(const Column &column, const Selection *selection,
+                            const StateNeeds &needs) {
+  if (!selection)
+    return partialOf(View(column), needs);
+
+  // представление столбца сохраняет номера строк разреженного столбца
+  Bitmap mask = selectedMask(column, selection->rows);
+  View view(column);
+  view.validity = mask.words.data();
+  return partialOf(view, needs);
+}
+
+/*
+ * @brief Вычислить общее состояние столбца для операций одного типа входа
+ * @param source таблица
+ * @param column номер столбца
+ * @param input тип входных данных операций
+ * @param needs что вычислить, кроме суммы и количества
+ * @param selection отбор строк или nullptr
+ * @return частичный результат с типом столбца
+ */
+PartialResult columnState(table::Table &source, int column, ColumnType input,
+                          const StateNeeds &needs,
+                          const Selection *selection) {
+  PartialResult state;
+  ColumnType type = table::getTypeOfColumn(source, column);
+
+  // числовой столбец читается как числа: сортировка, top_k и гистограммы
+  // не строят его текстовую копию
+  if (input == NUMERIC and type == NUMERIC)
+    state = selectedState<NumericColumn, NumericView>(
+        table::numericColumn(source, column), selection, needs);
+  // строковые операции принимают любые присутствующие значения
+  else if (input == STRING and type != UNKNOWN) {
+    // для потоковой записи передается общий буфер столбца, а не копия строк
+    StateNeeds pass = needs;
+    pass.stream = false;
+    // сортировка и top_k числового столбца вычисляются в числовом состоянии
+    if (type == NUMERIC) {
+      pass.sort = 0;
+      pass.top_k = 0;
+      pass.bottom_k = 0;
+    }
+    shared_ptr<const StringColumn> strings =
+        table::sharedStringColumn(source, column);
+    state = selectedState<StringColumn, StringView>(*strings, selection, pass);
+    if (needs.stream)
+      state.pieces.push_back(
+          {strings,
+           selection ? selectedMask(*strings, selection->rows) : Bitmap()});
+  }
+
+  state.type = type;
+  return state;
+}
+
+/*
+ * @brief Получить ключ общего состояния операций по группам
+ * @param group_by столбец ключей группировки
+ * @param needs что вычисляется, кроме суммы и количества
+ * @return GROUPED_STATE со столбцом ключей и требованиями
+ */
+string groupedKey(int group_by, const StateNeeds &needs) {
+  return GROUPED_STATE + "/g" + std::to_string(group_by) + "/m" +
+         std::to_string(needs.moments);
+}
+
+/*
+ * @brief Сгруппировать числовой столбец по ключам другого столбца
+ * @param source таблица
+ * @param column номер столбца значений
+ * @param group_by номер столбца ключей
+ * @param needs что вычислить, кроме суммы и количества
+ * @param selection отбор строк или nullptr
+ * @return частичный результат с таблицей групп и типом столбца
+ */
+PartialResult groupedState(table::Table &source, int column, int group_by,
+                           const StateNeeds &needs,
+                           const Selection *selection) {
+  PartialResult state;
+  ColumnType type = table::getTypeOfColumn(source, column);
+
+  if (type == NUMERIC and
+      table::getTypeOfColumn(source, group_by) != UNKNOWN)
+    state.groups = groupAggregate(
+        table::numericColumn(source, column),
+        table::stringColumn(source, group_by), needs.moments, 0,
+        selection ? &selection->rows : nullptr);
+
+  state.type = type;
+  return state;
+}
+
+/*
+ * @brief Вычислить столбцы выражений: одинаковые выражения вычисляются один
+ * раз и хранятся в таблице как производные числовые столбцы
+ * @param source таблица
+ * @param tasks операции
+ * @return вход-выражение операции -> номер производного столбца
+ */
+map<string, int> deriveExpressions(table::Table &source,
+                                   const vector<Task> &tasks) {
+  map<string, int> derived;
+
+  for (const Task &task : tasks) {
+    if (task.expr.code.empty() or derived.count(task.input))
+      continue;
+
+    auto found = source.derived_columns.find(task.input);
+    if (found == source.derived_columns.end()) {
+      vector<const NumericColumn *> columns;
+      for (int column : task.expr.columns) {
+        columns.push_back(&table::numericColumn(source, column));
+      }
+
+      int index = table::DERIVED_COLUMN + source.derived_columns.size();
+      table::addDerivedColumn(
+          source, index,
+          evaluateExpression(task.expr, columns, source.rows.size()));
+      found = source.derived_columns.insert({task.input, index}).first;
+    }
+    derived[task.input] = found->second;
+  }
+  return derived;
+}
+
+/*
+ * @brief Вычислить производные столбцы преобразований графа. Преобразование
+ * выполняется, когда готов его входной столбец, а одинаковые
+ * преобразования одного столбца таблицы вычисляются один раз
+ * @param source таблица
+ * @param tasks операции
+ * @param results результаты операций (заполняются для преобразований)
+ * @return id преобразования или вход-выражение -> номер производного столбца
+ */
+map<string, int> deriveColumns(table::Table &source, const vector<Task> &tasks,
+                               vector<SharedResult> &results) {
+  // преобразование может читать столбец выражения
+  map<string, int> derived = deriveExpressions(source, tasks);
+  vector<bool> failed(tasks.size(), false);
+  bool progress = true;
+
+  while (progress) {
+    progress = false;
+
+    for (size_t t = 0; t < tasks.size(); t++) {
+      const Task &task = tasks[t];
+      if (!isTransform(task.op) or derived.count(task.id) or failed[t])
+        continue;
+
+      int column = task.column;
+      if (!task.input.empty()) {
+        auto input = derived.find(task.input);
+        if (input == derived.end())
+          continue;
+        column = input->second;
+      }
+
+      // преобразование, не меняющее столбец, передает входной столбец без
+      // вычисления и копирования
+      int index;
+      string key = taskKey(task) + "/" + std::to_string(column);
+      auto found = source.derived_columns.find(key);
+      if (found != source.derived_columns.end()) {
+        index = found->second;
+      } else if (!isWindow(task.op) and
+                 keepsColumn(task.op, table::stringColumn(source, column),
+                             task.params)) {
+        index = column;
+      } else {
+        index = table::DERIVED_COLUMN + source.derived_columns.size();
+        try {
+          if (isWindow(task.op))
+            table::addDerivedColumn(
+                source, index,
+                callWindow(task.op, table::numericColumn(source, column),
+                           task.params));
+          else
+            table::addDerivedColumn(
+                source, index,
+                callTransform(task.op, table::stringColumn(source, column),
+                              task.params));
+        } catch (const std::exception &e) {
+          std::cerr << "Error deriving column for operation " << task.id
+                    << ": " << e.what() << std::endl;
+          failed[t] = true;
+          continue;
+        }
+        source.derived_columns.insert({key, index});
+      }
+
+      derived[task.id] = index;
+      progress = true;
+      auto result = std::make_shared<PartialResult>();
+      results[t] = result;
+      if (isWindow(task.op)) {
+        // оконный столбец числовой: строки форматируются, только если его
+        // читает строковая операция
+        result->type = table::getTypeOfColumn(source, index);
+        result->count = presentCount(table::numericColumn(source, index));
+        continue;
+      }
+      result->type = STRING;
+      result->column = table::sharedStringColumn(source, index);
+      result->count = presentCount(*result->column);
+    }
+  }
+  return derived;
+}
+
+/*
+ * @brief Вычислить маски отборов строк графа. Условие может проверять и
+ * производный столбец преобразования
+ * @param source таблица
+ * @param tasks операции
+ * @param derived id преобразования -> номер производного столбца
+ * @param results результаты операций (заполняются для отборов)
+ * @return id отбора -> маска выбранных строк
+ */
+map<string, Selection> selectRows(table::Table &source,
+                                  const vector<Task> &tasks,
+                                  const map<string, int> &derived,
+                                  vector<SharedResult> &results) {
+  map<string, Selection> selections;
+
+  for (size_t t = 0; t < tasks.size(); t++) {
+    const Task &task = tasks[t];
+    if (!isFilter(task.op))
+      continue;
+
+    int column = task.column;
+    if (!task.input.empty()) {
+      auto input = derived.find(task.input);
+      if (input == derived.end())
+        continue;
+      column = input->second;
+    }
+
+    try {
+      Selection selection;
+      selection.key = taskKey(task) + "/" + std::to_string(column);
+      selection.rows = callFilter(task.op, source, column, task.params);
+
+      auto result = std::make_shared<PartialResult>();
+      result->type = table::getTypeOfColumn(source, column) == UNKNOWN
+                         ? UNKNOWN
+                         : STRING;
+      result->count = countBits(selection.rows);
+      results[t] = result;
+      selections[task.id] = std::move(selection);
+    } catch (const std::exception &e) {
+      std::cerr << "Error filtering rows for operation " << task.id << ": "
+                << e.what() << std::endl;
+    }
+  }
+  return selections;
+}
+
+/*
+ * @brief Выполнить операции над таблицей, просматривая каждый столбец один
+ * раз
+ * @param source таблица
+ * @param tasks операции
+ * @param groups группы операций по столбцам
+ * @return частичный результат для каждой операции (по индексу в tasks)
+ */
+vector<SharedResult> evaluate(table::Table &source, const vector<Task> &tasks,
+                              const vector<ColumnGroup> &groups) {
+  Cache cache;
+  vector<string> reused_from;
+  return evaluate(source, tasks, groups, cache, reused_from);
+}
+
+/*
+ * @brief Выполнить операции над таблицей с кэшем результатов: одинаковые
+ * операции над одним столбцом вычисляются один раз, а производные агрегаты
+ * (например, average) используют общее состояние столбца
+ * @param source таблица
+ * @param tasks операции
+ * @param groups группы операций по столбцам
+ * @param cache кэш результатов запуска
+ * @param reused_from для каждой операции - id операции, чей результат был
+ * взят из кэша, или пустая строка
+ * @return частичный результат для каждой операции (по индексу в tasks)
+ */
+vector<SharedResult> evaluate(table::Table &source, const vector<Task> &tasks,
+                              const vector<ColumnGroup> &groups, Cache &cache,
+                              vector<string> &reused_from) {
+  vector<SharedResult> results(tasks.size());
+  reused_from.assign(tasks.size(), "");
+  map<string, int> derived = deriveColumns(source, tasks, results);
+  map<string, Selection> selections =
+      selectRows(source, tasks, derived, results);
+
+  for (const ColumnGroup &group : groups) {
+    // операции над производным столбцом без вычисленного преобразования не
+    // получают результата
+    int column = group.column;
+    if (!group.input.empty()) {
+      auto input = derived.find(group.input);
+      if (input == derived.end())
+        continue;
+      column = input->second;
+    }
+
+    // моменты и скетчи считаются в том же проходе, если они нужны хоть
+    // одной операции группы
+    StateNeeds needs;
+    for (size_t t : group.tasks) {
+      addNeeds(needs, needsOf(tasks[t].op, tasks[t].params));
+    }
+
+    for (size_t t : group.tasks) {
+      const Task &task = tasks[t];
+      if (isTransform(task.op) or isFilter(task.op) or isJoin(task.op))
+        continue;
+
+      // операции с отбором строк без вычисленной маски не получают
+      // результата; маска входит в ключи кэша
+      const Selection *selection = nullptr;
+      string where;
+      if (!task.where.empty()) {
+        auto found = selections.find(task.where);
+        if (found == selections.end())
+          continue;
+        selection = &found->second;
+        where = "/w" + selection->key;
+      }
+
+      CacheKey key = {taskKey(task) + where, column, source.version};
+
+      auto found = cache.find(key);
+      if (found != cache.end()) {
+        results[t] = found->second.partial;
+        reused_from[t] = found->second.owner;
+        continue;
+      }
+
+      // операции, которые нельзя вычислить по группам, не получают
+      // результата, и executor пропускает их
+      bool grouped = task.group_by >= 0;
+      if (grouped and !isGroupable(task.op))
+        continue;
+
+      // один проход по столбцу на все операции группы с тем же типом входа
+      // (или с тем же столбцом ключей); операции над столбцом любого типа
+      // читают его в его типе
+      ColumnType input = operationInput(task.op);
+      if (input == UNKNOWN)
+        input = table::getTypeOfColumn(source, column);
+      CacheKey state_key = {(grouped ? groupedKey(task.group_by, needs)
+                                     : stateKey(input, needs)) +
+                                where,
+                            column, source.version};
+
+      auto state = cache.find(state_key);
+      if (state == cache.end()) {
+        auto partial = std::make_shared<const PartialResult>(
+            grouped
+                ? groupedState(source, column, task.group_by, needs, selection)
+                : columnState(source, column, input, needs, selection));
+        state = cache.insert({state_key, {partial, task.id}}).first;
+      } else {
+        reused_from[t] = state->second.owner;
+      }
+
+      // операции группы и кэш делят одно состояние без копирования
+      results[t] = state->second.partial;
+      cache[key] = {results[t], task.id};
+    }
+  }
+
+  // операции без результата получают одно общее пустое состояние
+  SharedResult empty = std::make_shared<const PartialResult>();
+  for (SharedResult &result : results) {
+    if (!result)
+      result = empty;
+  }
+  return results;
+}
+
+}; // namespace plan
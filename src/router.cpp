@@ -1,11 +1,15 @@
 #include "../include/router.h"
+#include "../include/executor.h"
 #include "../include/graph.h"
 #include "../include/graphics.h"
 #include "../include/operations.h"
 #include "../include/parser.h"
+#include "../include/plan.h"
 #include "../include/utils.h"
 #include <ctime>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -17,6 +21,7 @@ using std::vector;
 namespace SimpleDAG {
 
 const string WORKING_DIR = "data";
+vector<string> shards; // файлы данных, если путь в конфигурации задает набор
 
 /**
  * @brief Главная функция запуска приложения SimpleDAG
@@ -37,8 +42,13 @@ int run() {
     return 1;
   }
 
+  // Скомпилировать план операций
+  if (plan::compile(config::getIds()) > 0) {
+    cout << "Operations with errors will be skipped." << endl;
+  }
+
   // Загрузить данные
-  if (!Internal::loadDataTable()) {
+  if (!Internal::loadDataTable(WORKING_DIR)) {
     return 1;
   }
 
@@ -46,24 +56,173 @@ int run() {
   Internal::displayAvailableOperations();
 
   // Инициализировать логирование
-  Internal::initializeLogging();
+  Internal::initializeLogging(WORKING_DIR);
 
-  // Обработать схему графа
+  // Построить граф по зависимостям из конфигурации или по введенной схеме
   vector<string> ids = config::getIds();
-  if (!Internal::processGraphScheme(ids)) {
+  map<string, vector<string>> depends = config::getDependencies();
+  bool built = depends.empty() ? Internal::processGraphScheme(ids)
+                               : Internal::processDependencies(ids, depends);
+  if (!built) {
     Internal::cleanup();
     return 1;
   }
 
-  // Запустить выполнение операций
-  deepFirstSearch(procedure);
+  // Запустить выполнение операций: каждый столбец просматривается один раз,
+  // а результаты записываются в топологическом порядке, чтобы узел читал
+  // уже готовые результаты родителей
+  executor::run(shards);
+  topologicalSearch(executor::writeMerged);
 
   Internal::cleanup();
   return 0;
 }
 
+/**
+ * @brief Запуск SimpleDAG без интерактивного ввода: конфигурация, схема,
+ * директория данных и файл результатов задаются аргументами командной строки
+ * @param argc количество аргументов
+ * @param argv аргументы
+ * @return код завершения ExitCode
+ */
+int runBatch(int argc, char *argv[]) {
+  BatchOptions options;
+  if (!Internal::parseArguments(argc, argv, options)) {
+    std::cerr << USAGE << endl;
+    return EXIT_USAGE;
+  }
+  if (options.help) {
+    cout << USAGE << endl;
+    return EXIT_OK;
+  }
+
+  // stdout пакетного режима не занят сообщениями: ход работы и ошибки
+  // выводятся в stderr
+  std::streambuf *stdout_buffer = cout.rdbuf(std::cerr.rdbuf());
+  auto finish = [stdout_buffer](ExitCode code) {
+    Internal::cleanup();
+    cout.rdbuf(stdout_buffer);
+    return code;
+  };
+
+  // Загрузить и проверить конфигурацию
+  config::load(options.config);
+  vector<string> ids = config::getIds();
+  if (ids.empty()) {
+    std::cerr << "No operations in config " << options.config << endl;
+    return finish(EXIT_CONFIG);
+  }
+  if (!Internal::validateConfiguration()) {
+    return finish(EXIT_CONFIG);
+  }
+  size_t invalid = plan::compile(ids);
+
+  // Загрузить данные
+  if (!Internal::loadDataTable(options.data_dir)) {
+    return finish(EXIT_DATA);
+  }
+
+  // Построить граф по файлу схемы или по зависимостям из конфигурации
+  if (options.scheme.empty()) {
+    map<string, vector<string>> depends = config::getDependencies();
+    if (depends.empty()) {
+      std::cerr << "No --scheme given and no depends_on in config" << endl;
+      return finish(EXIT_SCHEME);
+    }
+    if (!Internal::processDependencies(ids, depends)) {
+      return finish(EXIT_SCHEME);
+    }
+  } else {
+    vector<string> scheme;
+    if (!Internal::readSchemeFile(options.scheme, scheme)) {
+      std::cerr << "Failed to open scheme " << options.scheme << endl;
+      return finish(EXIT_SCHEME);
+    }
+    if (scheme.empty() or !Internal::validateAndDisplayScheme(scheme, ids)) {
+      std::cerr << "Invalid scheme " << options.scheme << endl;
+      return finish(EXIT_SCHEME);
+    }
+    createGraphFromScheme(scheme, ids);
+  }
+
+  // Открыть файл результатов
+  bool opened = options.output.empty()
+                    ? Internal::initializeLogging(options.data_dir)
+                    : logger::openLog(options.output);
+  if (!opened) {
+    return finish(EXIT_OUTPUT);
+  }
+
+  executor::run(shards);
+  topologicalSearch(executor::writeMerged);
+
+  // операции с ошибками конфигурации и операции, пропущенные при записи
+  // (ошибки выполнения, неизвестный тип столбца), дают один код
+  bool skipped = invalid > 0 or executor::skipped() > 0;
+  return finish(skipped ? EXIT_INVALID_OPS : EXIT_OK);
+}
+
 namespace Internal {
 
+/**
+ * @brief Разбирает аргументы пакетного режима
+ * @param argc количество аргументов
+ * @param argv аргументы (--config, --scheme, --data, --output, --help)
+ * @param options заполняемые аргументы
+ * @return true если аргументы корректны
+ */
+bool parseArguments(int argc, char *argv[], BatchOptions &options) {
+  const std::map<string, string BatchOptions::*> values = {
+      {"--config", &BatchOptions::config},
+      {"--scheme", &BatchOptions::scheme},
+      {"--data", &BatchOptions::data_dir},
+      {"--output", &BatchOptions::output}};
+
+  for (int i = 1; i < argc; i++) {
+    string name = argv[i];
+    if (name == "--help" or name == "-h") {
+      options.help = true;
+      return true;
+    }
+
+    auto value = values.find(name);
+    if (value == values.end()) {
+      std::cerr << "Unknown argument " << name << endl;
+      return false;
+    }
+    if (i + 1 == argc) {
+      std::cerr << "No value for argument " << name << endl;
+      return false;
+    }
+    options.*value->second = argv[++i];
+  }
+
+  if (options.config.empty()) {
+    std::cerr << "--config is required" << endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Читает схему графа из файла: строки до end, пустые строки
+ * пропускаются
+ * @param path путь к файлу схемы
+ * @param scheme прочитанные строки схемы
+ * @return true если файл открыт
+ */
+bool readSchemeFile(const string &path, vector<string> &scheme) {
+  std::ifstream file(path);
+  if (!file.is_open())
+    return false;
+
+  for (string &line : getScheme(file)) {
+    if (line.find_first_not_of(" \t\r") != string::npos)
+      scheme.push_back(line);
+  }
+  return true;
+}
+
 /**
  * @brief Загружает конфигурацию из YAML файла
  * @param workingDir Рабочая директория для поиска конфигурационных файлов
@@ -105,8 +264,8 @@ bool validateConfiguration() {
             "есть в этом списке:"
          << endl;
 
-    for (const auto &func : operation_map) {
-      cout << "- " << func.first << endl;
+    for (int op = 0; op < OP_UNKNOWN; op++) {
+      cout << "- " << operationInfo(OperationId(op)).name << endl;
     }
     return false;
   }
@@ -114,18 +273,47 @@ bool validateConfiguration() {
 }
 
 /**
- * @brief Загружает данные из CSV файла указанного в конфигурации
+ * @brief Загружает данные из CSV файла указанного в конфигурации. Если путь
+ * задает директорию или шаблон имени, запоминает набор файлов для
+ * параллельной обработки. Также загружает именованные таблицы из раздела
+ * tables
+ * @param workingDir Директория с файлами данных
  * @return true если данные успешно загружены, false в случае ошибки
  */
-bool loadDataTable() {
+bool loadDataTable(const std::string &workingDir) {
   string csvFile = config::getCSV();
   if (csvFile.empty()) {
     cout << "Не указан файл данных в конфигурации" << endl;
     return false;
   }
 
-  string csvPath = WORKING_DIR + "/" + csvFile;
-  table::read(csvPath);
+  string csvPath = workingDir + "/" + csvFile;
+  vector<string> files = executor::resolveShards(csvPath);
+  if (files.empty() or
+      (files.size() == 1 and !std::ifstream(files[0]).good())) {
+    cout << "Не найдены файлы данных по пути " << csvPath << endl;
+    return false;
+  }
+
+  // набор файлов обрабатывается параллельно после построения графа
+  if (files.size() == 1) {
+    table::read(files[0]);
+  } else {
+    shards = files;
+    cout << "Найдено файлов данных: " << shards.size() << endl;
+  }
+
+  // именованные таблицы читаются один раз, их операции и соединения с ними
+  // выполняются вместе с основной таблицей
+  for (const auto &[name, file] : config::getTables()) {
+    string path = workingDir + "/" + file;
+    if (!std::ifstream(path).good()) {
+      cout << "Не найден файл таблицы " << name << " по пути " << path
+           << endl;
+      return false;
+    }
+    table::readNamed(name, path);
+  }
   return true;
 }
 
@@ -144,11 +332,13 @@ void displayAvailableOperations() {
 
 /**
  * @brief Инициализирует систему логирования с временной меткой
+ * @param workingDir Директория для файла результатов
+ * @return true если файл результатов открыт
  */
-void initializeLogging() {
+bool initializeLogging(const std::string &workingDir) {
   time_t now = time(0);
   char *dt = ctime(&now);
-  logger::openLog(WORKING_DIR + "/" + dt);
+  return logger::openLog(workingDir + "/" + dt);
 }
 
 /**
@@ -180,6 +370,30 @@ bool processGraphScheme(std::vector<std::string> &ids) {
   return true;
 }
 
+/**
+ * @brief Проверяет зависимости depends_on из конфигурации, отображает ошибки
+ * и строит граф из всех операций без ввода схемы
+ * @param ids Список идентификаторов доступных операций
+ * @param depends Зависимости операций из конфигурации
+ * @return true если зависимости корректны и граф построен
+ */
+bool processDependencies(const vector<string> &ids,
+                         const map<string, vector<string>> &depends) {
+  vector<string> errors = checkDependencies(ids, depends);
+  if (!errors.empty()) {
+    cout << "\n❌ Обнаружены ошибки в зависимостях depends_on:" << endl;
+    for (const string &error : errors) {
+      cout << error << endl;
+    }
+    return false;
+  }
+
+  createGraphFromDependencies(ids, depends);
+  cout << "✅ Граф построен по зависимостям: " << nodesTotal() << " операций"
+       << endl;
+  return true;
+}
+
 /**
  * @brief Проверяет схему на валидность и отображает ошибки
  * @param scheme Вектор строк схемы графа
@@ -237,7 +451,10 @@ void displaySchemeErrors(const std::string &schemeLine,
  */
 void cleanup() {
   config::clear();
+  plan::clear();
   table::clear();
+  executor::clear();
+  shards.clear();
   logger::close();
   clearGraph();
 }
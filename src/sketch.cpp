@@ -0,0 +1,425 @@
+#include "../include/sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+const double LEVEL_RATIO = 2.0 / 3.0; // уменьшение емкости нижних уровней
+const uint64_t HASH_SEED = 0x9e3779b97f4a7c15ull;  // начальное значение хэша
+const uint64_t HASH_MUL_1 = 0x87c37b91114253d5ull; // множители перемешивания
+const uint64_t HASH_MUL_2 = 0x4cf5ad432745937full; // данных и хэша
+
+/**
+ * @brief Создать пустой скетч
+ * @param accuracy параметр k (приводится к диапазону от MIN_ACCURACY до
+ * MAX_ACCURACY)
+ * @return скетч
+ */
+QuantileSketch createSketch(size_t accuracy) {
+  QuantileSketch sketch;
+  sketch.accuracy = std::clamp(accuracy, MIN_ACCURACY, MAX_ACCURACY);
+  sketch.levels.resize(1);
+  return sketch;
+}
+
+/*
+ * @brief Емкость уровня: верхний уровень вмещает k значений, каждый
+ * следующий вниз - в 2/3 раза меньше, но не меньше двух
+ * @param sketch скетч
+ * @param level номер уровня
+ * @return емкость
+ */
+size_t levelCapacity(const QuantileSketch &sketch, size_t level) {
+  size_t depth = sketch.levels.size() - 1 - level;
+  return std::max<size_t>(
+      2, std::ceil(sketch.accuracy * std::pow(LEVEL_RATIO, depth)));
+}
+
+/*
+ * @brief Суммарная емкость уровней скетча
+ * @param sketch скетч
+ * @return емкость
+ */
+size_t totalCapacity(const QuantileSketch &sketch) {
+  size_t capacity = 0;
+  for (size_t h = 0; h < sketch.levels.size(); h++) {
+    capacity += levelCapacity(sketch, h);
+  }
+  return capacity;
+}
+
+/*
+ * @brief Количество значений, хранящихся в скетче
+ * @param sketch скетч
+ * @return количество значений на всех уровнях
+ */
+size_t storedCount(const QuantileSketch &sketch) {
+  size_t stored = 0;
+  for (const vector<float> &level : sketch.levels) {
+    stored += level.size();
+  }
+  return stored;
+}
+
+/*
+ * @brief Сжимать уровни, пока скетч не поместится в суммарную емкость:
+ * переполненный уровень сортируется, и каждое второе значение переходит на
+ * уровень выше с удвоенным весом
+ * @param sketch скетч
+ */
+void compress(QuantileSketch &sketch) {
+  while (storedCount(sketch) > totalCapacity(sketch)) {
+    size_t h = 0;
+    while (sketch.levels[h].size() < levelCapacity(sketch, h)) {
+      h++;
+    }
+    if (h + 1 == sketch.levels.size())
+      sketch.levels.emplace_back();
+
+    vector<float> &level = sketch.levels[h];
+    std::sort(level.begin(), level.end());
+
+    // при нечетном размере наибольшее значение остается на уровне
+    float kept = level.back();
+    bool odd = level.size() % 2;
+    size_t pairs = level.size() / 2;
+
+    vector<float> &upper = sketch.levels[h + 1];
+    for (size_t i = 0; i < pairs; i++) {
+      upper.push_back(level[2 * i + sketch.parity]);
+    }
+    sketch.parity = !sketch.parity;
+
+    level.clear();
+    if (odd)
+      level.push_back(kept);
+  }
+}
+
+/**
+ * @brief Добавить присутствующие значения в скетч
+ * @param sketch скетч
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ */
+void sketchInsert(QuantileSketch &sketch, const float *values,
+                  const uint64_t *validity, size_t length) {
+  if (sketch.levels.empty())
+    sketch.levels.resize(1);
+
+  // нижний уровень занимает все свободное место скетча, поэтому сжатие
+  // происходит редко, а емкость пересчитывается только после него
+  size_t stored = storedCount(sketch);
+  size_t capacity = totalCapacity(sketch);
+
+  for (size_t i = 0; i < length; i++) {
+    if (validity and !((validity[i / 64] >> (i % 64)) & 1))
+      continue;
+
+    sketch.levels[0].push_back(values[i]);
+    sketch.count++;
+    if (++stored > capacity) {
+      compress(sketch);
+      stored = storedCount(sketch);
+      capacity = totalCapacity(sketch);
+    }
+  }
+}
+
+/**
+ * @brief Добавить скетч следующей части данных
+ * @param into накапливаемый скетч
+ * @param from скетч следующей части
+ */
+void sketchMerge(QuantileSketch &into, const QuantileSketch &from) {
+  if (from.count == 0)
+    return;
+  if (into.count == 0) {
+    into = from;
+    return;
+  }
+
+  into.accuracy = std::min(into.accuracy, from.accuracy);
+  if (into.levels.size() < from.levels.size())
+    into.levels.resize(from.levels.size());
+
+  for (size_t h = 0; h < from.levels.size(); h++) {
+    into.levels[h].insert(into.levels[h].end(), from.levels[h].begin(),
+                          from.levels[h].end());
+  }
+  into.count += from.count;
+  compress(into);
+}
+
+/*
+ * @brief Номер значения с рангом ceil(q * n) в отсортированных данных
+ * @param q уровень квантиля
+ * @param n количество значений
+ * @return номер от 0 до n - 1
+ */
+size_t quantileRank(double q, size_t n) {
+  double rank = std::ceil(std::clamp(q, 0.0, 1.0) * n);
+  return std::min<size_t>(n - 1, rank > 0 ? size_t(rank) - 1 : 0);
+}
+
+/**
+ * @brief Получить приближенный квантиль
+ * @param sketch скетч
+ * @param q уровень квантиля от 0 до 1
+ * @return значение, ранг которого ближе всего к q * count (NaN для пустого
+ * скетча)
+ */
+float sketchQuantile(const QuantileSketch &sketch, double q) {
+  if (sketch.count == 0)
+    return NAN;
+
+  vector<std::pair<float, uint64_t>> weighted;
+  for (size_t h = 0; h < sketch.levels.size(); h++) {
+    for (float value : sketch.levels[h]) {
+      weighted.push_back({value, uint64_t(1) << h});
+    }
+  }
+  std::sort(weighted.begin(), weighted.end());
+
+  // вес сохраняется при сжатии, поэтому сумма весов равна count
+  uint64_t target = quantileRank(q, sketch.count) + 1;
+  uint64_t cumulative = 0;
+  for (const auto &item : weighted) {
+    cumulative += item.second;
+    if (cumulative >= target)
+      return item.first;
+  }
+  return weighted.back().first;
+}
+
+/**
+ * @brief Получить точный квантиль отсортированных значений без копирования
+ * @param sorted значения по возрастанию
+ * @param q уровень квантиля от 0 до 1
+ * @return значение с рангом ceil(q * n) (NaN для пустых данных)
+ */
+float sortedQuantile(const vector<float> &sorted, double q) {
+  if (sorted.empty())
+    return NAN;
+  return sorted[quantileRank(q, sorted.size())];
+}
+
+/*
+ * @brief Перемешать биты слова (завершение MurmurHash3)
+ * @param h слово
+ * @return перемешанное слово
+ */
+inline uint64_t mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+/*
+ * @brief Добавить слово к хэшу
+ * @param h хэш
+ * @param word слово данных
+ * @return обновленный хэш
+ */
+inline uint64_t hashWord(uint64_t h, uint64_t word) {
+  word *= HASH_MUL_1;
+  word = (word << 31) | (word >> 33);
+  word *= HASH_MUL_2;
+  h ^= word;
+  return ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+}
+
+/**
+ * @brief Хэш последовательности байтов: байты обрабатываются словами по 8
+ * @param data указатель на байты
+ * @param length количество байтов
+ * @return 64-битный хэш
+ */
+uint64_t hashBytes(const char *data, size_t length) {
+  uint64_t h = HASH_SEED ^ (length * HASH_MUL_1);
+  size_t words = length / 8;
+
+  for (size_t i = 0; i < words; i++) {
+    uint64_t word;
+    std::memcpy(&word, data + 8 * i, 8);
+    h = hashWord(h, word);
+  }
+
+  // хвост дополняется нулями до слова
+  uint64_t tail = 0;
+  std::memcpy(&tail, data + 8 * words, length % 8);
+  h = hashWord(h, tail);
+  return mix64(h);
+}
+
+/*
+ * @brief Обновить регистр HyperLogLog по хэшу: старшие биты выбирают
+ * регистр, ранг остальных - номер первой единицы
+ * @param registers регистры
+ * @param hash хэш значения
+ */
+inline void updateRegister(uint8_t *registers, uint64_t hash) {
+  size_t index = hash >> (64 - HLL_PRECISION);
+  // сторожевой бит ограничивает ранг, если остальные биты нулевые
+  uint64_t rest =
+      (hash << HLL_PRECISION) | (uint64_t(1) << (HLL_PRECISION - 1));
+  uint8_t rank = __builtin_clzll(rest) + 1;
+  registers[index] = std::max(registers[index], rank);
+}
+
+/**
+ * @brief Добавить присутствующие строки в скетч HyperLogLog
+ * @param sketch скетч (создается при первом добавлении)
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void distinctInsert(DistinctSketch &sketch, const string *values,
+                    const uint64_t *validity, size_t length) {
+  sketch.registers.resize(size_t(1) << HLL_PRECISION, 0);
+  uint8_t *registers = sketch.registers.data();
+
+  // четыре независимых хэша за итерацию загружают конвейер процессора
+  size_t i = 0;
+  for (; i + 4 <= length; i += 4) {
+    uint64_t h0 = hashBytes(values[i].data(), values[i].size());
+    uint64_t h1 = hashBytes(values[i + 1].data(), values[i + 1].size());
+    uint64_t h2 = hashBytes(values[i + 2].data(), values[i + 2].size());
+    uint64_t h3 = hashBytes(values[i + 3].data(), values[i + 3].size());
+
+    uint64_t present = validity ? validity[i / 64] >> (i % 64) : 0xF;
+    if (present & 1)
+      updateRegister(registers, h0);
+    if (present & 2)
+      updateRegister(registers, h1);
+    if (present & 4)
+      updateRegister(registers, h2);
+    if (present & 8)
+      updateRegister(registers, h3);
+  }
+  for (; i < length; i++) {
+    if (!validity or ((validity[i / 64] >> (i % 64)) & 1))
+      updateRegister(registers, hashBytes(values[i].data(), values[i].size()));
+  }
+}
+
+/**
+ * @brief Добавить скетч следующей части данных
+ * @param into накапливаемый скетч
+ * @param from скетч следующей части
+ */
+void distinctMerge(DistinctSketch &into, const DistinctSketch &from) {
+  if (from.registers.empty())
+    return;
+  if (into.registers.empty()) {
+    into = from;
+    return;
+  }
+  for (size_t r = 0; r < into.registers.size(); r++) {
+    into.registers[r] = std::max(into.registers[r], from.registers[r]);
+  }
+}
+
+/**
+ * @brief Оценить количество уникальных значений
+ * @param sketch скетч
+ * @return оценка (0 для пустого скетча)
+ */
+double distinctEstimate(const DistinctSketch &sketch) {
+  if (sketch.registers.empty())
+    return 0;
+
+  double m = sketch.registers.size();
+  double harmonic = 0;
+  size_t zeros = 0;
+  for (uint8_t rank : sketch.registers) {
+    harmonic += std::ldexp(1.0, -int(rank));
+    zeros += rank == 0;
+  }
+
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / harmonic;
+
+  // на малых количествах точнее линейный подсчет пустых регистров
+  if (estimate <= 2.5 * m and zeros > 0)
+    return m * std::log(m / zeros);
+  return estimate;
+}
+
+/*
+ * @brief Добавить строку в множество, если ее там нет
+ * @param set множество
+ * @param value строка
+ * @param hash хэш строки
+ */
+void insertUnique(DistinctSet &set, const string &value, uint64_t hash) {
+  // коэффициент заполнения не выше 1/2
+  if (2 * (set.values.size() + 1) > set.slots.size()) {
+    size_t capacity = std::max<size_t>(16, 2 * set.slots.size());
+    vector<uint32_t> slots(capacity, 0);
+    vector<uint64_t> hashes(capacity, 0);
+
+    for (size_t s = 0; s < set.slots.size(); s++) {
+      if (!set.slots[s])
+        continue;
+      size_t probe = set.hashes[s] & (capacity - 1);
+      while (slots[probe]) {
+        probe = (probe + 1) & (capacity - 1);
+      }
+      slots[probe] = set.slots[s];
+      hashes[probe] = set.hashes[s];
+    }
+    set.slots.swap(slots);
+    set.hashes.swap(hashes);
+  }
+
+  size_t mask = set.slots.size() - 1;
+  size_t probe = hash & mask;
+  while (set.slots[probe]) {
+    if (set.hashes[probe] == hash and set.values[set.slots[probe] - 1] == value)
+      return;
+    probe = (probe + 1) & mask;
+  }
+
+  set.values.push_back(value);
+  set.slots[probe] = set.values.size();
+  set.hashes[probe] = hash;
+}
+
+/**
+ * @brief Добавить присутствующие строки в точное множество
+ * @param set множество
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void distinctSetInsert(DistinctSet &set, const string *values,
+                       const uint64_t *validity, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (!validity or ((validity[i / 64] >> (i % 64)) & 1))
+      insertUnique(set, values[i],
+                   hashBytes(values[i].data(), values[i].size()));
+  }
+}
+
+/**
+ * @brief Добавить множество следующей части данных
+ * @param into накапливаемое множество
+ * @param from множество следующей части
+ */
+void distinctSetMerge(DistinctSet &into, const DistinctSet &from) {
+  for (size_t s = 0; s < from.slots.size(); s++) {
+    if (from.slots[s])
+      insertUnique(into, from.values[from.slots[s] - 1], from.hashes[s]);
+  }
+}
@@ -0,0 +1,493 @@
+#include "../include/sort.h"
+#include "../include/column.h"
+#include "../include/kernels.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// количество бит разряда и корзин поразрядной сортировки
+const int RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+
+// минимальная часть данных одного потока поразрядной сортировки
+const size_t PARALLEL_SORT = 1 << 16;
+
+// размер блока чтения файла сброса с конца при слиянии по убыванию
+const size_t SPILL_BLOCK = 1 << 16;
+
+/*
+ * @brief Удалить файл сброса вместе с серией
+ */
+SortRun::~SortRun() {
+  if (!path.empty())
+    std::remove(path.c_str());
+}
+
+/*
+ * @brief Получить ключ числа, порядок которого как целого без знака
+ * совпадает с порядком чисел: у положительных инвертируется знак, у
+ * отрицательных - все биты
+ * @param value число
+ * @return ключ
+ */
+uint32_t floatKey(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+/*
+ * @brief Восстановить число по ключу
+ * @param key ключ
+ * @return число
+ */
+float keyFloat(uint32_t key) {
+  uint32_t bits = key & 0x80000000u ? key & 0x7fffffffu : ~key;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Поразрядная сортировка (LSD) чисел по возрастанию: ключи - биты
+ * float с сохранением порядка, по 8 бит за проход. Гистограммы разрядов
+ * считаются потоками по своим частям, а проход, в котором у всех ключей
+ * одинаковый разряд, пропускается
+ * @param values значения (сортируются на месте)
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void radixSort(vector<float> &values, unsigned workers) {
+  size_t n = values.size();
+  workers = resolveWorkers(workers);
+  workers = unsigned(std::max<size_t>(
+      1, std::min<size_t>(workers, n / PARALLEL_SORT)));
+
+  vector<uint32_t> keys(n);
+  vector<uint32_t> scratch(n);
+  parallelChunks(workers, n, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      keys[i] = floatKey(values[i]);
+    }
+  });
+
+  // счетчики корзин по потокам: counts[w * RADIX_BUCKETS + b]
+  vector<size_t> counts(workers * RADIX_BUCKETS);
+
+  for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+    std::fill(counts.begin(), counts.end(), 0);
+    parallelChunks(workers, n, [&](unsigned w, size_t begin, size_t end) {
+      size_t *count = counts.data() + w * RADIX_BUCKETS;
+      for (size_t i = begin; i < end; i++) {
+        count[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+      }
+    });
+
+    bool same = false;
+    for (size_t b = 0; b < RADIX_BUCKETS and !same; b++) {
+      size_t total = 0;
+      for (unsigned w = 0; w < workers; w++) {
+        total += counts[w * RADIX_BUCKETS + b];
+      }
+      same = total == n;
+    }
+    if (same)
+      continue;
+
+    // смещения идут по корзинам, а внутри корзины - по потокам, поэтому
+    // каждый поток пишет в свои позиции и сортировка остается устойчивой
+    size_t offset = 0;
+    for (size_t b = 0; b < RADIX_BUCKETS; b++) {
+      for (unsigned w = 0; w < workers; w++) {
+        size_t count = counts[w * RADIX_BUCKETS + b];
+        counts[w * RADIX_BUCKETS + b] = offset;
+        offset += count;
+      }
+    }
+
+    parallelChunks(workers, n, [&](unsigned w, size_t begin, size_t end) {
+      size_t *next = counts.data() + w * RADIX_BUCKETS;
+      for (size_t i = begin; i < end; i++) {
+        scratch[next[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++] = keys[i];
+      }
+    });
+    keys.swap(scratch);
+  }
+
+  parallelChunks(workers, n, [&](unsigned, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      values[i] = keyFloat(keys[i]);
+    }
+  });
+}
+
+/*
+ * @brief Создать пустой файл сброса во временной директории
+ * @return путь к файлу или пустая строка при ошибке
+ */
+string createSpillFile() {
+  string path =
+      (fs::temp_directory_path() / "simpledag_sort_XXXXXX").string();
+  int fd = mkstemp(path.data());
+  if (fd < 0)
+    return "";
+  close(fd);
+  return path;
+}
+
+/*
+ * @brief Сбросить серию на диск: числа пишутся как есть, строки - длиной,
+ * байтами и еще раз длиной, чтобы файл читался и с конца
+ * @param run серия в памяти
+ * @return серия в файле или исходная серия, если файл не удалось записать
+ */
+shared_ptr<const SortRun> spillRun(const shared_ptr<const SortRun> &run) {
+  auto spilled = std::make_shared<SortRun>();
+  spilled->path = createSpillFile();
+  std::ofstream file(spilled->path, std::ios::binary);
+  if (spilled->path.empty() or !file) {
+    std::cerr << "Error creating sort spill file, keeping run in memory"
+              << std::endl;
+    return run;
+  }
+
+  if (run->numeric) {
+    file.write(reinterpret_cast<const char *>(run->numbers.data()),
+               run->numbers.size() * sizeof(float));
+  } else {
+    for (const string &value : run->strings) {
+      uint32_t size = value.size();
+      file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      file.write(value.data(), size);
+      file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    }
+  }
+  if (!file.flush()) {
+    std::cerr << "Error writing sort spill file, keeping run in memory"
+              << std::endl;
+    return run;
+  }
+
+  spilled->numeric = run->numeric;
+  spilled->count = run->count;
+  return spilled;
+}
+
+/*
+ * @brief Сбрасывать самые большие серии в памяти, пока их общий размер
+ * больше бюджета (нулевой бюджет не ограничивает память)
+ * @param state состояние сортировки
+ */
+void spillOverBudget(SortState &state) {
+  size_t used = 0;
+  for (const auto &run : state.runs) {
+    used += run->bytes;
+  }
+
+  while (state.budget and used > state.budget) {
+    auto largest = std::max_element(
+        state.runs.begin(), state.runs.end(),
+        [](const auto &a, const auto &b) { return a->bytes < b->bytes; });
+    shared_ptr<const SortRun> spilled = spillRun(*largest);
+    if (spilled == *largest)
+      return;
+    used -= (*largest)->bytes;
+    *largest = spilled;
+  }
+}
+
+/*
+ * @brief Размер строки в памяти серии
+ * @param value строка
+ * @return байты строки и ее описателя
+ */
+size_t stringBytes(const string &value) {
+  return sizeof(string) + value.size();
+}
+
+/**
+ * @brief Добавить отсортированные серии присутствующих чисел
+ * @param state состояние сортировки
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ */
+void sortInsert(SortState &state, const float *values,
+                const uint64_t *validity, size_t length) {
+  // серия не больше бюджета, чтобы ее можно было отсортировать в памяти
+  size_t limit = length;
+  if (state.budget)
+    limit = std::max<size_t>(1, state.budget / sizeof(float));
+  size_t i = 0;
+
+  while (i < length) {
+    auto run = std::make_shared<SortRun>();
+    for (; i < length and run->numbers.size() < limit; i++) {
+      if (isPresent(validity, i))
+        run->numbers.push_back(values[i]);
+    }
+    if (run->numbers.empty())
+      continue;
+
+    radixSort(run->numbers);
+    run->count = run->numbers.size();
+    run->bytes = run->count * sizeof(float);
+    state.runs.push_back(run);
+    spillOverBudget(state);
+  }
+}
+
+/**
+ * @brief Добавить отсортированные серии присутствующих строк
+ * @param state состояние сортировки
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ */
+void sortInsert(SortState &state, const string *values,
+                const uint64_t *validity, size_t length) {
+  size_t i = 0;
+
+  while (i < length) {
+    auto run = std::make_shared<SortRun>();
+    run->numeric = false;
+    for (; i < length; i++) {
+      // серия набирается до бюджета, но содержит хотя бы одну строку
+      if (state.budget and run->bytes >= state.budget)
+        break;
+      if (!isPresent(validity, i))
+        continue;
+      run->strings.push_back(values[i]);
+      run->bytes += stringBytes(values[i]);
+    }
+    if (run->strings.empty())
+      continue;
+
+    std::sort(run->strings.begin(), run->strings.end());
+    run->count = run->strings.size();
+    state.runs.push_back(run);
+    spillOverBudget(state);
+  }
+}
+
+/**
+ * @brief Добавить серии следующей части данных
+ * @param into накапливаемое состояние
+ * @param from состояние следующей части
+ */
+void sortMerge(SortState &into, const SortState &from) {
+  into.budget = std::max(into.budget, from.budget);
+  into.runs.insert(into.runs.end(), from.runs.begin(), from.runs.end());
+  spillOverBudget(into);
+}
+
+/*
+ * @brief Курсор чтения серии при слиянии: по возрастанию серия читается с
+ * начала, по убыванию - с конца
+ */
+struct RunCursor {
+  const SortRun *run = nullptr; // серия
+  size_t next = 0;              // количество прочитанных значений
+  std::ifstream file;           // файл сброса (если серия на диске)
+  bool backward = false;        // чтение с конца серии
+  size_t offset = 0;            // с конца: позиция конца непрочитанных байт
+  size_t block_end = 0;         // с конца: позиция конца блока в памяти
+  string block;                 // с конца: блок файла перед block_end
+};
+
+/*
+ * @brief Открыть курсор серии
+ * @param cursor курсор
+ * @param run серия
+ * @param backward читать с конца серии
+ */
+void openCursor(RunCursor &cursor, const SortRun *run, bool backward) {
+  cursor.run = run;
+  cursor.backward = backward;
+  if (run->path.empty())
+    return;
+  cursor.file.open(run->path, std::ios::binary);
+  if (backward) {
+    cursor.file.seekg(0, std::ios::end);
+    cursor.offset = cursor.block_end = size_t(cursor.file.tellg());
+  }
+}
+
+/*
+ * @brief Прочитать байты файла сброса перед текущей позицией при чтении с
+ * конца: файл читается блоками, поэтому значения не требуют отдельного
+ * обращения к диску
+ * @param cursor курсор
+ * @param out буфер результата
+ * @param bytes количество байт
+ */
+void readBack(RunCursor &cursor, char *out, size_t bytes) {
+  size_t block_begin = cursor.block_end - cursor.block.size();
+  if (cursor.offset < block_begin + bytes) {
+    size_t size = std::min(cursor.offset, std::max(SPILL_BLOCK, bytes));
+    cursor.block.resize(size);
+    cursor.block_end = cursor.offset;
+    block_begin = cursor.block_end - size;
+    cursor.file.seekg(block_begin);
+    cursor.file.read(cursor.block.data(), size);
+  }
+  cursor.offset -= bytes;
+  std::memcpy(out, cursor.block.data() + (cursor.offset - block_begin),
+              bytes);
+}
+
+/*
+ * @brief Прочитать следующее число серии
+ * @param cursor курсор
+ * @param value число (заполняется)
+ * @return false, если серия закончилась
+ */
+bool readNext(RunCursor &cursor, float &value) {
+  const SortRun &run = *cursor.run;
+  if (cursor.next == run.count)
+    return false;
+  size_t index = cursor.backward ? run.count - 1 - cursor.next : cursor.next;
+  if (run.path.empty())
+    value = run.numbers[index];
+  else if (cursor.backward)
+    readBack(cursor, reinterpret_cast<char *>(&value), sizeof(value));
+  else
+    cursor.file.read(reinterpret_cast<char *>(&value), sizeof(value));
+  cursor.next++;
+  return true;
+}
+
+/*
+ * @brief Прочитать следующую строку серии
+ * @param cursor курсор
+ * @param value строка (заполняется)
+ * @return false, если серия закончилась
+ */
+bool readNext(RunCursor &cursor, string &value) {
+  const SortRun &run = *cursor.run;
+  if (cursor.next == run.count)
+    return false;
+  uint32_t size = 0;
+  if (run.path.empty()) {
+    value = run.strings[cursor.backward ? run.count - 1 - cursor.next
+                                        : cursor.next];
+  } else if (cursor.backward) {
+    readBack(cursor, reinterpret_cast<char *>(&size), sizeof(size));
+    value.resize(size);
+    readBack(cursor, value.data(), size);
+    readBack(cursor, reinterpret_cast<char *>(&size), sizeof(size));
+  } else {
+    cursor.file.read(reinterpret_cast<char *>(&size), sizeof(size));
+    value.resize(size);
+    cursor.file.read(value.data(), size);
+    cursor.file.read(reinterpret_cast<char *>(&size), sizeof(size));
+  }
+  cursor.next++;
+  return true;
+}
+
+/*
+ * @brief Получить число в текстовом виде (как в столбцах таблицы)
+ * @param value число
+ * @return текст
+ */
+string formatNumber(float value) {
+  std::ostringstream text;
+  text << value;
+  return text.str();
+}
+
+/*
+ * @brief Получить числовую серию в виде отсортированной строковой серии
+ * @param run числовая серия
+ * @return строковая серия в памяти
+ */
+shared_ptr<const SortRun> stringRun(const SortRun &run) {
+  RunCursor cursor;
+  openCursor(cursor, &run, false);
+
+  auto strings = std::make_shared<SortRun>();
+  strings->numeric = false;
+  strings->count = run.count;
+  float value;
+  while (readNext(cursor, value)) {
+    strings->strings.push_back(formatNumber(value));
+  }
+  std::sort(strings->strings.begin(), strings->strings.end());
+  return strings;
+}
+
+/*
+ * @brief k-путевое слияние серий: куча хранит текущее значение каждой
+ * серии, а серии читаются с начала или с конца в зависимости от порядка
+ * @param runs серии
+ * @param descending слияние по убыванию
+ * @param visit функция, получающая значения по порядку
+ */
+template <typename Key>
+void mergeRuns(const vector<shared_ptr<const SortRun>> &runs,
+               bool descending,
+               const std::function<void(const Key &)> &visit) {
+  vector<RunCursor> cursors(runs.size());
+  using Head = std::pair<Key, size_t>;
+  // вершина кучи - наименьшее значение (по убыванию - наибольшее)
+  auto after = [descending](const Head &a, const Head &b) {
+    return descending ? a < b : b < a;
+  };
+  std::priority_queue<Head, vector<Head>, decltype(after)> heap(after);
+
+  for (size_t r = 0; r < runs.size(); r++) {
+    openCursor(cursors[r], runs[r].get(), descending);
+    Key value;
+    if (readNext(cursors[r], value))
+      heap.push({std::move(value), r});
+  }
+
+  while (!heap.empty()) {
+    Head head = heap.top();
+    heap.pop();
+    visit(head.first);
+    Key value;
+    if (readNext(cursors[head.second], value))
+      heap.push({std::move(value), head.second});
+  }
+}
+
+/**
+ * @brief Передать все значения по порядку k-путевым слиянием серий: значения
+ * не собираются в памяти, а передаются по одному по мере слияния. Числа
+ * сравниваются как числа, но если среди серий есть строковые, все значения
+ * сравниваются как строки
+ * @param state состояние сортировки
+ * @param descending по убыванию (иначе по возрастанию)
+ * @param visit функция, получающая значения в текстовом виде
+ */
+void forEachSorted(const SortState &state, bool descending,
+                   const std::function<void(const string &)> &visit) {
+  bool numeric = true;
+  for (const auto &run : state.runs) {
+    numeric = numeric and run->numeric;
+  }
+
+  if (numeric) {
+    mergeRuns<float>(state.runs, descending, [&](const float &value) {
+      visit(formatNumber(value));
+    });
+    return;
+  }
+
+  vector<shared_ptr<const SortRun>> runs;
+  for (const auto &run : state.runs) {
+    runs.push_back(run->numeric ? stringRun(*run) : run);
+  }
+  mergeRuns<string>(runs, descending, visit);
+}
@@ -0,0 +1,309 @@
+#include "../include/topk.h"
+#include "../include/column.h"
+#include "../include/kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// минимальная часть столбца одного потока при поиске лучших чисел
+const size_t PARALLEL_TOPK = 1 << 16;
+
+/*
+ * @brief Сравнение чисел top_k: лучшее значение, при равенстве - меньший
+ * номер строки. В куче с этим сравнением в корне худшее значение
+ */
+struct BetterEntry {
+  bool ascending; // лучшие - наименьшие
+
+  bool operator()(const TopEntry &a, const TopEntry &b) const {
+    if (a.value != b.value)
+      return ascending ? a.value < b.value : a.value > b.value;
+    return a.row < b.row;
+  }
+};
+
+/*
+ * @brief Добавить значение в ограниченную кучу: если куча полна, значение
+ * вытесняет худшее из корня, только если оно лучше
+ * @param heap куча
+ * @param value значение
+ * @param k размер кучи
+ * @param better сравнение
+ */
+template <typename T, typename Better>
+void pushBounded(vector<T> &heap, T value, size_t k, Better better) {
+  if (heap.size() < k) {
+    heap.push_back(std::move(value));
+    std::push_heap(heap.begin(), heap.end(), better);
+  } else if (!heap.empty() and better(value, heap.front())) {
+    std::pop_heap(heap.begin(), heap.end(), better);
+    heap.back() = std::move(value);
+    std::push_heap(heap.begin(), heap.end(), better);
+  }
+}
+
+/*
+ * @brief Ограничение количества счетчиков строк
+ * @param state состояние top_k
+ * @return количество счетчиков или 0 без ограничения (самые редкие строки)
+ */
+size_t counterCapacity(const TopKState &state) {
+  if (state.ascending)
+    return 0;
+  return std::max(state.k * TOPK_COUNTERS, MIN_TOPK_COUNTERS);
+}
+
+/*
+ * @brief Сравнение счетчиков кучи: в корне самый редкий счетчик
+ */
+struct MoreFrequent {
+  bool operator()(const TopCounter &a, const TopCounter &b) const {
+    return a.count.count > b.count.count;
+  }
+};
+
+/*
+ * @brief Поменять счетчики местами и обновить их номера
+ * @param state состояние top_k
+ * @param a номер первого счетчика
+ * @param b номер второго счетчика
+ */
+void swapCounters(TopKState &state, size_t a, size_t b) {
+  std::swap(state.counters[a], state.counters[b]);
+  state.positions[state.counters[a].value] = a;
+  state.positions[state.counters[b].value] = b;
+}
+
+/*
+ * @brief Поднять счетчик к корню кучи, пока он реже родителя
+ * @param state состояние top_k
+ * @param i номер счетчика
+ */
+void siftUp(TopKState &state, size_t i) {
+  MoreFrequent more;
+  while (i > 0 and more(state.counters[(i - 1) / 2], state.counters[i])) {
+    swapCounters(state, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+/*
+ * @brief Опустить счетчик от корня кучи, пока он чаще потомков
+ * @param state состояние top_k
+ * @param i номер счетчика
+ */
+void siftDown(TopKState &state, size_t i) {
+  MoreFrequent more;
+  size_t n = state.counters.size();
+  while (true) {
+    size_t rarest = i;
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2 and child < n;
+         child++) {
+      if (more(state.counters[rarest], state.counters[child]))
+        rarest = child;
+    }
+    if (rarest == i)
+      return;
+    swapCounters(state, i, rarest);
+    i = rarest;
+  }
+}
+
+/*
+ * @brief Учесть появление строки: счетчик строки увеличивается, новая строка
+ * получает свободный счетчик или вытесняет самый редкий
+ * @param state состояние top_k
+ * @param value строка
+ * @param row номер строки
+ * @param capacity ограничение количества счетчиков (0 - без ограничения)
+ */
+void countString(TopKState &state, const string &value, size_t row,
+                 size_t capacity) {
+  auto found = state.positions.find(value);
+  if (found != state.positions.end()) {
+    state.counters[found->second].count.count++;
+    if (capacity)
+      siftDown(state, found->second);
+    return;
+  }
+
+  if (!capacity or state.counters.size() < capacity) {
+    state.positions.emplace(value, state.counters.size());
+    state.counters.push_back({value, {1, row}});
+    if (capacity)
+      siftUp(state, state.counters.size() - 1);
+    return;
+  }
+
+  // частота вытесненной строки переходит к новой как верхняя оценка
+  TopCounter &rarest = state.counters.front();
+  state.positions.erase(rarest.value);
+  rarest.value = value;
+  rarest.count.count++;
+  rarest.count.row = row;
+  state.positions.emplace(value, 0);
+  siftDown(state, 0);
+}
+
+/**
+ * @brief Добавить присутствующие числа: каждый поток ведет свою
+ * ограниченную кучу над частью столбца, затем кучи объединяются. Время
+ * O(n log k), память O(k) на поток. Значения NaN пропускаются
+ * @param state состояние top_k
+ * @param values указатель на значения
+ * @param validity слова маски валидности или nullptr
+ * @param length количество значений
+ * @param rows номера строк значений или nullptr, если i-е значение
+ * находится в строке i (разреженный столбец)
+ * @param workers количество потоков (0 - по числу ядер)
+ */
+void topKInsert(TopKState &state, const float *values,
+                const uint64_t *validity, size_t length,
+                const uint32_t *rows, unsigned workers) {
+  if (!state.k)
+    return;
+
+  workers = resolveWorkers(workers);
+  workers = unsigned(std::max<size_t>(
+      1, std::min<size_t>(workers, length / PARALLEL_TOPK)));
+
+  BetterEntry better{state.ascending};
+  vector<vector<TopEntry>> heaps(workers);
+  parallelChunks(workers, length, [&](unsigned w, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (isPresent(validity, i) and !std::isnan(values[i]))
+        pushBounded(heaps[w], TopEntry{values[i], rows ? rows[i] : i},
+                    state.k, better);
+    }
+  });
+
+  for (const vector<TopEntry> &heap : heaps) {
+    for (const TopEntry &entry : heap) {
+      pushBounded(state.heap, entry, state.k, better);
+    }
+  }
+}
+
+/**
+ * @brief Добавить частоты присутствующих строк
+ * @param state состояние top_k
+ * @param values указатель на строки
+ * @param validity слова маски валидности или nullptr
+ * @param length количество строк
+ * @param rows номера строк значений или nullptr, если i-е значение
+ * находится в строке i (разреженный столбец)
+ */
+void topKInsert(TopKState &state, const string *values,
+                const uint64_t *validity, size_t length,
+                const uint32_t *rows) {
+  if (!state.k)
+    return;
+
+  size_t capacity = counterCapacity(state);
+  for (size_t i = 0; i < length; i++) {
+    if (isPresent(validity, i))
+      countString(state, values[i], rows ? rows[i] : i, capacity);
+  }
+}
+
+/**
+ * @brief Добавить состояние следующей части данных
+ * @param into накапливаемое состояние
+ * @param from состояние следующей части
+ * @param offset количество строк предыдущих частей: сдвиг номеров строк from
+ */
+void topKMerge(TopKState &into, const TopKState &from, size_t offset) {
+  if (!into.k) {
+    into.k = from.k;
+    into.ascending = from.ascending;
+  }
+
+  BetterEntry better{into.ascending};
+  for (const TopEntry &entry : from.heap) {
+    pushBounded(into.heap, TopEntry{entry.value, offset + entry.row}, into.k,
+                better);
+  }
+  if (from.counters.empty())
+    return;
+
+  // строка, которой нет в полном наборе счетчиков, встречалась не чаще его
+  // самого редкого счетчика: он добавляется как верхняя оценка
+  size_t capacity = counterCapacity(into);
+  auto bound = [capacity](const TopKState &state) -> size_t {
+    return capacity and state.counters.size() >= capacity
+               ? state.counters.front().count.count
+               : 0;
+  };
+  size_t into_bound = bound(into);
+  size_t from_bound = bound(from);
+
+  for (TopCounter &counter : into.counters) {
+    auto found = from.positions.find(counter.value);
+    counter.count.count += found == from.positions.end()
+                               ? from_bound
+                               : from.counters[found->second].count.count;
+  }
+  for (const TopCounter &counter : from.counters) {
+    if (!into.positions.count(counter.value))
+      into.counters.push_back(
+          {counter.value,
+           {counter.count.count + into_bound, offset + counter.count.row}});
+  }
+
+  // остаются самые частые счетчики
+  if (capacity and into.counters.size() > capacity) {
+    std::nth_element(into.counters.begin(),
+                     into.counters.begin() + capacity, into.counters.end(),
+                     MoreFrequent());
+    into.counters.resize(capacity);
+  }
+  if (capacity)
+    std::make_heap(into.counters.begin(), into.counters.end(),
+                   MoreFrequent());
+  into.positions.clear();
+  for (size_t i = 0; i < into.counters.size(); i++) {
+    into.positions[into.counters[i].value] = i;
+  }
+}
+
+/**
+ * @brief Получить лучшие числа от лучшего к худшему (при равенстве - по
+ * номеру строки)
+ * @param state состояние top_k
+ * @return не более k значений с номерами строк
+ */
+vector<TopEntry> topKValues(const TopKState &state) {
+  vector<TopEntry> values = state.heap;
+  std::sort_heap(values.begin(), values.end(), BetterEntry{state.ascending});
+  return values;
+}
+
+/**
+ * @brief Выбрать самые частые (ascending - самые редкие) строки ограниченной
+ * кучей за O(m log k), где m - количество счетчиков
+ * @param state состояние top_k
+ * @return не более k строк с частотами от лучшей к худшей (при равенстве -
+ * по первой строке)
+ */
+vector<pair<string, TopCount>> topKStrings(const TopKState &state) {
+  using Item = const TopCounter *;
+  bool ascending = state.ascending;
+  auto better = [ascending](Item a, Item b) {
+    if (a->count.count != b->count.count)
+      return ascending ? a->count.count < b->count.count
+                       : a->count.count > b->count.count;
+    return a->count.row < b->count.row;
+  };
+
+  vector<Item> heap;
+  for (const TopCounter &counter : state.counters) {
+    pushBounded(heap, &counter, state.k, better);
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+
+  vector<pair<string, TopCount>> result;
+  for (Item item : heap) {
+    result.push_back({item->value, item->count});
+  }
+  return result;
+}
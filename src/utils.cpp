@@ -2,6 +2,7 @@
 #include "../include/graphics.h"
 #include "../include/operations.h"
 #include "../include/parser.h"
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -20,15 +21,18 @@ const string SETUP = "setup.conf";
 
 namespace logger {
 fstream log;
+const size_t LOG_BLOCK = 1 << 20; // размер блока записи результатов групп
 
 /*
  * @brief Открыть лог
  * @param путь к файлу лога
+ * @return true, если файл лога открыт
  */
-void openLog(string path) {
+bool openLog(string path) {
   log.open(path, std::ios::out); // Исправлено: открываем глобальную переменную
   if (not log.is_open())
     std::cerr << "Failed to open log" << std::endl;
+  return log.is_open();
 }
 
 /*
@@ -36,7 +40,7 @@ void openLog(string path) {
  * @param id уникальный идентификатор операции
  * @param res результат выполнения
  */
-void writeResult(string id, float res) {
+void writeResult(const string &id, float res) {
   if (log.is_open()) {
     log << id << " >> " << res << std::endl;
   }
@@ -47,12 +51,88 @@ void writeResult(string id, float res) {
  * @param id уникальный идентификатор операции
  * @param res результат выполнения
  */
-void writeResult(string id, string res) {
+void writeResult(const string &id, const string &res) {
   if (log.is_open()) {
     log << id << " >> " << res << std::endl;
   }
 }
 
+/*
+ * @brief Записать строковый результат по частям без сборки в одну строку:
+ * присутствующие строки частей пишутся в лог по порядку
+ * @param id уникальный идентификатор операции
+ * @param parts части результата
+ */
+void writeStream(const string &id, const vector<StringView> &parts) {
+  if (not log.is_open())
+    return;
+
+  // поток лога буферизован, поэтому строки пишутся без промежуточной копии
+  log << id << " >> ";
+  for (const StringView &part : parts) {
+    for (size_t i = 0; i < part.length; i++) {
+      if (isPresent(part.validity, i))
+        log.write(part.values[i].data(), part.values[i].size());
+    }
+  }
+  log << std::endl;
+}
+
+/*
+ * @brief Записать отсортированные значения через запятую по мере слияния
+ * серий, без сборки результата в одну строку
+ * @param id уникальный идентификатор операции
+ * @param state состояние сортировки
+ * @param descending по убыванию (иначе по возрастанию)
+ */
+void writeSorted(const string &id, const SortState &state, bool descending) {
+  if (not log.is_open())
+    return;
+
+  log << id << " >> ";
+  bool first = true;
+  forEachSorted(state, descending, [&](const string &value) {
+    if (!first)
+      log << ',';
+    log.write(value.data(), value.size());
+    first = false;
+  });
+  log << std::endl;
+}
+
+/*
+ * @brief Записать результаты операции по группам
+ * @param id уникальный идентификатор операции
+ * @param keys ключи групп
+ * @param res результаты в порядке ключей
+ */
+void writeGroups(const string &id, const vector<string> &keys,
+                 const vector<float> &res) {
+  if (not log.is_open())
+    return;
+
+  // строки групп собираются в буфер и пишутся крупными блоками без сброса
+  // потока после каждой строки
+  string buffer;
+  char number[32];
+  for (size_t g = 0; g < keys.size(); g++) {
+    std::snprintf(number, sizeof(number), "%g", res[g]);
+    buffer += id;
+    buffer += '[';
+    buffer += keys[g];
+    buffer += "] >> ";
+    buffer += number;
+    buffer += '\n';
+
+    if (buffer.size() >= LOG_BLOCK) {
+      log.write(buffer.data(), buffer.size());
+      buffer.clear();
+    }
+  }
+  log.write(buffer.data(), buffer.size());
+  log.flush();
+}
+
 /*
  * @brief Записать предупреждения
  * @param massage сообщение
@@ -63,6 +143,17 @@ void warning(string message) {
   }
 }
 
+/*
+ * @brief Записать повторное использование результата из кэша
+ * @param id уникальный идентификатор операции
+ * @param source id операции, чей результат использован
+ */
+void cacheHit(string id, string source) {
+  if (log.is_open()) {
+    log << id << " << cache hit: " << source << std::endl;
+  }
+}
+
 /*
  * @brief Закрыть лог
  */
@@ -284,34 +375,3 @@ vector<string> collectFiles(string path, string extension) {
 
   return files;
 }
-
-/*
- * @brief Процедура запуска операции в узле графа
- * @param node указатель на узел графа
- */
-void procedure(Node *node) {
-  string id = node->id;
-  string type = config::getFuncById(id);
-  int column = config::getColumnById(id);
-
-  switch (table::getTypeOfColumn(column)) {
-
-  case NUMERIC: {
-    vector<float> num_vec = table::readNumericColumn(column);
-    logger::writeResult(id, callOperation(type, num_vec));
-    break;
-  }
-
-  case STRING: {
-    vector<string> str_vec = table::readStringColumn(column);
-    logger::writeResult(id, callOperation(type, str_vec));
-    break;
-  }
-
-  case UNKNOWN: {
-    string message = "Unknown type found in column " + std::to_string(column) +
-                     ". Skipping " + id;
-    logger::warning(message);
-  }
-  }
-}
@@ -0,0 +1,126 @@
+#include "../include/window.h"
+#include "../include/kernels.h"
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+/*
+ * @brief Значения столбца по строкам таблицы: плотный столбец читается без
+ * копирования, а разреженный раскладывается по строкам
+ */
+struct RowValues {
+  const float *values = nullptr;      // значения по строкам (0 - пропуск)
+  const uint64_t *validity = nullptr; // слова маски или nullptr
+  vector<float> buffer;               // значения разреженного столбца
+  Bitmap present;                     // маска разреженного столбца
+};
+
+/*
+ * @brief Получить значения столбца по строкам таблицы
+ * @param column числовой столбец
+ * @param rows значения (заполняются)
+ */
+void rowValues(const NumericColumn &column, RowValues &rows) {
+  if (column.layout == DENSE) {
+    rows.values = column.values.data();
+    rows.validity = validityWords(column);
+    return;
+  }
+
+  rows.buffer.assign(column.length, 0);
+  rows.present = createBitmap(column.length);
+  for (size_t i = 0; i < column.values.size(); i++) {
+    rows.buffer[column.rows[i]] = column.values[i];
+    setBit(rows.present, column.rows[i]);
+  }
+  rows.values = rows.buffer.data();
+  rows.validity = rows.present.words.data();
+}
+
+/*
+ * @brief Вычислить скользящую сумму или среднее
+ * @param column числовой столбец
+ * @param window размер окна в строках
+ * @param average true - среднее, false - сумма
+ * @return производный столбец
+ */
+NumericColumn rollingColumn(const NumericColumn &column, size_t window,
+                            bool average) {
+  size_t length = column.length;
+  RowValues rows;
+  rowValues(column, rows);
+
+  vector<float> result(length, 0);
+  Bitmap present = createBitmap(length);
+  double sum = 0;
+  size_t count = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    // значение, вошедшее в окно, прибавляется, а вышедшее - вычитается
+    bool in = isPresent(rows.validity, i);
+    sum += in ? rows.values[i] : 0;
+    count += in;
+    if (i >= window) {
+      bool out = isPresent(rows.validity, i - window);
+      sum -= out ? rows.values[i - window] : 0;
+      count -= out;
+    }
+
+    if (count == 0) {
+      // пустое окно сбрасывает накопленную ошибку округления
+      sum = 0;
+      continue;
+    }
+    result[i] = average ? sum / count : sum;
+    setBit(present, i);
+  }
+  return makeNumericColumn(std::move(result), std::move(present));
+}
+
+/**
+ * @brief Скользящая сумма: значение строки - сумма присутствующих значений
+ * последних window строк, включая текущую. Строка, в окне которой нет
+ * значений, считается пропуском
+ * @param column числовой столбец
+ * @param window размер окна в строках (не меньше 1)
+ * @return производный столбец
+ */
+NumericColumn rollingSum(const NumericColumn &column, size_t window) {
+  return rollingColumn(column, window, false);
+}
+
+/**
+ * @brief Скользящее среднее: значение строки - среднее присутствующих
+ * значений последних window строк, включая текущую. Строка, в окне которой
+ * нет значений, считается пропуском
+ * @param column числовой столбец
+ * @param window размер окна в строках (не меньше 1)
+ * @return производный столбец
+ */
+NumericColumn rollingAverage(const NumericColumn &column, size_t window) {
+  return rollingColumn(column, window, true);
+}
+
+/**
+ * @brief Накопленная сумма: значение строки - сумма присутствующих значений
+ * от первой строки до текущей. Строки без значения остаются пропусками
+ * @param column числовой столбец
+ * @return производный столбец
+ */
+NumericColumn cumulativeSum(const NumericColumn &column) {
+  RowValues rows;
+  rowValues(column, rows);
+
+  vector<float> result(column.length);
+  maskedPrefixSum(rows.values, rows.validity, column.length, result.data());
+
+  Bitmap present = createBitmap(column.length);
+  for (size_t i = 0; i < column.length; i++) {
+    if (isPresent(rows.validity, i))
+      setBit(present, i);
+    else
+      result[i] = 0; // значения пропусков в плотном столбце равны 0
+  }
+  return makeNumericColumn(std::move(result), std::move(present));
+}
@@ -0,0 +1,242 @@
+#include "../../include/column.h"
+#include "../../include/kernels.h"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Тест установки и проверки битов маски валидности
+TEST(COLUMN, BitmapSetAndTest) {
+  Bitmap bitmap = createBitmap(130);
+  setBit(bitmap, 0);
+  setBit(bitmap, 64);
+  setBit(bitmap, 129);
+
+  EXPECT_EQ(bitmap.words.size(), 3);
+  EXPECT_TRUE(testBit(bitmap, 0));
+  EXPECT_FALSE(testBit(bitmap, 1));
+  EXPECT_TRUE(testBit(bitmap, 64));
+  EXPECT_TRUE(testBit(bitmap, 129));
+  EXPECT_EQ(countBits(bitmap), 3);
+}
+
+// Тест пустой маски: все значения присутствуют
+TEST(COLUMN, EmptyBitmapMeansAllPresent) {
+  Bitmap bitmap;
+  bitmap.length = 10;
+
+  EXPECT_TRUE(testBit(bitmap, 7));
+  EXPECT_EQ(countBits(bitmap), 10);
+}
+
+// Тест выбора плотного представления и отказа от маски без пропусков
+TEST(COLUMN, DenseWithoutMissing) {
+  Bitmap validity = createBitmap(3);
+  setBit(validity, 0);
+  setBit(validity, 1);
+  setBit(validity, 2);
+
+  NumericColumn column = makeNumericColumn({1, 2, 3}, validity);
+
+  EXPECT_EQ(column.layout, DENSE);
+  EXPECT_EQ(column.length, 3);
+  EXPECT_EQ(validityWords(column), nullptr);
+  EXPECT_EQ(presentCount(column), 3);
+}
+
+// Тест выбора разреженного представления для почти пустого столбца
+TEST(COLUMN, SparseForMostlyMissing) {
+  vector<float> values(100, 0);
+  Bitmap validity = createBitmap(100);
+  values[10] = 5;
+  values[70] = 7;
+  setBit(validity, 10);
+  setBit(validity, 70);
+
+  NumericColumn column = makeNumericColumn(values, validity);
+
+  EXPECT_EQ(column.layout, SPARSE);
+  EXPECT_EQ(column.length, 100);
+  EXPECT_EQ(column.values, vector<float>({5, 7}));
+  EXPECT_EQ(column.rows, vector<uint32_t>({10, 70}));
+  EXPECT_EQ(presentCount(column), 2);
+}
+
+// Тест строкового столбца с пропусками
+TEST(COLUMN, StringDenseWithMissing) {
+  Bitmap validity = createBitmap(4);
+  setBit(validity, 0);
+  setBit(validity, 1);
+  setBit(validity, 3);
+
+  StringColumn column = makeStringColumn({"a", "b", "", "d"}, validity);
+
+  EXPECT_EQ(column.layout, DENSE);
+  EXPECT_NE(validityWords(column), nullptr);
+  EXPECT_EQ(presentCount(column), 3);
+}
+
+// Тест маскированной суммы: пропуски не учитываются
+TEST(KERNELS, MaskedSumSkipsMissing) {
+  vector<float> values(200);
+  Bitmap validity = createBitmap(200);
+  double expected = 0;
+
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = i;
+    if (i % 3 == 0) {
+      setBit(validity, i);
+      expected += i;
+    }
+  }
+
+  EXPECT_EQ(maskedSum(values.data(), validity.words.data(), values.size()),
+            expected);
+  EXPECT_EQ(maskedCount(validity.words.data(), values.size()), 67);
+}
+
+// Тест маскированной суммы без маски
+TEST(KERNELS, MaskedSumWithoutMask) {
+  vector<float> values(150, 2);
+
+  EXPECT_EQ(maskedSum(values.data(), nullptr, values.size()), 300);
+  EXPECT_EQ(maskedCount(nullptr, values.size()), 150);
+}
+
+// Тест точности: накопление в двойной точности не теряет единицы после 2^24
+TEST(KERNELS, MaskedSumKeepsPrecision) {
+  size_t length = (size_t(1) << 24) + 1000;
+  vector<float> values(length, 1);
+
+  EXPECT_EQ(maskedSum(values.data(), nullptr, length), double(length));
+}
+
+// Тест совпадения блочной части и хвоста с построчной суммой
+TEST(KERNELS, MaskedSumMatchesScalar) {
+  vector<float> values(1000);
+  Bitmap validity = createBitmap(values.size());
+  double expected = 0;
+
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = 0.5f * (i % 17) - 3;
+    if (i % 5 != 1) {
+      setBit(validity, i);
+      expected += values[i];
+    }
+  }
+
+  EXPECT_DOUBLE_EQ(
+      maskedSum(values.data(), validity.words.data(), values.size()),
+      expected);
+}
+
+// Тест моментов: совпадение с двухпроходным расчетом с учетом пропусков
+TEST(KERNELS, MaskedMomentsMatchTwoPass) {
+  vector<float> values(10000);
+  Bitmap validity = createBitmap(values.size());
+  double sum = 0;
+  size_t count = 0;
+
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = 0.25f * (i % 31) - 2 + (i % 7 == 0 ? 10 : 0);
+    if (i % 4 != 3) {
+      setBit(validity, i);
+      sum += values[i];
+      count++;
+    }
+  }
+
+  double mean = sum / count;
+  double m2 = 0, m3 = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    if (testBit(validity, i)) {
+      double d = values[i] - mean;
+      m2 += d * d;
+      m3 += d * d * d;
+    }
+  }
+
+  Moments moments =
+      maskedMoments(values.data(), validity.words.data(), values.size());
+
+  EXPECT_EQ(moments.count, count);
+  EXPECT_DOUBLE_EQ(moments.sum, sum);
+  EXPECT_NEAR(moments.mean, mean, 1e-12);
+  EXPECT_NEAR(moments.m2 / m2, 1, 1e-12);
+  EXPECT_NEAR(moments.m3 / m3, 1, 1e-9);
+  EXPECT_EQ(moments.min, -2);
+  EXPECT_EQ(moments.max, 0.25f * 30 - 2 + 10);
+}
+
+// Тест гистограммы: блочная часть и хвост совпадают с построчным подсчетом,
+// пропуски, NaN и значения вне диапазона не учитываются, max попадает в
+// последнюю корзину
+TEST(KERNELS, MaskedHistogramMatchesScalar) {
+  vector<float> values(1000);
+  Bitmap validity = createBitmap(values.size());
+  vector<uint64_t> expected(7, 0);
+
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = 0.5f * (i % 19) - 2;
+    if (i % 11 == 0)
+      values[i] = NAN;
+    if (i % 5 != 1)
+      setBit(validity, i);
+    if (i % 5 != 1 and values[i] >= -1 and values[i] <= 6)
+      expected[std::min<size_t>((values[i] + 1) * 1.0f, 6)]++;
+  }
+
+  vector<uint64_t> counts(7, 0);
+  maskedHistogram(values.data(), validity.words.data(), values.size(), -1, 6,
+                  7, counts.data());
+  EXPECT_EQ(counts, expected);
+
+  float min, max;
+  maskedRange(values.data(), validity.words.data(), values.size(), min, max);
+  EXPECT_EQ(min, -2);
+  EXPECT_EQ(max, 7);
+}
+
+// Тест вложенного параллелизма: в частях parallelChunks ядра выполняются в
+// одном потоке, а вне их получают запрошенное количество потоков
+TEST(KERNELS, NestedWorkersRunSerially) {
+  vector<unsigned> nested(4, 0);
+  parallelChunks(4, 4, [&](unsigned w, size_t, size_t) {
+    nested[w] = resolveWorkers(0);
+  });
+
+  EXPECT_EQ(nested, vector<unsigned>(4, 1));
+  EXPECT_EQ(resolveWorkers(3), 3);
+  {
+    WorkerThreadScope scope;
+    EXPECT_EQ(resolveWorkers(3), 1);
+  }
+  EXPECT_EQ(resolveWorkers(3), 3);
+}
+
+// Тест ошибок частей: исключение потока передается вызывающему после
+// завершения всех потоков, а 0 потоков разрешается по числу ядер
+TEST(KERNELS, ParallelChunksRethrows) {
+  vector<int> done(4, 0);
+  EXPECT_THROW(parallelChunks(4, 4,
+                              [&](unsigned w, size_t, size_t) {
+                                done[w] = 1;
+                                if (w == 2)
+                                  throw std::runtime_error("part failed");
+                              }),
+               std::runtime_error);
+  EXPECT_EQ(done, vector<int>(4, 1));
+
+  size_t covered = 0;
+  std::mutex lock;
+  parallelChunks(0, 1000, [&](unsigned, size_t begin, size_t end) {
+    std::lock_guard<std::mutex> guard(lock);
+    covered += end - begin;
+  });
+  EXPECT_EQ(covered, 1000);
+}
@@ -0,0 +1,241 @@
+#include "../../include/executor.h"
+#include "../../include/graph.h"
+#include "../../include/parser.h"
+#include "../../include/utils.h"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+// Вспомогательная функция создания набора файлов данных
+void createShards(const string &dir) {
+  fs::create_directory(dir);
+  std::ofstream(dir + "/part_2.csv") << "3,c\n4,d\n";
+  std::ofstream(dir + "/part_1.csv") << "1,a\n2,b\n";
+  std::ofstream(dir + "/part_3.csv") << "5,e\n,f\n";
+  std::ofstream(dir + "/notes.txt") << "not a shard\n";
+}
+
+// Тест поиска файлов данных в директории
+TEST(EXECUTOR, ResolveDirectory) {
+  string dir = "shards_dir";
+  createShards(dir);
+
+  vector<string> expected = {dir + "/part_1.csv", dir + "/part_2.csv",
+                             dir + "/part_3.csv"};
+  EXPECT_EQ(expected, executor::resolveShards(dir));
+
+  fs::remove_all(dir);
+}
+
+// Тест поиска файлов данных по шаблону имени
+TEST(EXECUTOR, ResolveGlob) {
+  string dir = "shards_glob";
+  createShards(dir);
+
+  vector<string> expected = {dir + "/part_1.csv", dir + "/part_2.csv"};
+  EXPECT_EQ(expected, executor::resolveShards(dir + "/part_[12].csv"));
+
+  fs::remove_all(dir);
+}
+
+// Тест одиночного файла
+TEST(EXECUTOR, ResolveSingleFile) {
+  vector<string> expected = {"data.csv"};
+  EXPECT_EQ(expected, executor::resolveShards("data.csv"));
+}
+
+// Тест параллельной обработки и объединения в порядке файлов
+TEST(EXECUTOR, RunShardsMergesInOrder) {
+  string dir = "shards_run";
+  createShards(dir);
+
+  vector<plan::Task> tasks = {{"total", "sum", 0},
+                              {"mean", "average", 0},
+                              {"letters", "concatinate", 1}};
+  plan::resolveOperations(tasks);
+  vector<string> shards = executor::resolveShards(dir);
+
+  auto results = executor::runShards(shards, tasks, 3);
+
+  EXPECT_EQ(results["total"]->sum, 15);
+  EXPECT_EQ(results["total"]->count, 5);
+  EXPECT_EQ(finalizeNumeric("average", *results["mean"]), 3);
+  EXPECT_EQ(finalizeString("concatinate", *results["letters"]), "abcdef");
+  EXPECT_EQ(results["letters"]->type, STRING);
+
+  fs::remove_all(dir);
+}
+
+// Тест объединения типов: строковое значение в одном файле делает столбец
+// строковым
+TEST(EXECUTOR, MergedTypeMismatch) {
+  string dir = "shards_mixed";
+  fs::create_directory(dir);
+  std::ofstream(dir + "/a.csv") << "1\n2\n";
+  std::ofstream(dir + "/b.csv") << "x\n";
+
+  vector<plan::Task> tasks = {{"total", "sum", 0}};
+  plan::resolveOperations(tasks);
+  auto results = executor::runShards(executor::resolveShards(dir), tasks, 2);
+
+  EXPECT_EQ(results["total"]->type, STRING);
+
+  fs::remove_all(dir);
+}
+
+// Тест соединения набора файлов с именованной таблицей: соединение
+// выполняется в каждом файле, а операции над именованной таблицей - один раз
+TEST(EXECUTOR, JoinFeedsAggregates) {
+  string dir = "shards_join";
+  createShards(dir);
+  std::ofstream(dir + "/prices.txt") << "a,10\nc,30\nf,60\nz,90\n";
+  table::readNamed("prices", dir + "/prices.txt");
+
+  vector<plan::Task> tasks = {{"joined", "join", 1, {{"right", "prices"}}},
+                              {"total", "sum", 3},
+                              {"all_prices", "sum", 1}};
+  tasks[1].table = "joined";
+  tasks[2].table = "prices";
+  plan::resolveOperations(tasks);
+
+  auto results = executor::runShards(executor::resolveShards(dir), tasks, 2);
+
+  EXPECT_EQ(results["joined"]->count, 3);
+  EXPECT_EQ(finalizeString("join", *results["joined"]), "3");
+  EXPECT_EQ(results["total"]->sum, 100);
+  EXPECT_EQ(results["total"]->count, 3);
+  EXPECT_EQ(results["all_prices"]->sum, 190);
+
+  // ошибка соединения записывается для операции, а не теряется
+  tasks.push_back({"lost", "join", 1, {{"right", "absent"}}});
+  plan::resolveOperations(tasks);
+  map<string, string> failed;
+  executor::runShards(executor::resolveShards(dir), tasks, 2, nullptr,
+                      &failed);
+  EXPECT_EQ(failed, (map<string, string>({{"lost", "Right table not found"}})));
+
+  table::clear();
+  fs::remove_all(dir);
+}
+
+// Тест передачи результатов по связям графа: числа родителей дают числовой
+// вход, а столбец читается из общего буфера без копирования
+TEST(EXECUTOR, UpstreamResults) {
+  Node *first = createNode("first");
+  Node *second = createNode("second");
+  first->output.kind = NUMBER_OUTPUT;
+  first->output.number = 2;
+  second->output.kind = NUMBER_OUTPUT;
+  second->output.number = 4;
+
+  PartialResult numbers =
+      executor::upstreamState({first, second}, needsOf("average", {}));
+  EXPECT_EQ(numbers.type, NUMERIC);
+  EXPECT_FLOAT_EQ(finalizeNumeric("average", numbers, {}), 3);
+
+  auto column = std::make_shared<const StringColumn>(
+      makeStringColumn({"a", "b"}, Bitmap()));
+  second->output.kind = COLUMN_OUTPUT;
+  second->output.column = column;
+  EXPECT_EQ(column.use_count(), 2);
+
+  PartialResult text =
+      executor::upstreamState({first, second}, needsOf("concatinate", {}));
+  EXPECT_EQ(text.type, STRING);
+  EXPECT_EQ(finalizeString("concatinate", text, {}), "2ab");
+  EXPECT_EQ(column.use_count(), 2);
+
+  // у источника нет результата
+  first->output = NodeOutput();
+  EXPECT_EQ(executor::upstreamState({first}, {}).type, UNKNOWN);
+
+  delete first;
+  delete second;
+}
+
+// Тест записи результатов узлов: операции берутся из плана, поэтому запись
+// работает и после очистки конфигурации, а операции с ошибками и столбцы
+// неизвестного типа пропускаются с предупреждением
+TEST(EXECUTOR, WriteMergedLogsResults) {
+  string config_file = "executor_write.yaml";
+  string result_file = "executor_write.txt";
+  string csv_file = "executor_write.csv";
+  std::ofstream(csv_file) << "1,a\n2,b\n3,c\n";
+  std::ofstream(config_file) << "operations:\n"
+                             << "  total:\n"
+                             << "    func: sum\n"
+                             << "    column: 0\n"
+                             << "  mean:\n"
+                             << "    func: average\n"
+                             << "    column: 0\n"
+                             << "  letters:\n"
+                             << "    func: concatinate\n"
+                             << "    column: 1\n"
+                             << "  missing:\n"
+                             << "    func: sum\n"
+                             << "    column: 9\n"
+                             << "  bad:\n"
+                             << "    func: sum\n"
+                             << "    column: abc\n"
+                             << "  picked:\n"
+                             << "    func: filter\n"
+                             << "    column: 0\n"
+                             << "    op: =>\n"
+                             << "    value: 2\n"
+                             << "  picked_sum:\n"
+                             << "    func: sum\n"
+                             << "    column: 0\n"
+                             << "    where: picked\n";
+
+  config::load(config_file);
+  EXPECT_EQ(plan::compile(config::getIds()), 3);
+  config::clear();
+
+  vector<Node *> nodes;
+  for (const char *id : {"total", "mean", "letters", "missing", "bad",
+                         "picked", "picked_sum"}) {
+    nodes.push_back(createNode(id));
+    addNode(nodes.back());
+  }
+  executor::run({csv_file});
+  logger::openLog(result_file);
+  for (Node *node : nodes) {
+    executor::writeMerged(node);
+  }
+  logger::close();
+
+  std::stringstream text;
+  text << std::ifstream(result_file).rdbuf();
+  string result = text.str();
+  EXPECT_NE(result.find("total >> 6"), string::npos);
+  EXPECT_NE(result.find("mean >> 2"), string::npos);
+  EXPECT_NE(result.find("letters >> abc"), string::npos);
+  EXPECT_NE(result.find("Unknown type found in column 9. Skipping missing"),
+            string::npos);
+  EXPECT_NE(result.find("Invalid column in bad. Skipping bad"), string::npos);
+  // ошибка параметра пишется в лог вместо неизвестного типа столбца
+  EXPECT_NE(result.find("Unknown comparison => in picked. Skipping picked"),
+            string::npos);
+  EXPECT_NE(result.find("Operation picked has errors in picked_sum. "
+                        "Skipping picked_sum"),
+            string::npos);
+  EXPECT_EQ(result.find("Unknown type found in column 0"), string::npos);
+  EXPECT_EQ(executor::skipped(), 4);
+
+  executor::clear();
+  EXPECT_EQ(executor::skipped(), 0);
+  plan::clear();
+  table::clear();
+  clearGraph();
+  fs::remove(config_file);
+  fs::remove(result_file);
+  fs::remove(csv_file);
+}
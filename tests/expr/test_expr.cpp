@@ -0,0 +1,108 @@
+#include "../../include/expr.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: маска, в которой присутствуют все строки
+Bitmap allPresent(size_t length) {
+  Bitmap validity = createBitmap(length);
+  for (size_t i = 0; i < length; i++) {
+    setBit(validity, i);
+  }
+  return validity;
+}
+
+// Вспомогательная функция: скомпилировать выражение или завершить тест
+ExprProgram compile(const string &text) {
+  ExprProgram program;
+  string error;
+  EXPECT_TRUE(compileExpression(text, program, error)) << error;
+  return program;
+}
+
+// Тест ошибок разбора: описание содержит позицию
+TEST(EXPR, ParseErrors) {
+  ExprProgram program;
+  string error;
+  EXPECT_FALSE(compileExpression("col[1] +", program, error));
+  EXPECT_NE(error.find("position"), string::npos);
+  EXPECT_FALSE(compileExpression("(col[0] * 2", program, error));
+  EXPECT_FALSE(compileExpression("col[0] col[1]", program, error));
+  EXPECT_FALSE(compileExpression("cell[0]", program, error));
+  EXPECT_TRUE(program.code.empty());
+}
+
+// Тест байт-кода: константы сворачиваются в операции, столбцы - в слоты
+TEST(EXPR, CompileFusesConstants) {
+  ExprProgram program = compile("col[2] * 1.5 + col[0] - col[2]");
+  EXPECT_EQ(program.columns, vector<int>({2, 0}));
+  ASSERT_EQ(program.code.size(), 6);
+  EXPECT_EQ(program.code[1].op, MUL_CONST);
+  EXPECT_FLOAT_EQ(program.code[1].value, 1.5);
+  EXPECT_EQ(program.code[4].slot, 0);
+  EXPECT_EQ(program.depth, 2);
+
+  // смена знака константы не требует инструкции
+  EXPECT_EQ(compile("-2").code.size(), 1);
+}
+
+// Тест приоритета операций и скобок
+TEST(EXPR, Precedence) {
+  NumericColumn a = makeNumericColumn({1, 2, 3}, allPresent(3));
+  NumericColumn b = makeNumericColumn({4, 5, 6}, allPresent(3));
+  vector<const NumericColumn *> columns = {&a, &b};
+
+  NumericColumn plain =
+      evaluateExpression(compile("col[0] + col[1] * 2"), columns, 3);
+  EXPECT_EQ(plain.values, vector<float>({9, 12, 15}));
+
+  NumericColumn grouped =
+      evaluateExpression(compile("-(col[0] + col[1]) / 2"), columns, 3);
+  EXPECT_EQ(grouped.values, vector<float>({-2.5, -3.5, -4.5}));
+}
+
+// Тест пропусков: строка без значения любого столбца выражения пропускается,
+// разреженный столбец раскладывается по строкам
+TEST(EXPR, MissingAndSparseColumns) {
+  size_t n = 100;
+  Bitmap dense_validity = createBitmap(n);
+  for (size_t i = 0; i < n; i++) {
+    if (i != 3)
+      setBit(dense_validity, i);
+  }
+  NumericColumn dense = makeNumericColumn(vector<float>(n, 1), dense_validity);
+
+  Bitmap rare = createBitmap(n);
+  setBit(rare, 3);
+  setBit(rare, 50);
+  setBit(rare, 99);
+  NumericColumn sparse = makeNumericColumn(vector<float>(n, 10), rare);
+  ASSERT_EQ(sparse.layout, SPARSE);
+
+  NumericColumn result = evaluateExpression(compile("col[0] + col[1]"),
+                                            {&dense, &sparse}, n);
+  // почти пустой результат хранится в разреженном виде
+  ASSERT_EQ(result.layout, SPARSE);
+  EXPECT_EQ(result.rows, vector<uint32_t>({50, 99}));
+  EXPECT_EQ(result.values, vector<float>({11, 11}));
+}
+
+// Тест нескольких пакетов: результат не зависит от границ пакетов
+TEST(EXPR, MultipleBatches) {
+  size_t n = EXPR_BATCH * 2 + 100;
+  vector<float> values(n);
+  for (size_t i = 0; i < n; i++) {
+    values[i] = i;
+  }
+  NumericColumn column = makeNumericColumn(values, allPresent(n));
+
+  NumericColumn result =
+      evaluateExpression(compile("col[7] * 2 + 1"), {&column}, n);
+  ASSERT_EQ(result.length, n);
+  EXPECT_EQ(presentCount(result), n);
+  EXPECT_FLOAT_EQ(result.values[EXPR_BATCH], EXPR_BATCH * 2 + 1);
+  EXPECT_FLOAT_EQ(result.values[n - 1], (n - 1) * 2 + 1);
+}
@@ -0,0 +1,103 @@
+#include "../../include/filter.h"
+#include "../../include/kernels.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: номера выбранных строк маски
+vector<size_t> selectedIndices(const Bitmap &selection) {
+  vector<size_t> rows;
+  for (size_t i = 0; i < selection.length; i++) {
+    if (testBit(selection, i))
+      rows.push_back(i);
+  }
+  return rows;
+}
+
+// Вспомогательная функция: маска, в которой присутствуют все строки
+Bitmap allPresent(size_t length) {
+  Bitmap validity = createBitmap(length);
+  for (size_t i = 0; i < length; i++) {
+    setBit(validity, i);
+  }
+  return validity;
+}
+
+// Тест разбора операций сравнения
+TEST(FILTER, ParseCompare) {
+  CompareOp op = EQUAL;
+  EXPECT_TRUE(parseCompare(">=", op));
+  EXPECT_EQ(op, GREATER_EQUAL);
+  EXPECT_TRUE(parseCompare("!=", op));
+  EXPECT_EQ(op, NOT_EQUAL);
+  EXPECT_FALSE(parseCompare("=>", op));
+}
+
+// Тест отбора по числовому столбцу: пропуски не выбираются
+TEST(FILTER, NumericComparison) {
+  Bitmap validity = createBitmap(5);
+  setBit(validity, 0);
+  setBit(validity, 1);
+  setBit(validity, 3);
+  setBit(validity, 4);
+  NumericColumn column = makeNumericColumn({1, 5, 0, 3, 7}, validity);
+
+  EXPECT_EQ(selectedIndices(compareColumn(column, GREATER, 2)),
+            vector<size_t>({1, 3, 4}));
+  // значение пропуска равно 0, но строка не выбирается
+  EXPECT_EQ(selectedIndices(compareColumn(column, LESS_EQUAL, 1)),
+            vector<size_t>({0}));
+}
+
+// Тест отбора по строковому столбцу в плотном и разреженном представлении
+TEST(FILTER, StringComparison) {
+  size_t n = 200;
+  vector<string> values(n);
+  Bitmap dense_validity = createBitmap(n);
+  Bitmap sparse_validity = createBitmap(n);
+  for (size_t i = 0; i < n; i++) {
+    values[i] = i % 3 == 0 ? "b" : "a";
+    setBit(dense_validity, i);
+    if (i % 10 == 0)
+      setBit(sparse_validity, i);
+  }
+
+  StringColumn dense = makeStringColumn(values, dense_validity);
+  StringColumn sparse = makeStringColumn(values, sparse_validity);
+  ASSERT_EQ(dense.layout, DENSE);
+  ASSERT_EQ(sparse.layout, SPARSE);
+
+  EXPECT_EQ(countBits(compareColumn(dense, EQUAL, "b")), 67);
+  // каждая 30-я строка: присутствует и равна "b"
+  EXPECT_EQ(selectedIndices(compareColumn(sparse, EQUAL, "b")),
+            vector<size_t>({0, 30, 60, 90, 120, 150, 180}));
+}
+
+// Тест маски для ядер: выбранные значения суммируются без копирования строк
+TEST(FILTER, SelectedMaskFeedsKernels) {
+  NumericColumn values = makeNumericColumn({1, 2, 3, 4}, allPresent(4));
+  StringColumn keys = makeStringColumn({"x", "y", "x", "y"}, allPresent(4));
+
+  Bitmap selection = compareColumn(keys, EQUAL, "y");
+  Bitmap mask = selectedMask(values, selection);
+  EXPECT_EQ(maskedSum(values.values.data(), mask.words.data(),
+                      values.values.size()),
+            6);
+
+  // разреженный столбец значений: маска выровнена по упакованным значениям
+  Bitmap rare = createBitmap(100);
+  setBit(rare, 10);
+  setBit(rare, 20);
+  setBit(rare, 30);
+  NumericColumn sparse = makeNumericColumn(vector<float>(100, 2), rare);
+  Bitmap rows = createBitmap(100);
+  setBit(rows, 20);
+  setBit(rows, 30);
+  setBit(rows, 40);
+  Bitmap sparse_mask = selectedMask(sparse, rows);
+  ASSERT_EQ(sparse_mask.length, 3);
+  EXPECT_EQ(countBits(sparse_mask), 2);
+}
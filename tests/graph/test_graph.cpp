@@ -390,3 +390,84 @@ TEST(GRAPH, DeepFirstSearch_ComplexGraph) {
 
   clearGraph();
 }
+
+// Тест получения предыдущих узлов
+TEST(GRAPH, ParentNodes) {
+  Node *a = createNode("A");
+  Node *b = createNode("B");
+  Node *c = createNode("C");
+
+  addNode(a);
+  addNode(b);
+  addNode(c);
+
+  connect(a, {c});
+  connect(b, {c});
+
+  vector<Node *> parents = parentNodes(c);
+  ASSERT_EQ(parents.size(), 2);
+  EXPECT_EQ(parents[0], a);
+  EXPECT_EQ(parents[1], b);
+  EXPECT_TRUE(parentNodes(a).empty());
+
+  clearGraph();
+}
+
+// Тест топологического обхода: узел посещается после всех родителей, а
+// узлы без входящих связей служат отдельными корнями
+TEST(GRAPH, TopologicalSearch_WaitsForAllParents) {
+  // A -> B -> D
+  // |         ^
+  // v         |
+  // C ---------
+  // E (отдельный корень)
+  Node *a = createNode("A");
+  Node *b = createNode("B");
+  Node *c = createNode("C");
+  Node *d = createNode("D");
+  Node *e = createNode("E");
+
+  addNode(a);
+  addNode(b);
+  addNode(c);
+  addNode(d);
+  addNode(e);
+
+  connect(a, {b, c});
+  connect(b, {d});
+  connect(c, {d});
+
+  dfs_test_utils::resetVisited();
+  topologicalSearch(dfs_test_utils::recordVisit);
+
+  const vector<string> &order = dfs_test_utils::visited_nodes;
+  ASSERT_EQ(order.size(), 5);
+  EXPECT_EQ(order[0], "A");
+  auto position = [&](const string &id) {
+    return find(order.begin(), order.end(), id) - order.begin();
+  };
+  EXPECT_GT(position("D"), position("B"));
+  EXPECT_GT(position("D"), position("C"));
+  EXPECT_TRUE(dfs_test_utils::wasVisited("E"));
+
+  clearGraph();
+}
+
+// Тест связывания узлов без поиска в списке заголовков
+TEST(GRAPH, LinkAppendsAdjent) {
+  Node *a = createNode("A");
+  Node *b = createNode("B");
+  Node *c = createNode("C");
+  addNode(a);
+  addNode(b);
+  addNode(c);
+
+  link(a, b);
+  link(a, c);
+  link(b, c);
+
+  EXPECT_EQ(adjentNodes(a), vector<Node *>({b, c}));
+  EXPECT_EQ(parentNodes(c), vector<Node *>({a, b}));
+
+  clearGraph();
+}
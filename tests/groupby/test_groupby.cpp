@@ -0,0 +1,117 @@
+#include "../../include/groupby.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: маска, в которой присутствуют все строки, кроме
+// строк с номерами, кратными skip (0 - без пропусков)
+Bitmap validityWithout(size_t length, size_t skip) {
+  Bitmap validity = createBitmap(length);
+  for (size_t i = 0; i < length; i++) {
+    if (skip == 0 or i % skip != 0)
+      setBit(validity, i);
+  }
+  return validity;
+}
+
+// Тест суммы и количества по ключам в порядке первого появления
+TEST(GROUPBY, SumsPerKey) {
+  NumericColumn values =
+      makeNumericColumn({1, 2, 3, 4, 5}, validityWithout(5, 0));
+  StringColumn keys =
+      makeStringColumn({"b", "a", "b", "c", "a"}, validityWithout(5, 0));
+
+  GroupTable table = groupAggregate(values, keys, false);
+
+  ASSERT_EQ(table.keys, vector<string>({"b", "a", "c"}));
+  EXPECT_EQ(table.states[0].sum, 4);
+  EXPECT_EQ(table.states[1].sum, 7);
+  EXPECT_EQ(table.states[2].count, 1);
+  EXPECT_EQ(table.states[1].min, 2);
+  EXPECT_EQ(table.states[1].max, 5);
+}
+
+// Тест пропусков: строки без значения или без ключа не попадают в группы
+TEST(GROUPBY, SkipsMissing) {
+  Bitmap value_validity = validityWithout(4, 0);
+  Bitmap key_validity = createBitmap(4);
+  setBit(key_validity, 0);
+  setBit(key_validity, 1);
+  setBit(key_validity, 2);
+
+  NumericColumn values = makeNumericColumn({1, 2, 3, 4}, value_validity);
+  StringColumn keys = makeStringColumn({"a", "a", "b", ""}, key_validity);
+
+  GroupTable table = groupAggregate(values, keys, false);
+
+  ASSERT_EQ(table.keys, vector<string>({"a", "b"}));
+  EXPECT_EQ(table.states[0].count, 2);
+  EXPECT_EQ(table.states[1].sum, 3);
+}
+
+// Тест потоков: таблицы потоков объединяются так же, как при одном потоке,
+// в том числе для разреженных столбцов
+TEST(GROUPBY, ParallelMatchesSerial) {
+  size_t n = 300000;
+  vector<float> raw(n);
+  vector<string> names(n);
+  for (size_t i = 0; i < n; i++) {
+    raw[i] = i % 10;
+    names[i] = "key" + std::to_string((i * 7919) % 5003);
+  }
+
+  NumericColumn values = makeNumericColumn(raw, validityWithout(n, 3));
+  StringColumn keys = makeStringColumn(names, validityWithout(n, 1000));
+
+  GroupTable serial = groupAggregate(values, keys, true, 1);
+  GroupTable parallel = groupAggregate(values, keys, true, 4);
+
+  ASSERT_EQ(parallel.keys, serial.keys);
+  for (size_t g = 0; g < serial.keys.size(); g++) {
+    EXPECT_EQ(parallel.states[g].count, serial.states[g].count);
+    EXPECT_DOUBLE_EQ(parallel.states[g].sum, serial.states[g].sum);
+    EXPECT_NEAR(parallel.states[g].m2, serial.states[g].m2, 1e-6);
+  }
+
+  // разреженный столбец значений: присутствует каждая 8-я строка
+  Bitmap rare = createBitmap(n);
+  for (size_t i = 0; i < n; i += 8) {
+    setBit(rare, i);
+  }
+  NumericColumn sparse = makeNumericColumn(raw, rare);
+  StringColumn sparse_keys = makeStringColumn(names, rare);
+  ASSERT_EQ(sparse.layout, SPARSE);
+  ASSERT_EQ(sparse_keys.layout, SPARSE);
+
+  GroupTable sparse_serial = groupAggregate(sparse, sparse_keys, false, 1);
+  GroupTable sparse_parallel = groupAggregate(sparse, sparse_keys, false, 4);
+  ASSERT_EQ(sparse_parallel.keys, sparse_serial.keys);
+
+  size_t total = 0;
+  for (const Moments &state : sparse_parallel.states) {
+    total += state.count;
+  }
+  EXPECT_EQ(total, sparse.values.size());
+}
+
+// Тест объединения частей: новые группы добавляются в конец
+TEST(GROUPBY, MergeKeepsOrder) {
+  NumericColumn first_values =
+      makeNumericColumn({1, 2}, validityWithout(2, 0));
+  StringColumn first_keys =
+      makeStringColumn({"x", "y"}, validityWithout(2, 0));
+  NumericColumn second_values =
+      makeNumericColumn({3, 4}, validityWithout(2, 0));
+  StringColumn second_keys =
+      makeStringColumn({"z", "x"}, validityWithout(2, 0));
+
+  GroupTable merged = groupAggregate(first_values, first_keys, false);
+  groupMerge(merged, groupAggregate(second_values, second_keys, false));
+
+  ASSERT_EQ(merged.keys, vector<string>({"x", "y", "z"}));
+  EXPECT_EQ(merged.states[0].sum, 5);
+  EXPECT_EQ(merged.states[0].max, 4);
+}
@@ -0,0 +1,79 @@
+#include "../../include/column.h"
+#include "../../include/histogram.h"
+#include "gtest/gtest.h"
+#include <random>
+#include <vector>
+
+using std::vector;
+
+// Тест заданного диапазона: значения вне диапазона считаются отдельно, а
+// результат не зависит от количества потоков
+TEST(HISTOGRAM, FixedRangeAnyWorkers) {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<float> distribution(-10, 110);
+  vector<float> values(500000);
+  for (float &value : values) {
+    value = distribution(generator);
+  }
+
+  vector<uint64_t> expected(10, 0);
+  size_t outside = 0;
+  for (float value : values) {
+    if (value < 0 or value > 100)
+      outside++;
+    else
+      expected[std::min<size_t>(value * 0.1f, 9)]++;
+  }
+
+  for (unsigned workers : {1u, 4u}) {
+    HistogramState state;
+    state.spec.fixed = true;
+    state.spec.max = 100;
+    histogramInsert(state, values.data(), nullptr, values.size(), workers);
+    EXPECT_EQ(state.counts, expected);
+    EXPECT_EQ(state.outside, outside);
+    EXPECT_EQ(state.min, 0);
+    EXPECT_EQ(state.max, 100);
+  }
+}
+
+// Тест диапазона из данных: границы - минимум и максимум присутствующих
+// значений
+TEST(HISTOGRAM, AutoRange) {
+  vector<float> values = {3, 100, 1, 2, 5, 4};
+  Bitmap validity = createBitmap(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i != 1)
+      setBit(validity, i);
+  }
+
+  HistogramState state;
+  state.spec.bins = 4;
+  histogramInsert(state, values.data(), validity.words.data(), values.size());
+  EXPECT_EQ(state.min, 1);
+  EXPECT_EQ(state.max, 5);
+  EXPECT_EQ(state.counts, vector<uint64_t>({1, 1, 1, 2}));
+  EXPECT_EQ(state.outside, 0);
+}
+
+// Тест объединения частей: одинаковые границы складываются точно, разные -
+// переносятся в общий диапазон по серединам корзин
+TEST(HISTOGRAM, MergeParts) {
+  vector<float> first = {0, 1, 2, 3};
+  vector<float> second = {4, 5, 6, 7};
+
+  HistogramState state;
+  state.spec.bins = 2;
+  histogramInsert(state, first.data(), nullptr, first.size());
+  histogramInsert(state, first.data(), nullptr, first.size());
+  EXPECT_EQ(state.counts, vector<uint64_t>({4, 4}));
+
+  histogramInsert(state, second.data(), nullptr, second.size());
+  EXPECT_EQ(state.min, 0);
+  EXPECT_EQ(state.max, 7);
+  EXPECT_EQ(state.counts, vector<uint64_t>({8, 4}));
+
+  HistogramState empty;
+  histogramMerge(empty, state);
+  EXPECT_EQ(empty.counts, state.counts);
+}
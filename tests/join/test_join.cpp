@@ -0,0 +1,79 @@
+#include "../../include/join.h"
+#include "../../include/sketch.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: хэш строки ключа
+uint64_t hashOf(const string &key) { return hashBytes(key.data(), key.size()); }
+
+// Тест фильтра Блума: добавленные ключи всегда найдены, а большинство
+// отсутствующих отсекается
+TEST(JOIN, BloomFilter) {
+  BloomFilter filter = createBloom(1000);
+  for (int i = 0; i < 1000; i++) {
+    bloomInsert(filter, hashOf("key" + std::to_string(i)));
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(bloomContains(filter, hashOf("key" + std::to_string(i))));
+  }
+
+  int false_positives = 0;
+  for (int i = 0; i < 10000; i++) {
+    false_positives +=
+        bloomContains(filter, hashOf("other" + std::to_string(i)));
+  }
+  EXPECT_LT(false_positives, 500);
+}
+
+// Тест соединения: повторы ключей дают все пары, строки без пары и без
+// ключа отбрасываются, а левые строки дополняются до ширины таблицы
+TEST(JOIN, MatchesDuplicatesAndPadsLeft) {
+  table::Table left;
+  left.rows = {{"1", "a"}, {"2", "b", "extra"}, {"3"}, {"", "c"}, {"1", "d"}};
+  table::Table right;
+  right.rows = {{"x", "1"}, {"y", "2"}, {"z", "1"}, {"w", ""}};
+
+  vector<vector<string>> rows = hashJoin(left, 0, right, 1);
+  EXPECT_EQ(rows, vector<vector<string>>({{"1", "a", "", "x", "1"},
+                                          {"1", "a", "", "z", "1"},
+                                          {"2", "b", "extra", "y", "2"},
+                                          {"1", "d", "", "x", "1"},
+                                          {"1", "d", "", "z", "1"}}));
+}
+
+// Тест порядка: хэш-таблица строится по меньшей таблице, но столбцы левой
+// таблицы всегда идут первыми
+TEST(JOIN, BuildsOnSmallerSide) {
+  table::Table left;
+  left.rows = {{"2", "L"}};
+  table::Table right;
+  right.rows = {{"1", "p"}, {"2", "q"}, {"2", "r"}};
+
+  EXPECT_EQ(hashJoin(left, 0, right, 0),
+            vector<vector<string>>(
+                {{"2", "L", "2", "q"}, {"2", "L", "2", "r"}}));
+  EXPECT_EQ(hashJoin(right, 0, left, 0),
+            vector<vector<string>>(
+                {{"2", "q", "2", "L"}, {"2", "r", "2", "L"}}));
+}
+
+// Тест потоков: результат не зависит от количества потоков
+TEST(JOIN, SameResultForAnyWorkers) {
+  table::Table left;
+  table::Table right;
+  for (int i = 0; i < 100000; i++) {
+    left.rows.push_back({std::to_string(i % 5000), std::to_string(i)});
+  }
+  for (int i = 0; i < 5000; i += 2) {
+    right.rows.push_back({std::to_string(i), "r" + std::to_string(i)});
+  }
+
+  vector<vector<string>> single = hashJoin(left, 0, right, 0, 1);
+  EXPECT_EQ(single.size(), 50000);
+  EXPECT_EQ(single.front(), vector<string>({"0", "0", "0", "r0"}));
+  EXPECT_EQ(hashJoin(left, 0, right, 0, 4), single);
+}
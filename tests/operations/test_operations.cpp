@@ -1,11 +1,23 @@
 #include "../include/operations.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
 using std::string;
 using std::vector;
 
+// Вычислить числовую операцию через таблицу операций
+float numericOf(const string &op_name, NumericView source) {
+  return finalizeNumeric(op_name, partialOf(source, needsOf(op_name, {})));
+}
+
+// Вычислить строковую операцию через таблицу операций
+string stringOf(const string &op_name, StringView source) {
+  return finalizeString(op_name, partialOf(source, needsOf(op_name, {})));
+}
+
 TEST(OPERATIONS, Sum) {
   vector<float> source = {1, 2, 3};
   EXPECT_EQ(sum(source), 6);
@@ -21,17 +33,263 @@ TEST(OPERATIONS, Concatinate) {
   EXPECT_EQ(concatinate(source), "abcdef");
 }
 
-TEST(OPERATIONS, SumFromMap) {
+// Тест потокового режима: части объединяются по порядку без копии строк
+// столбца, а при сборке результат совпадает с обычным объединением
+TEST(OPERATIONS, ConcatinateStreamPieces) {
+  Params params = {{"stream", "true"}};
+  StateNeeds needs = needsOf("concatinate", params);
+  EXPECT_TRUE(needs.stream);
+  EXPECT_FALSE(needs.text);
+
+  Bitmap mask = createBitmap(2);
+  setBit(mask, 1);
+  auto column = std::make_shared<const StringColumn>(
+      makeStringColumn({"x", "y"}, mask));
+  PartialResult merged = partialOf(vector<string>({"a", "bc"}), needs);
+  PartialResult shared;
+  shared.pieces.push_back({column, Bitmap()});
+  mergePartial(merged, shared);
+
+  ASSERT_EQ(merged.pieces.size(), 2);
+  EXPECT_EQ(merged.pieces[1].column, column);
+  EXPECT_EQ(finalizeString("concatinate", merged, params), "abcy");
+}
+
+TEST(OPERATIONS, SumFromTable) {
   vector<float> source = {1, 2, 3};
-  EXPECT_EQ(callOperation("sum", source), 6);
+  EXPECT_EQ(numericOf("sum", source), 6);
 }
 
-TEST(OPERATIONS, AverageFromMap) {
+TEST(OPERATIONS, AverageFromTable) {
   vector<float> source = {1, 2, 3};
-  EXPECT_EQ(callOperation("average", source), 2);
+  EXPECT_EQ(numericOf("average", source), 2);
 }
 
-TEST(OPERATIONS, ConcatinateFromMap) {
+TEST(OPERATIONS, ConcatinateFromTable) {
   vector<string> source = {"a", "bc", "def"};
-  EXPECT_EQ(callOperation("concatinate", source), "abcdef");
+  EXPECT_EQ(stringOf("concatinate", source), "abcdef");
+}
+
+TEST(OPERATIONS, AverageSkipsMissing) {
+  Bitmap validity = createBitmap(4);
+  setBit(validity, 0);
+  setBit(validity, 1);
+  setBit(validity, 3);
+  NumericColumn source = makeNumericColumn({1, 2, 0, 6}, validity);
+
+  EXPECT_EQ(sum(source), 9);
+  EXPECT_EQ(average(source), 3);
+}
+
+TEST(OPERATIONS, ViewOverBufferPart) {
+  vector<float> buffer = {100, 1, 2, 3, 100};
+  NumericView middle(buffer.data() + 1, nullptr, 3);
+
+  EXPECT_EQ(numericOf("sum", middle), 6);
+  EXPECT_EQ(middle.values, buffer.data() + 1);
+}
+
+TEST(OPERATIONS, StatisticsFromTable) {
+  vector<float> source = {2, 4, 4, 4, 5, 5, 7, 9};
+  EXPECT_EQ(numericOf("min", source), 2);
+  EXPECT_EQ(numericOf("max", source), 9);
+  EXPECT_EQ(numericOf("count", source), 8);
+  EXPECT_FLOAT_EQ(numericOf("variance", source), 32.0f / 7);
+  EXPECT_FLOAT_EQ(numericOf("stddev", source), std::sqrt(32.0f / 7));
+  EXPECT_NEAR(numericOf("skewness", source), 0.65625, 1e-5);
+}
+
+TEST(OPERATIONS, MergedMomentsMatchWhole) {
+  vector<float> source(10000);
+  for (size_t i = 0; i < source.size(); i++) {
+    source[i] = 1000 + 0.01f * (i % 97) * (i % 13);
+  }
+  NumericView first(source.data(), nullptr, 3000);
+  NumericView second(source.data() + 3000, nullptr, source.size() - 3000);
+
+  StateNeeds needs;
+  needs.moments = true;
+  needs.values = true;
+
+  PartialResult merged = partialOf(first, needs);
+  mergePartial(merged, partialOf(second, needs));
+  PartialResult whole = partialOf(NumericView(source), needs);
+
+  EXPECT_EQ(merged.count, whole.count);
+  EXPECT_EQ(finalizeNumeric("min", merged), finalizeNumeric("min", whole));
+  EXPECT_FLOAT_EQ(finalizeNumeric("variance", merged),
+                  finalizeNumeric("variance", whole));
+  EXPECT_NEAR(finalizeNumeric("skewness", merged),
+              finalizeNumeric("skewness", whole), 1e-4);
+
+  // значения частей остаются отсортированными после объединения
+  EXPECT_TRUE(std::is_sorted(merged.values.begin(), merged.values.end()));
+  Params exact = {{"exact", "true"}, {"q", "0.9"}};
+  EXPECT_EQ(finalizeNumeric("quantile", merged, exact),
+            finalizeNumeric("quantile", whole, exact));
+}
+
+TEST(OPERATIONS, CountDistinctFromTable) {
+  vector<string> source = {"a", "b", "a", "c", "b", "a"};
+  EXPECT_EQ(stringOf("count_distinct", source), "3");
+  EXPECT_EQ(stringOf("count_distinct_approx", source), "3");
+}
+
+TEST(OPERATIONS, FindReplace) {
+  vector<string> source = {"a-b-c", "aaa", "", "none"};
+  EXPECT_EQ(findReplace(source, "-", "+-+"),
+            vector<string>({"a+-+b+-+c", "aaa", "", "none"}));
+  // вхождения не пересекаются
+  EXPECT_EQ(findReplace(source, "aa", "b"),
+            vector<string>({"a-b-c", "ba", "", "none"}));
+  EXPECT_EQ(findReplace(source, "", "x"), source);
+}
+
+TEST(OPERATIONS, FindReplaceColumnKeepsLayout) {
+  Bitmap validity = createBitmap(8);
+  setBit(validity, 5);
+  StringColumn source = makeStringColumn(
+      {"", "", "", "", "", "1,5", "", ""}, validity);
+
+  StringColumn result = findReplaceColumn(source, {{"find", ","},
+                                                   {"replace", "."}});
+  EXPECT_EQ(result.layout, source.layout);
+  EXPECT_EQ(result.rows, source.rows);
+  EXPECT_EQ(result.length, 8);
+  EXPECT_EQ(result.values, vector<string>({"1.5"}));
+  EXPECT_TRUE(isTransform("find_replace"));
+  EXPECT_FALSE(isTransform("sum"));
+}
+
+TEST(OPERATIONS, SortMergesParts) {
+  vector<float> first = {3, 1.5, 7};
+  vector<float> second = {-2, 4};
+  // бюджет около 10 байт: серии сбрасываются на диск
+  Params params = {{"memory", "0.00001"}, {"order", "desc"}};
+  StateNeeds needs = needsOf("sort", params);
+
+  PartialResult merged = partialOf(NumericView(first), needs);
+  mergePartial(merged, partialOf(NumericView(second), needs));
+  EXPECT_EQ(finalizeString("sort", merged, params), "7,4,3,1.5,-2");
+  EXPECT_EQ(finalizeString("sort", merged), "-2,1.5,3,4,7");
+}
+
+// Тест top_k: номера строк второй части сдвигаются на длину первой, а
+// частоты строк складываются
+TEST(OPERATIONS, TopKMergesParts) {
+  vector<float> first = {3, 1.5, 7};
+  vector<float> second = {-2, 9, 7};
+  Params largest = {{"k", "2"}};
+  Params smallest = {{"k", "2"}, {"order", "asc"}};
+  StateNeeds needs = needsOf("top_k", largest);
+  addNeeds(needs, needsOf("top_k", smallest));
+
+  PartialResult merged = partialOf(NumericView(first), needs);
+  mergePartial(merged, partialOf(NumericView(second), needs));
+  EXPECT_EQ(finalizeString("top_k", merged, largest), "9 (row 4), 7 (row 2)");
+  EXPECT_EQ(finalizeString("top_k", merged, smallest),
+            "-2 (row 3), 1.5 (row 1)");
+
+  vector<string> words = {"b", "a", "b", "c", "a", "b"};
+  PartialResult counts = partialOf(StringView(words), needs);
+  EXPECT_EQ(finalizeString("top_k", counts, largest),
+            "b: 3 (row 0), a: 2 (row 1)");
+}
+
+// Тест гистограммы: гистограммы с разными параметрами считаются в одном
+// проходе, а серии пустых корзин записываются компактно
+TEST(OPERATIONS, HistogramText) {
+  vector<float> values = {0, 0.5, 9.5, 10, -1, 12};
+  Params fixed = {{"bins", "10"}, {"min", "0"}, {"max", "10"}};
+  Params automatic = {{"bins", "2"}};
+  StateNeeds needs = needsOf("histogram", fixed);
+  addNeeds(needs, needsOf("histogram", automatic));
+
+  PartialResult partial = partialOf(NumericView(values), needs);
+  EXPECT_EQ(finalizeString("histogram", partial, fixed),
+            "0..10: 2,0*8,2, outside: 2");
+  EXPECT_EQ(finalizeString("histogram", partial, automatic), "-1..12: 3,3");
+  EXPECT_FALSE(acceptsInput(OP_HISTOGRAM, STRING));
+}
+
+TEST(OPERATIONS, ResolveOperation) {
+  // ключ каждой записи таблицы разрешается в ее номер
+  for (int op = 0; op < OP_UNKNOWN; op++) {
+    EXPECT_EQ(resolveOperation(operationInfo(OperationId(op)).name), op);
+  }
+  EXPECT_EQ(resolveOperation("nope"), OP_UNKNOWN);
+  EXPECT_EQ(operationInput(OP_UNKNOWN), UNKNOWN);
+  EXPECT_EQ(operationInput(OP_CONCATINATE), STRING);
+  // тип входа не совпадает с типом результата
+  EXPECT_EQ(operationInput(OP_HISTOGRAM), NUMERIC);
+  EXPECT_EQ(operationResult(OP_HISTOGRAM), STRING);
+  EXPECT_EQ(operationInput(OP_TOP_K), UNKNOWN);
+  EXPECT_EQ(operationResult(OP_SORT), STRING);
+  EXPECT_FALSE(acceptsInput(OP_UNKNOWN, NUMERIC));
+  EXPECT_TRUE(isFilter(OP_FILTER));
+  EXPECT_TRUE(isWindow(OP_CUMULATIVE_SUM));
+  EXPECT_TRUE(acceptsInput(OP_SORT, NUMERIC));
+  EXPECT_TRUE(acceptsInput(OP_TOP_K, NUMERIC));
+  EXPECT_FALSE(acceptsInput(OP_CONCATINATE, NUMERIC));
+  EXPECT_TRUE(isTransform(OP_ROLLING_SUM));
+  EXPECT_THROW(finalizeNumeric(OP_CONCATINATE, PartialResult()),
+               std::runtime_error);
+}
+
+// Тест границ параметров: ошибка находится при загрузке, а значения вне
+// диапазона приводятся к нему и не дают пустого состояния
+TEST(OPERATIONS, ParamBounds) {
+  EXPECT_EQ(needsOf("median", {{"accuracy", "0"}}).sketch, MIN_ACCURACY);
+  EXPECT_EQ(needsOf("median", {{"accuracy", "-5"}}).sketch, MIN_ACCURACY);
+  EXPECT_EQ(needsOf("median", {{"accuracy", "1e30"}}).sketch, MAX_ACCURACY);
+  EXPECT_EQ(needsOf("median", {{"accuracy", "nan"}}).sketch,
+            DEFAULT_ACCURACY);
+  EXPECT_NE(paramError(OP_MEDIAN, {{"accuracy", "0"}}), "");
+  EXPECT_NE(paramError(OP_QUANTILE, {{"accuracy", "nan"}}), "");
+  EXPECT_EQ(paramError(OP_MEDIAN, {{"accuracy", "8"}}), "");
+  // точный режим не использует скетч
+  EXPECT_EQ(paramError(OP_MEDIAN, {{"accuracy", "0"}, {"exact", "true"}}),
+            "");
+  EXPECT_NE(paramError(OP_QUANTILE, {{"q", "1.5"}}), "");
+  EXPECT_NE(paramError(OP_FILTER, {{"op", "=>"}}), "");
+  EXPECT_EQ(paramError(OP_SUM, {}), "");
+
+  // окну нужен размер от одной строки до MAX_WINDOW; при выполнении размер
+  // приводится к диапазону
+  EXPECT_NE(paramError(OP_ROLLING_SUM, {}), "");
+  EXPECT_NE(paramError(OP_ROLLING_SUM, {{"window", "0"}}), "");
+  EXPECT_NE(paramError(OP_ROLLING_AVERAGE, {{"window", "nan"}}), "");
+  EXPECT_NE(paramError(OP_ROLLING_AVERAGE, {{"window", "1e300"}}), "");
+  EXPECT_EQ(paramError(OP_ROLLING_SUM, {{"window", "3"}}), "");
+  Bitmap validity = createBitmap(3);
+  for (size_t i = 0; i < 3; i++) {
+    setBit(validity, i);
+  }
+  NumericColumn column = makeNumericColumn({1, 2, 3}, validity);
+  EXPECT_EQ(callWindow(OP_ROLLING_SUM, column, {{"window", "0"}}).values,
+            vector<float>({1, 2, 3}));
+  EXPECT_EQ(callWindow(OP_ROLLING_SUM, column, {{"window", "1e300"}}).values,
+            vector<float>({1, 3, 6}));
+
+  EXPECT_NE(paramError(OP_TOP_K, {{"k", "0"}}), "");
+  EXPECT_NE(paramError(OP_TOP_K, {{"k", "inf"}}), "");
+  EXPECT_NE(paramError(OP_TOP_K, {{"k", "1e30"}}), "");
+  EXPECT_EQ(paramError(OP_TOP_K, {{"k", "100"}}), "");
+  EXPECT_EQ(needsOf("top_k", {{"k", "-3"}}).top_k, 1);
+  EXPECT_EQ(needsOf("top_k", {{"k", "1e30"}}).top_k, MAX_TOP_K);
+  EXPECT_EQ(needsOf("top_k", {{"k", "nan"}}).top_k, DEFAULT_TOP_K);
+  // k больше числа строк возвращает все строки
+  Params every = {{"k", "1e30"}};
+  PartialResult all = partialOf(NumericView(column), needsOf("top_k", every));
+  EXPECT_EQ(finalizeString("top_k", all, every),
+            "3 (row 2), 2 (row 1), 1 (row 0)");
+
+  EXPECT_NE(paramError(OP_HISTOGRAM, {{"bins", "0"}}), "");
+  EXPECT_NE(paramError(OP_HISTOGRAM, {{"bins", "nan"}}), "");
+  EXPECT_NE(paramError(OP_HISTOGRAM, {{"bins", "1e12"}}), "");
+  EXPECT_EQ(paramError(OP_HISTOGRAM, {{"bins", "20"}}), "");
+  EXPECT_EQ(needsOf("histogram", {{"bins", "1e12"}}).histograms[0].bins,
+            MAX_BINS);
+  EXPECT_EQ(needsOf("histogram", {{"bins", "nan"}}).histograms[0].bins,
+            DEFAULT_BINS);
 }
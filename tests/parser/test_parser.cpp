@@ -110,6 +110,8 @@ TEST(PARSER, CreateGraphFromScheme) {
   EXPECT_EQ(b_adjents[0], c);
   EXPECT_EQ(b_adjents[1], d);
   EXPECT_EQ(d->adjency_list_head->my_head, c);
+  // начало второй ветви не добавляется повторно
+  EXPECT_EQ(nodesTotal(), 4);
 
   clearGraph();
 }
@@ -130,6 +132,7 @@ TEST(PARSER, CreateGraphFromSchemeWithIndexes) {
   EXPECT_EQ(b_adjents[0], c);
   EXPECT_EQ(b_adjents[1], d);
   EXPECT_EQ(d->adjency_list_head->my_head, c);
+  EXPECT_EQ(nodesTotal(), 4);
 
   clearGraph();
 }
@@ -183,6 +186,52 @@ TEST(PARSER, ReadStringColumn) {
   fs::remove(path);
 }
 
+// Тест выравнивания числового столбца по строкам таблицы
+TEST(PARSER, NumericColumnKeepsRowAlignment) {
+  string path = "test_numeric_aligned.csv";
+  std::ofstream file(path);
+  file << "1,a\n"
+       << ",b\n"
+       << "3\n"
+       << "4,d\n";
+  file.close();
+
+  table::read(path);
+  const NumericColumn &column = table::numericColumn(0);
+
+  EXPECT_EQ(column.length, 4);
+  EXPECT_EQ(column.layout, DENSE);
+  EXPECT_TRUE(testBit(column.validity, 0));
+  EXPECT_FALSE(testBit(column.validity, 1));
+  EXPECT_TRUE(testBit(column.validity, 2));
+  EXPECT_EQ(column.values[3], 4);
+  EXPECT_EQ(NUMERIC, table::getTypeOfColumn(0));
+
+  const StringColumn &strings = table::stringColumn(1);
+  EXPECT_EQ(strings.length, 4);
+  EXPECT_FALSE(testBit(strings.validity, 2));
+  EXPECT_EQ(strings.values[3], "d");
+
+  table::clear();
+  fs::remove(path);
+}
+
+// Тест разреженного хранения почти пустого столбца
+TEST(PARSER, MostlyEmptyColumnIsSparse) {
+  string path = "test_sparse.csv";
+  createTestCSV(path);
+
+  table::read(path);
+  const StringColumn &column = table::stringColumn(4);
+
+  EXPECT_EQ(column.layout, SPARSE);
+  EXPECT_EQ(column.length, 9);
+  EXPECT_EQ(column.rows, vector<uint32_t>({0, 1}));
+
+  table::clear();
+  fs::remove(path);
+}
+
 // Тест сбора всех id в конфигурации
 TEST(PARSER, GetIds) {
   string path = "test_getids.yaml";
@@ -210,6 +259,7 @@ TEST(PARSER, GetColumnById) {
   EXPECT_EQ(1, config::getColumnById("find_average_of_column_1"));
   EXPECT_EQ(2, config::getColumnById("find_average_of_column_2"));
   EXPECT_EQ(3, config::getColumnById("concat"));
+  EXPECT_EQ("3", config::getColumnFieldById("concat"));
   config::clear();
 
   fs::remove(path);
@@ -287,3 +337,121 @@ TEST(PARSER, GetCSV) {
   config::clear();
   fs::remove(path);
 }
+
+// Тест порядка операций, длинных строк, комментариев и значений с дефисом
+TEST(PARSER, ConfigKeepsFileOrder) {
+  string path = "test_order.yaml";
+  string expr(1000, 'x');
+  vector<string> ids;
+
+  std::ofstream file(path);
+  file << "# generated\noperations:\n";
+  for (int i = 20; i > 0; i--) {
+    ids.push_back("op_" + std::to_string(i));
+    file << "  op_" << i << ":   # operation " << i << "\n"
+         << "    func: histogram\n"
+         << "    column: " << i << "\n"
+         << "    min: -5\n"
+         << "    expr: " << expr << "\n";
+  }
+  file.close();
+
+  config::load(path);
+  EXPECT_EQ(ids, config::getIds());
+  EXPECT_EQ(7, config::getColumnById("op_7"));
+  map<string, string> params = {{"min", "-5"}, {"expr", expr}};
+  EXPECT_EQ(params, config::getParamsById("op_7"));
+  EXPECT_EQ(-1, config::getColumnById("op_21"));
+  config::clear();
+
+  fs::remove(path);
+}
+
+// Тест списков значений и списков узлов
+TEST(PARSER, YamlLists) {
+  string path = "test_lists.yaml";
+  std::ofstream(path) << "---\n"
+                      << "list:\n"
+                      << "  - item1\n"
+                      << "  - \"item # 2\"\n"
+                      << "compact:\n"
+                      << "- a\n"
+                      << "node_list:\n"
+                      << "  - name: node1\n"
+                      << "    value: 1\n"
+                      << "  - name: node2\n"
+                      << "    extra:\n"
+                      << "      - e1\n";
+
+  TINY_YAML::Yaml yaml(path);
+  vector<std::string_view> items = {"item1", "\"item # 2\""};
+  EXPECT_EQ(items, yaml["list"].items());
+  EXPECT_EQ(1, yaml["compact"].items().size());
+  EXPECT_EQ(vector<string>({"0", "1"}), yaml["node_list"].getChildIds());
+  EXPECT_EQ("1", yaml["node_list"]["0"]["value"].value());
+  EXPECT_EQ("e1", yaml["node_list"]["1"]["extra"].items()[0]);
+  EXPECT_FALSE(yaml.hasRoot("missing"));
+  EXPECT_TRUE(yaml["missing"]["deeper"].value().empty());
+
+  std::ofstream(path) << "a:\n  b: 1\n  b: 2\n";
+  EXPECT_THROW(TINY_YAML::Yaml broken(path), std::runtime_error);
+
+  fs::remove(path);
+}
+
+// Тест построения графа по полям depends_on
+TEST(PARSER, DependsOnBuildsGraph) {
+  string path = "test_depends.yaml";
+  std::ofstream(path) << "operations:\n"
+                      << "  total:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "  avg:\n"
+                      << "    func: average\n"
+                      << "    column: 0\n"
+                      << "    depends_on: [total]\n"
+                      << "  cat:\n"
+                      << "    func: concatinate\n"
+                      << "    column: 1\n"
+                      << "    depends_on:\n"
+                      << "      - total\n"
+                      << "      - avg\n"
+                      << "      - avg\n"
+                      << "  alone:\n"
+                      << "    func: sum\n"
+                      << "    column: 2\n";
+
+  config::load(path);
+  vector<string> ids = config::getIds();
+  map<string, vector<string>> depends = config::getDependencies();
+  map<string, vector<string>> expected = {{"avg", {"total"}},
+                                          {"cat", {"total", "avg", "avg"}}};
+  EXPECT_EQ(expected, depends);
+  EXPECT_TRUE(config::getParamsById("avg").empty());
+  EXPECT_TRUE(checkDependencies(ids, depends).empty());
+
+  createGraphFromDependencies(ids, depends);
+  EXPECT_EQ(4, nodesTotal());
+  Node *total = getNodeById("total");
+  Node *avg = getNodeById("avg");
+  Node *cat = getNodeById("cat");
+  EXPECT_EQ(vector<Node *>({avg, cat}), adjentNodes(total));
+  EXPECT_EQ(vector<Node *>({cat}), adjentNodes(avg));
+  EXPECT_TRUE(adjentNodes(getNodeById("alone")).empty());
+
+  clearGraph();
+  config::clear();
+  fs::remove(path);
+}
+
+// Тест проверки зависимостей: неизвестные id, зависимость от себя и циклы
+TEST(PARSER, CheckDependencies) {
+  vector<string> ids = {"a", "b", "c", "d"};
+  map<string, vector<string>> depends = {
+      {"a", {"b"}}, {"b", {"a", "zz"}}, {"c", {"c"}}, {"d", {"c"}}};
+
+  vector<string> expected = {"b: unknown dependency zz", "c: depends on itself",
+                             "a: dependency cycle", "b: dependency cycle"};
+  EXPECT_EQ(expected, checkDependencies(ids, depends));
+  EXPECT_TRUE(checkDependencies(ids, {{"d", {"a", "b"}}}).empty());
+}
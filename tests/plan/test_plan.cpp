@@ -0,0 +1,512 @@
+#include "../../include/parser.h"
+#include "../../include/plan.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Тест группировки операций по столбцу в порядке первого появления
+TEST(PLAN, GroupByColumn) {
+  vector<plan::Task> tasks = {{"s0", "sum", 0},
+                              {"s2", "sum", 2},
+                              {"a0", "average", 0},
+                              {"c2", "concatinate", 2}};
+
+  vector<plan::ColumnGroup> groups = plan::groupByColumn(tasks);
+
+  ASSERT_EQ(groups.size(), 2);
+  EXPECT_EQ(groups[0].column, 0);
+  EXPECT_EQ(groups[0].tasks, vector<size_t>({0, 2}));
+  EXPECT_EQ(groups[1].column, 2);
+  EXPECT_EQ(groups[1].tasks, vector<size_t>({1, 3}));
+}
+
+// Тест совместного вычисления: результаты сопоставлены исходным операциям
+TEST(PLAN, EvaluateKeepsTaskOrder) {
+  string path = "plan_test.csv";
+  std::ofstream(path) << "1,x\n2,y\n,z\n3,w\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {{"s", "sum", 0},
+                              {"c", "concatinate", 1},
+                              {"a", "average", 0}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0]->type, NUMERIC);
+  EXPECT_EQ(finalizeNumeric("sum", *results[0]), 6);
+  EXPECT_EQ(finalizeString("concatinate", *results[1]), "xyzw");
+  EXPECT_EQ(finalizeNumeric("average", *results[2]), 2);
+
+  std::remove(path.c_str());
+}
+
+// Тест кэша: повтор операции и производный агрегат берут готовый результат
+TEST(PLAN, CacheReusesResults) {
+  string path = "plan_cache.csv";
+  std::ofstream(path) << "1\n2\n3\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {{"s", "sum", 0},
+                              {"a", "average", 0},
+                              {"s_copy", "sum", 0}};
+  plan::resolveOperations(tasks);
+  plan::Cache cache;
+  vector<string> reused_from;
+  vector<plan::SharedResult> results = plan::evaluate(
+      source, tasks, plan::groupByColumn(tasks), cache, reused_from);
+
+  EXPECT_EQ(reused_from, vector<string>({"", "s", "s"}));
+  EXPECT_EQ(finalizeNumeric("sum", *results[2]), 6);
+  EXPECT_EQ(finalizeNumeric("average", *results[1]), 2);
+  // операции с общим состоянием получают один результат без копирования
+  EXPECT_EQ(results[0], results[1]);
+  EXPECT_EQ(results[0], results[2]);
+
+  // повторный запуск над той же версией данных полностью берется из кэша
+  plan::evaluate(source, tasks, plan::groupByColumn(tasks), cache,
+                 reused_from);
+  EXPECT_EQ(reused_from, vector<string>({"s", "a", "s"}));
+
+  // новое чтение получает новую версию данных: кэш не используется
+  table::Table reloaded;
+  table::read(reloaded, path);
+  plan::evaluate(reloaded, tasks, plan::groupByColumn(tasks), cache,
+                 reused_from);
+  EXPECT_EQ(reused_from[0], "");
+
+  std::remove(path.c_str());
+}
+
+// Тест параметров: точный и приближенный квантиль одного столбца
+TEST(PLAN, QuantileParams) {
+  string path = "plan_quantile.csv";
+  std::ofstream file(path);
+  for (int i = 1; i <= 1000; i++) {
+    file << i << "\n";
+  }
+  file.close();
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {{"approx", "quantile", 0, {{"q", "0.25"}}},
+                              {"exact", "quantile", 0, {{"q", "0.25"},
+                                                        {"exact", "true"}}},
+                              {"median", "median", 0, {{"exact", "true"}}}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  EXPECT_EQ(finalizeNumeric("quantile", *results[1], tasks[1].params), 250);
+  EXPECT_EQ(finalizeNumeric("median", *results[2], tasks[2].params), 500);
+  EXPECT_NEAR(finalizeNumeric("quantile", *results[0], tasks[0].params), 250,
+              20);
+
+  std::remove(path.c_str());
+}
+
+// Тест группировки: операции с одним столбцом ключей используют общую
+// таблицу групп
+TEST(PLAN, GroupedTasksShareState) {
+  string path = "plan_grouped.csv";
+  std::ofstream(path) << "1,a\n2,b\n3,a\n,b\n5,\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"s", "sum", 0, {{"group_by", "1"}}, 1},
+      {"a", "average", 0, {{"group_by", "1"}}, 1},
+      {"m", "median", 0, {{"group_by", "1"}}, 1}};
+  plan::resolveOperations(tasks);
+  plan::Cache cache;
+  vector<string> reused_from;
+  vector<plan::SharedResult> results = plan::evaluate(
+      source, tasks, plan::groupByColumn(tasks), cache, reused_from);
+
+  EXPECT_EQ(reused_from, vector<string>({"", "s", ""}));
+  ASSERT_EQ(results[0]->groups.keys, vector<string>({"a", "b"}));
+  EXPECT_EQ(finalizeGroups("sum", *results[0]), vector<float>({4, 2}));
+  EXPECT_EQ(finalizeGroups("average", *results[1]), vector<float>({2, 2}));
+  // медиана не выражается через состояние группы и не вычисляется
+  EXPECT_EQ(results[2]->type, UNKNOWN);
+
+  std::remove(path.c_str());
+}
+
+// Тест преобразования: операции следующих узлов читают производный столбец,
+// который не записывается обратно в текст таблицы
+TEST(PLAN, TransformFeedsDownstream) {
+  string path = "plan_transform.csv";
+  std::ofstream(path) << "1x5,a-b\n2x5,c\n,d-\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"dot", "find_replace", 0, {{"find", "x"}, {"replace", "."}}},
+      {"cat", "concatinate", 0, {}, -1, "strip"},
+      {"sum", "sum", 0, {}, -1, "dot"},
+      {"strip", "find_replace", 1, {{"find", "-"}}},
+      {"twice", "find_replace", 0, {{"find", "x"}, {"replace", "."}}},
+      {"same", "find_replace", 1, {{"replace", "."}}},
+      {"none", "find_replace", 1, {{"find", "z"}, {"replace", "y"}}}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  EXPECT_EQ(finalizeString("find_replace", *results[0]), "2");
+  EXPECT_EQ(finalizeString("concatinate", *results[1]), "abcd");
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[2]), 4.0f);
+  EXPECT_EQ(source.rows[0][0], "1x5");
+  // одинаковое преобразование одного столбца вычисляется один раз
+  EXPECT_EQ(source.derived_columns.size(), 2);
+  // замена без find или без вхождений передает входной столбец без
+  // копирования
+  EXPECT_EQ(results[5]->column, table::sharedStringColumn(source, 1));
+  EXPECT_EQ(results[6]->column, table::sharedStringColumn(source, 1));
+  EXPECT_EQ(finalizeString("find_replace", *results[6]), "3");
+
+  std::remove(path.c_str());
+}
+
+// Тест отбора строк: агрегаты с where обрабатывают только выбранные строки,
+// а разные отборы одного столбца не смешиваются в кэше
+TEST(PLAN, FilterSelectsRows) {
+  string path = "plan_filter.csv";
+  std::ofstream(path) << "1,a\n2,b\n3,b\n,b\n5,c\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"is_b", "filter", 1, {{"value", "b"}}},
+      {"avg_b", "average", 0, {{"where", "is_b"}}, -1, "", "is_b"},
+      {"big", "filter", 0, {{"op", ">="}, {"value", "3"}}},
+      {"sum_big", "sum", 0, {{"where", "big"}}, -1, "", "big"},
+      {"sum_all", "sum", 0},
+      {"by_key", "sum", 0, {{"where", "big"}, {"group_by", "1"}}, 1, "",
+       "big"},
+      {"bad", "filter", 0, {{"op", "=>"}}}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  EXPECT_EQ(finalizeString("filter", *results[0]), "3");
+  EXPECT_FLOAT_EQ(finalizeNumeric("average", *results[1]), 2.5f);
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[3]), 8.0f);
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[4]), 11.0f);
+  EXPECT_EQ(results[5]->groups.keys, vector<string>({"b", "c"}));
+  // неизвестная операция сравнения не дает результата
+  EXPECT_EQ(results[6]->type, UNKNOWN);
+
+  std::remove(path.c_str());
+}
+
+// Тест потоковой записи: части ссылаются на буфер столбца таблицы, а
+// отбор строк задается маской части
+TEST(PLAN, StreamedConcatSharesColumn) {
+  string path = "plan_stream.csv";
+  std::ofstream(path) << "1,a\n2,b\n3,c\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"cat", "concatinate", 1, {{"stream", "true"}}},
+      {"odd", "filter", 0, {{"op", "!="}, {"value", "2"}}},
+      {"cat_odd",
+       "concatinate",
+       1,
+       {{"stream", "true"}, {"where", "odd"}},
+       -1,
+       "",
+       "odd"},
+      {"plain", "concatinate", 1}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  ASSERT_EQ(results[0]->pieces.size(), 1);
+  EXPECT_EQ(results[0]->pieces[0].column,
+            table::sharedStringColumn(source, 1));
+  EXPECT_EQ(finalizeString("concatinate", *results[0], tasks[0].params), "abc");
+  EXPECT_EQ(finalizeString("concatinate", *results[2], tasks[2].params), "ac");
+  EXPECT_EQ(finalizeString("concatinate", *results[3]), "abc");
+
+  std::remove(path.c_str());
+}
+
+// Тест числового столбца: сортировка, top_k и гистограмма читают числа в
+// одном проходе с агрегатами, без текстовой копии столбца
+TEST(PLAN, NumericColumnFeedsKeyedOps) {
+  string path = "plan_keyed.csv";
+  std::ofstream(path) << "3\n10\n2\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {{"sum", "sum", 0},
+                              {"sort", "sort", 0},
+                              {"top", "top_k", 0, {{"k", "1"}}},
+                              {"hist", "histogram", 0, {{"bins", "2"}}}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  EXPECT_EQ(source.string_columns.count(0), 0);
+  EXPECT_EQ(results[1], results[0]);
+  EXPECT_EQ(results[2], results[0]);
+  EXPECT_EQ(results[3], results[0]);
+  EXPECT_EQ(results[0]->type, NUMERIC);
+  EXPECT_EQ(finalizeNumeric("sum", *results[0]), 15);
+  EXPECT_EQ(finalizeString("sort", *results[1]), "2,3,10");
+  EXPECT_EQ(finalizeString("top_k", *results[2], tasks[2].params),
+            "10 (row 1)");
+  EXPECT_EQ(finalizeString("histogram", *results[3], tasks[3].params),
+            "2..10: 2,1");
+
+  std::remove(path.c_str());
+}
+
+// Тест выражения: агрегаты обрабатывают значения выражения, а одинаковые
+// выражения вычисляются один раз
+TEST(PLAN, ExpressionFeedsAggregates) {
+  string path = "plan_expr.csv";
+  std::ofstream(path) << "1,10\n2,20\n,30\n4,40\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"total", "sum", 0},
+      {"top", "max", 0},
+      {"big", "filter", 0, {{"op", ">"}, {"value", "5"}}},
+      {"big_sum", "sum", 0, {}, -1, "", "big"}};
+  plan::resolveOperations(tasks);
+  string error;
+  for (size_t t = 0; t < tasks.size(); t++) {
+    ASSERT_TRUE(compileExpression("col[0] * 2 + col[1] / 10", tasks[t].expr,
+                                  error));
+    tasks[t].input = plan::INPUT_EXPR + tasks[t].expr.text;
+  }
+  tasks[3].params = {{"where", "big"}};
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  // строка без значения первого столбца пропускается
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[0]), 3 + 6 + 12);
+  EXPECT_FLOAT_EQ(finalizeNumeric("max", *results[1]), 12);
+  // отбор проверяет значения выражения
+  EXPECT_EQ(finalizeString("filter", *results[2]), "2");
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[3]), 18);
+  EXPECT_EQ(source.derived_columns.size(), 1);
+
+  std::remove(path.c_str());
+}
+
+// Тест оконных операций: производный столбец читают операции следующих
+// узлов
+TEST(PLAN, WindowFeedsAggregates) {
+  string path = "plan_window.csv";
+  std::ofstream(path) << "1,10\n2,20\n,30\n4,40\n";
+
+  table::Table source;
+  table::read(source, path);
+
+  vector<plan::Task> tasks = {
+      {"roll", "rolling_average", 0, {{"window", "2"}}},
+      {"roll_sum", "sum", 0, {}, -1, "roll"},
+      {"running", "cumulative_sum", 1},
+      {"last", "max", 1, {}, -1, "running"}};
+  plan::resolveOperations(tasks);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+
+  // окно строки без значения содержит только предыдущую строку
+  EXPECT_FLOAT_EQ(finalizeNumeric("rolling_average", *results[0]), 4);
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[1]), 1 + 1.5 + 2 + 4);
+  EXPECT_FLOAT_EQ(finalizeNumeric("max", *results[3]), 100);
+  EXPECT_EQ(source.derived_columns.size(), 2);
+
+  std::remove(path.c_str());
+}
+
+// Тест компиляции плана: ошибки конфигурации найдены при загрузке, а
+// операции доступны по номеру
+TEST(PLAN, CompileValidatesConfig) {
+  string path = "plan_compile.yaml";
+  std::ofstream(path) << "operations:\n"
+                      << "  ok:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "  bad_func:\n"
+                      << "    func: nothing\n"
+                      << "    column: 0\n"
+                      << "  bad_table:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "    table: missing\n"
+                      << "  bad_join:\n"
+                      << "    func: join\n"
+                      << "    column: 0\n"
+                      << "    right: missing\n"
+                      << "  bad_where:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "    where: ok\n"
+                      << "  bad_group:\n"
+                      << "    func: median\n"
+                      << "    column: 0\n"
+                      << "    group_by: 1\n"
+                      << "  bad_upstream:\n"
+                      << "    func: sum\n"
+                      << "    column: ok\n"
+                      << "    group_by: 1\n"
+                      << "  bad_op:\n"
+                      << "    func: filter\n"
+                      << "    column: 0\n"
+                      << "    op: =>\n"
+                      << "  bad_q:\n"
+                      << "    func: quantile\n"
+                      << "    column: 0\n"
+                      << "    q: 2\n"
+                      << "  below_bad:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "    where: bad_op\n"
+                      << "  bad_window:\n"
+                      << "    func: rolling_sum\n"
+                      << "    column: 0\n";
+
+  config::load(path);
+  EXPECT_EQ(plan::compile(config::getIds()), 10);
+  config::clear();
+
+  int ok = plan::taskIndex("ok");
+  ASSERT_GE(ok, 0);
+  EXPECT_EQ(plan::compiledTask(ok)->op, OP_SUM);
+  EXPECT_TRUE(plan::compiledTask(ok)->error.empty());
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_func"))->error,
+            "Unknown operation nothing");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_table"))->error,
+            "Table missing not found");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_join"))->error,
+            "Right table not found");
+  // цель отбора и группировка проверяются при загрузке, а не при записи
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_where"))->error,
+            "Filter ok not found");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_group"))->error,
+            "Operation median can't be grouped");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_upstream"))->error,
+            "Operation sum can't be grouped or filtered over upstream results");
+  // параметры проверяются при загрузке, а операции, читающие результат
+  // операции с ошибкой, тоже не выполняются
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_op"))->error,
+            "Unknown comparison =>");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_q"))->error,
+            "Parameter q must be a number from 0 to 1");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("below_bad"))->error,
+            "Operation bad_op has errors");
+  EXPECT_EQ(plan::compiledTask(plan::taskIndex("bad_window"))->error,
+            "Parameter window must be a number of rows from 1 to 1073741824");
+  EXPECT_EQ(plan::taskIndex("absent"), -1);
+  EXPECT_EQ(plan::compiledTask(-1), nullptr);
+
+  plan::clear();
+  std::remove(path.c_str());
+}
+
+// Тест кавычек: значения в кавычках читаются без них, поэтому выражение
+// компилируется, а ключи функций и столбцы разбираются
+TEST(PLAN, CompileUnquotesValues) {
+  string data = "plan_quoted.csv";
+  std::ofstream(data) << "1,10\n2,20\n,30\n4,40\n";
+  string path = "plan_quoted.yaml";
+  std::ofstream(path) << "operations:\n"
+                      << "  scaled:\n"
+                      << "    func: \"sum\"\n"
+                      << "    column: '0'\n"
+                      << "    expr: \"col[1] * 1.5 + col[0]\"\n";
+
+  config::load(path);
+  EXPECT_EQ(plan::compile(config::getIds()), 0);
+  config::clear();
+
+  const plan::Task *task = plan::compiledTask(plan::taskIndex("scaled"));
+  ASSERT_NE(task, nullptr);
+  EXPECT_TRUE(task->error.empty());
+  EXPECT_EQ(task->op, OP_SUM);
+  EXPECT_EQ(task->input, plan::INPUT_EXPR + "col[1] * 1.5 + col[0]");
+
+  table::Table source;
+  table::read(source, data);
+  vector<plan::Task> tasks = {*task};
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+  // строка без значения первого столбца пропускается
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[0]), 16 + 32 + 64);
+
+  plan::clear();
+  std::remove(path.c_str());
+  std::remove(data.c_str());
+}
+
+// Тест отбора с параметрами в кавычках: операция сравнения и значение
+// читаются без кавычек
+TEST(PLAN, FilterQuotedParams) {
+  string data = "plan_filter_quoted.csv";
+  std::ofstream(data) << "1,a\n2,b\n3,b\n,b\n5,c\n";
+  string path = "plan_filter_quoted.yaml";
+  std::ofstream(path) << "operations:\n"
+                      << "  is_b:\n"
+                      << "    func: filter\n"
+                      << "    column: 1\n"
+                      << "    value: \"b\"\n"
+                      << "  big:\n"
+                      << "    func: filter\n"
+                      << "    column: 0\n"
+                      << "    op: \">\"\n"
+                      << "    value: '2'\n"
+                      << "  sum_big:\n"
+                      << "    func: sum\n"
+                      << "    column: 0\n"
+                      << "    where: \"big\"\n";
+
+  config::load(path);
+  EXPECT_EQ(plan::compile(config::getIds()), 0);
+  config::clear();
+
+  vector<plan::Task> tasks;
+  for (const char *id : {"is_b", "big", "sum_big"}) {
+    const plan::Task *task = plan::compiledTask(plan::taskIndex(id));
+    ASSERT_NE(task, nullptr);
+    EXPECT_TRUE(task->error.empty());
+    tasks.push_back(*task);
+  }
+  EXPECT_EQ(tasks[0].params.at("value"), "b");
+  EXPECT_EQ(tasks[1].params.at("op"), ">");
+
+  table::Table source;
+  table::read(source, data);
+  vector<plan::SharedResult> results =
+      plan::evaluate(source, tasks, plan::groupByColumn(tasks));
+  EXPECT_EQ(finalizeString("filter", *results[0]), "3");
+  EXPECT_EQ(finalizeString("filter", *results[1]), "2");
+  EXPECT_FLOAT_EQ(finalizeNumeric("sum", *results[2]), 8.0f);
+
+  plan::clear();
+  std::remove(path.c_str());
+  std::remove(data.c_str());
+}
@@ -0,0 +1,157 @@
+#include "../../include/sketch.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: перемешанные значения 0..n-1
+vector<float> shuffled(size_t n) {
+  vector<float> values(n);
+  for (size_t i = 0; i < n; i++) {
+    values[i] = i;
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(42));
+  return values;
+}
+
+// Вспомогательная функция: количество значений во всех уровнях скетча
+size_t stored(const QuantileSketch &sketch) {
+  size_t total = 0;
+  for (const vector<float> &level : sketch.levels) {
+    total += level.size();
+  }
+  return total;
+}
+
+// Вспомогательная функция: строки key0..key{n-1}, каждая повторена дважды
+vector<string> keys(size_t n) {
+  vector<string> values;
+  for (size_t i = 0; i < 2 * n; i++) {
+    values.push_back("key" + std::to_string(i % n));
+  }
+  return values;
+}
+
+// Тест точности: ошибка ранга в пределах нескольких процентов
+TEST(SKETCH, QuantilesWithinRankError) {
+  size_t n = 1000000;
+  vector<float> values = shuffled(n);
+  QuantileSketch sketch = createSketch(DEFAULT_ACCURACY);
+  sketchInsert(sketch, values.data(), nullptr, n);
+
+  EXPECT_EQ(sketch.count, n);
+  EXPECT_NEAR(sketchQuantile(sketch, 0.5), 0.5 * n, 0.02 * n);
+  EXPECT_NEAR(sketchQuantile(sketch, 0.95), 0.95 * n, 0.02 * n);
+  EXPECT_NEAR(sketchQuantile(sketch, 0.99), 0.99 * n, 0.02 * n);
+}
+
+// Тест ограниченной памяти: размер скетча не растет с количеством значений
+TEST(SKETCH, BoundedMemory) {
+  vector<float> values = shuffled(200000);
+  QuantileSketch sketch = createSketch(100);
+
+  sketchInsert(sketch, values.data(), nullptr, 1000);
+  size_t small = stored(sketch);
+  sketchInsert(sketch, values.data(), nullptr, values.size());
+
+  EXPECT_LE(stored(sketch), 4 * 100);
+  EXPECT_LE(small, 4 * 100);
+}
+
+// Тест объединения скетчей частей данных
+TEST(SKETCH, MergeParts) {
+  size_t n = 300000;
+  vector<float> values = shuffled(n);
+  QuantileSketch merged;
+
+  for (size_t part = 0; part < 3; part++) {
+    QuantileSketch sketch = createSketch(DEFAULT_ACCURACY);
+    sketchInsert(sketch, values.data() + part * n / 3, nullptr, n / 3);
+    sketchMerge(merged, sketch);
+  }
+
+  EXPECT_EQ(merged.count, n);
+  EXPECT_NEAR(sketchQuantile(merged, 0.5), 0.5 * n, 0.02 * n);
+}
+
+// Тест пропусков: значения вне маски не попадают в скетч
+TEST(SKETCH, SkipsMissing) {
+  vector<float> values = {1, 100, 2, 100, 3};
+  vector<uint64_t> validity = {0b10101};
+  QuantileSketch sketch = createSketch(DEFAULT_ACCURACY);
+  sketchInsert(sketch, values.data(), validity.data(), values.size());
+
+  EXPECT_EQ(sketch.count, 3);
+  EXPECT_EQ(sketchQuantile(sketch, 1), 3);
+  EXPECT_TRUE(std::isnan(sketchQuantile(createSketch(10), 0.5)));
+}
+
+// Тест точного квантиля: совпадение с сортировкой
+TEST(SKETCH, SortedQuantileMatchesSort) {
+  vector<float> values = shuffled(500000);
+  for (size_t i = 0; i < values.size(); i += 7) {
+    values[i] = 12345; // повторяющиеся значения
+  }
+  vector<float> sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+
+  for (double q : {0.0, 0.25, 0.5, 0.95, 0.99, 1.0}) {
+    size_t rank = std::max(1.0, std::ceil(q * sorted.size())) - 1;
+    EXPECT_EQ(sortedQuantile(sorted, q), sorted[rank]);
+  }
+  EXPECT_TRUE(std::isnan(sortedQuantile(vector<float>(), 0.5)));
+}
+
+// Тест HyperLogLog: ошибка в пределах нескольких процентов при фиксированной
+// памяти
+TEST(SKETCH, DistinctWithinError) {
+  vector<string> values = keys(100000);
+  DistinctSketch sketch;
+  distinctInsert(sketch, values.data(), nullptr, values.size());
+
+  EXPECT_EQ(sketch.registers.size(), size_t(1) << HLL_PRECISION);
+  EXPECT_NEAR(distinctEstimate(sketch), 100000, 5000);
+
+  // малые количества считаются линейным подсчетом почти точно
+  vector<string> few = keys(10);
+  DistinctSketch small;
+  distinctInsert(small, few.data(), nullptr, few.size());
+  EXPECT_NEAR(distinctEstimate(small), 10, 0.5);
+}
+
+// Тест объединения: скетч частей равен скетчу всех данных
+TEST(SKETCH, DistinctMergeParts) {
+  vector<string> values = keys(50000);
+  DistinctSketch whole, first, second;
+  distinctInsert(whole, values.data(), nullptr, values.size());
+  distinctInsert(first, values.data(), nullptr, 30001);
+  distinctInsert(second, values.data() + 30001, nullptr,
+                 values.size() - 30001);
+  distinctMerge(first, second);
+
+  EXPECT_EQ(first.registers, whole.registers);
+}
+
+// Тест точного множества: пропуски и повторы не учитываются, объединение
+// частей не дублирует значения
+TEST(SKETCH, DistinctSetExact) {
+  vector<string> values = keys(1000);
+  values.push_back("missing");
+  vector<uint64_t> validity((values.size() + 63) / 64, ~uint64_t(0));
+  validity.back() &= ~(uint64_t(1) << ((values.size() - 1) % 64));
+
+  DistinctSet set;
+  distinctSetInsert(set, values.data(), validity.data(), values.size());
+  EXPECT_EQ(set.values.size(), 1000);
+
+  DistinctSet first, second;
+  distinctSetInsert(first, values.data(), nullptr, 1500);
+  distinctSetInsert(second, values.data() + 1500, nullptr, 500);
+  distinctSetMerge(first, second);
+  EXPECT_EQ(first.values.size(), 1000);
+}
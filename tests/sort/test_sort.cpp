@@ -0,0 +1,152 @@
+#include "../../include/column.h"
+#include "../../include/sort.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: файл существует
+bool fileExists(const string &path) { return std::ifstream(path).good(); }
+
+// Вспомогательная функция: значения слияния по порядку
+vector<string> sortedValues(const SortState &state, bool descending = false) {
+  vector<string> values;
+  forEachSorted(state, descending,
+                [&](const string &value) { values.push_back(value); });
+  return values;
+}
+
+// Тест поразрядной сортировки: результат совпадает с std::sort, в том числе
+// для отрицательных чисел, нулей и бесконечностей, в одном и нескольких
+// потоках
+TEST(SORT, RadixMatchesStdSort) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> distribution(-1000, 1000);
+  vector<float> values(300000);
+  for (float &value : values) {
+    value = distribution(generator);
+  }
+  values[0] = 0;
+  values[1] = INFINITY;
+  values[2] = -INFINITY;
+
+  vector<float> expected = values;
+  std::sort(expected.begin(), expected.end());
+
+  for (unsigned workers : {1u, 4u}) {
+    vector<float> sorted = values;
+    radixSort(sorted, workers);
+    EXPECT_EQ(sorted, expected);
+  }
+}
+
+// Тест серий сверх бюджета: серии сбрасываются на диск, слияние дает все
+// значения по порядку, а файлы удаляются вместе с состоянием
+TEST(SORT, SpillsOverBudget) {
+  vector<float> values = {5, -1, 3, 9, 0, 2, 8, -7, 4, 6};
+  Bitmap validity = createBitmap(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i != 3)
+      setBit(validity, i);
+  }
+
+  vector<string> paths;
+  {
+    SortState state;
+    state.budget = 3 * sizeof(float);
+    sortInsert(state, values.data(), validity.words.data(), values.size());
+    ASSERT_EQ(state.runs.size(), 3);
+    for (const auto &run : state.runs) {
+      if (!run->path.empty())
+        paths.push_back(run->path);
+    }
+    EXPECT_EQ(paths.size(), 2);
+    for (const string &path : paths) {
+      EXPECT_TRUE(fileExists(path));
+    }
+
+    EXPECT_EQ(sortedValues(state),
+              vector<string>({"-7", "-1", "0", "2", "3", "4", "5", "6", "8"}));
+    // по убыванию серии, в том числе сброшенные, читаются с конца
+    EXPECT_EQ(sortedValues(state, true),
+              vector<string>({"8", "6", "5", "4", "3", "2", "0", "-1", "-7"}));
+  }
+  for (const string &path : paths) {
+    EXPECT_FALSE(fileExists(path));
+  }
+}
+
+// Тест строк: серии частей данных объединяются слиянием
+TEST(SORT, StringRunsMerge) {
+  vector<string> first = {"pear", "apple", "fig"};
+  vector<string> second = {"banana", "cherry"};
+
+  SortState state;
+  state.budget = 64;
+  sortInsert(state, first.data(), nullptr, first.size());
+  SortState other;
+  other.budget = 64;
+  sortInsert(other, second.data(), nullptr, second.size());
+  sortMerge(state, other);
+
+  EXPECT_EQ(sortedValues(state), vector<string>({"apple", "banana", "cherry",
+                                                 "fig", "pear"}));
+  EXPECT_EQ(sortedValues(state, true),
+            vector<string>({"pear", "fig", "cherry", "banana", "apple"}));
+  bool spilled = false;
+  for (const auto &run : state.runs) {
+    spilled = spilled or !run->path.empty();
+  }
+  EXPECT_TRUE(spilled);
+}
+
+// Тест частей разных типов: числа сравниваются как строки, если в другой
+// части столбец строковый
+TEST(SORT, MixedRunsCompareAsStrings) {
+  vector<float> numbers = {10, 9};
+  vector<string> strings = {"a", "1"};
+
+  SortState state;
+  sortInsert(state, numbers.data(), nullptr, numbers.size());
+  EXPECT_EQ(sortedValues(state), vector<string>({"9", "10"}));
+
+  sortInsert(state, strings.data(), nullptr, strings.size());
+  EXPECT_EQ(sortedValues(state), vector<string>({"1", "10", "9", "a"}));
+  EXPECT_EQ(sortedValues(state, true), vector<string>({"a", "9", "10", "1"}));
+}
+
+// Тест слияния по убыванию: сброшенные серии больше блока чтения читаются
+// с конца блоками, и значения на границах блоков не теряются
+TEST(SORT, DescendingReadsSpilledBlocks) {
+  std::mt19937 generator(11);
+  vector<string> strings(30000);
+  vector<float> numbers(50000);
+  for (size_t i = 0; i < strings.size(); i++) {
+    strings[i] = string(generator() % 9, 'x') + std::to_string(generator());
+  }
+  for (float &value : numbers) {
+    value = float(generator() % 100000) - 50000;
+  }
+
+  SortState text;
+  text.budget = 1 << 18;
+  sortInsert(text, strings.data(), nullptr, strings.size());
+  SortState numeric;
+  numeric.budget = 1 << 16;
+  sortInsert(numeric, numbers.data(), nullptr, numbers.size());
+  EXPECT_FALSE(text.runs[0]->path.empty());
+  EXPECT_FALSE(numeric.runs[0]->path.empty());
+
+  vector<string> expected = sortedValues(text);
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(sortedValues(text, true), expected);
+
+  expected = sortedValues(numeric);
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(sortedValues(numeric, true), expected);
+}
@@ -0,0 +1,158 @@
+#include "../../include/column.h"
+#include "../../include/topk.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Вспомогательная функция: значения лучших чисел
+vector<float> valuesOf(const vector<TopEntry> &entries) {
+  vector<float> values;
+  for (const TopEntry &entry : entries) {
+    values.push_back(entry.value);
+  }
+  return values;
+}
+
+// Тест кучи: лучшие значения совпадают с началом отсортированного столбца,
+// номера строк указывают на значения, результат не зависит от потоков
+TEST(TOPK, MatchesSortedPrefix) {
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<float> distribution(-1000, 1000);
+  vector<float> values(300000);
+  for (float &value : values) {
+    value = distribution(generator);
+  }
+
+  vector<float> expected = values;
+  std::sort(expected.begin(), expected.end(), std::greater<float>());
+  expected.resize(100);
+
+  vector<TopEntry> single;
+  for (unsigned workers : {1u, 4u}) {
+    TopKState state;
+    state.k = 100;
+    topKInsert(state, values.data(), nullptr, values.size(), nullptr,
+               workers);
+    vector<TopEntry> top = topKValues(state);
+    EXPECT_EQ(valuesOf(top), expected);
+    for (const TopEntry &entry : top) {
+      EXPECT_EQ(values[entry.row], entry.value);
+    }
+    if (workers == 1)
+      single = top;
+    else
+      EXPECT_EQ(valuesOf(top), valuesOf(single));
+  }
+}
+
+// Тест порядка по возрастанию: пропуски и NaN не попадают в результат, а
+// равные значения идут по номеру строки
+TEST(TOPK, AscendingSkipsMissing) {
+  vector<float> values = {4, NAN, 1, 8, 1, -3};
+  Bitmap validity = createBitmap(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i != 5)
+      setBit(validity, i);
+  }
+
+  TopKState state;
+  state.k = 3;
+  state.ascending = true;
+  topKInsert(state, values.data(), validity.words.data(), values.size());
+  vector<TopEntry> top = topKValues(state);
+
+  ASSERT_EQ(top.size(), 3);
+  EXPECT_EQ(valuesOf(top), vector<float>({1, 1, 4}));
+  EXPECT_EQ(top[0].row, 2);
+  EXPECT_EQ(top[1].row, 4);
+  EXPECT_EQ(top[2].row, 0);
+}
+
+// Тест частот строк: частоты частей складываются, номер первой строки
+// отсчитывается от начала первой части
+TEST(TOPK, FrequentStringsMerge) {
+  vector<string> first = {"x", "y", "x"};
+  vector<string> second = {"z", "y", "y", "z", "w"};
+
+  for (bool ascending : {false, true}) {
+    TopKState state;
+    state.k = 2;
+    state.ascending = ascending;
+    topKInsert(state, first.data(), nullptr, first.size());
+    TopKState other;
+    other.k = 2;
+    other.ascending = ascending;
+    topKInsert(other, second.data(), nullptr, second.size());
+    topKMerge(state, other, first.size());
+
+    vector<pair<string, TopCount>> top = topKStrings(state);
+    ASSERT_EQ(top.size(), 2);
+    if (ascending) {
+      EXPECT_EQ(top[0].first, "w");
+      EXPECT_EQ(top[0].second.row, 7);
+      continue;
+    }
+    EXPECT_EQ(top[0].first, "y");
+    EXPECT_EQ(top[0].second.count, 3);
+    EXPECT_EQ(top[0].second.row, 1);
+    EXPECT_EQ(top[1].first, "x");
+    EXPECT_EQ(top[1].second.count, 2);
+  }
+}
+
+// Тест разреженного столбца: номера строк лучших значений - строки таблицы,
+// а не номера упакованных значений
+TEST(TOPK, SparseColumnRows) {
+  vector<float> values(100, 0);
+  Bitmap validity = createBitmap(values.size());
+  for (size_t row : {7, 40, 93}) {
+    values[row] = float(row);
+    setBit(validity, row);
+  }
+  NumericColumn column = makeNumericColumn(values, validity);
+  ASSERT_EQ(column.layout, SPARSE);
+
+  TopKState state;
+  state.k = 2;
+  NumericView view(column);
+  topKInsert(state, view.values, view.validity, view.length, view.rows);
+  vector<TopEntry> top = topKValues(state);
+
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].row, 93);
+  EXPECT_EQ(top[1].row, 40);
+}
+
+// Тест ограниченных счетчиков: частые строки находятся среди множества
+// редких, а количество счетчиков не превышает ограничения
+TEST(TOPK, BoundedStringCounters) {
+  vector<string> values;
+  for (size_t i = 0; i < 20000; i++) {
+    values.push_back(i % 4 == 0 ? "often" : i % 4 == 1 ? "common"
+                                                       : std::to_string(i));
+  }
+
+  TopKState state;
+  state.k = 2;
+  topKInsert(state, values.data(), nullptr, values.size() / 2);
+  TopKState other;
+  other.k = 2;
+  topKInsert(other, values.data() + values.size() / 2, nullptr,
+             values.size() / 2);
+  topKMerge(state, other, values.size() / 2);
+
+  EXPECT_LE(state.counters.size(), MIN_TOPK_COUNTERS);
+  vector<pair<string, TopCount>> top = topKStrings(state);
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].first, "often");
+  EXPECT_GE(top[0].second.count, 5000);
+  EXPECT_EQ(top[0].second.row, 0);
+  EXPECT_EQ(top[1].first, "common");
+  EXPECT_EQ(top[1].second.row, 1);
+}
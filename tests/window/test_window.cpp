@@ -0,0 +1,96 @@
+#include "../../include/kernels.h"
+#include "../../include/window.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using std::vector;
+
+// Вспомогательная функция: столбец, в котором отсутствуют строки missing
+NumericColumn columnOf(const vector<float> &values,
+                       const vector<size_t> &missing = {}) {
+  Bitmap validity = createBitmap(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    setBit(validity, i);
+  }
+  vector<float> dense = values;
+  for (size_t i : missing) {
+    validity.words[i / 64] &= ~(uint64_t(1) << (i % 64));
+    dense[i] = 0;
+  }
+  return makeNumericColumn(dense, validity);
+}
+
+// Тест скользящей суммы и среднего: окно сдвигается на одну строку
+TEST(WINDOW, RollingSumAndAverage) {
+  NumericColumn column = columnOf({1, 2, 3, 4, 5});
+
+  NumericColumn sums = rollingSum(column, 3);
+  EXPECT_EQ(sums.values, vector<float>({1, 3, 6, 9, 12}));
+
+  NumericColumn averages = rollingAverage(column, 2);
+  EXPECT_EQ(averages.values, vector<float>({1, 1.5, 2.5, 3.5, 4.5}));
+  EXPECT_EQ(presentCount(averages), 5);
+}
+
+// Тест пропусков: среднее считается по присутствующим значениям окна, а
+// строка с пустым окном остается пропуском
+TEST(WINDOW, RollingSkipsMissing) {
+  NumericColumn column = columnOf({2, 0, 0, 8, 4}, {1, 2});
+
+  NumericColumn averages = rollingAverage(column, 2);
+  EXPECT_EQ(presentCount(averages), 4);
+  EXPECT_FALSE(isPresent(validityWords(averages), 2));
+  EXPECT_FLOAT_EQ(averages.values[1], 2);
+  EXPECT_FLOAT_EQ(averages.values[2], 0);
+  EXPECT_FLOAT_EQ(averages.values[4], 6);
+}
+
+// Тест накопленной суммы: результат совпадает с последовательным сложением
+// на длине, не кратной размеру вектора и слова маски
+TEST(WINDOW, CumulativeSumMatchesScalar) {
+  size_t n = 1000;
+  vector<float> values(n);
+  vector<size_t> missing;
+  for (size_t i = 0; i < n; i++) {
+    values[i] = float(i % 7) - 3;
+    if (i % 5 == 0)
+      missing.push_back(i);
+  }
+  NumericColumn column = columnOf(values, missing);
+
+  NumericColumn sums = cumulativeSum(column);
+  ASSERT_EQ(sums.layout, DENSE);
+  double expected = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (i % 5 == 0) {
+      EXPECT_FLOAT_EQ(sums.values[i], 0);
+      continue;
+    }
+    expected += values[i];
+    EXPECT_FLOAT_EQ(sums.values[i], expected);
+  }
+  EXPECT_EQ(presentCount(sums), n - missing.size());
+}
+
+// Тест ядра накопленной суммы без маски
+TEST(WINDOW, PrefixSumWithoutMask) {
+  vector<float> values = {1, 2, 3, 4, 5};
+  vector<float> out(values.size());
+  maskedPrefixSum(values.data(), nullptr, values.size(), out.data());
+  EXPECT_EQ(out, vector<float>({1, 3, 6, 10, 15}));
+}
+
+// Тест разреженного столбца: значения раскладываются по строкам таблицы
+TEST(WINDOW, SparseSource) {
+  size_t n = 100;
+  Bitmap rare = createBitmap(n);
+  setBit(rare, 10);
+  setBit(rare, 12);
+  NumericColumn column = makeNumericColumn(vector<float>(n, 3), rare);
+  ASSERT_EQ(column.layout, SPARSE);
+
+  NumericColumn sums = rollingSum(column, 3);
+  ASSERT_EQ(sums.layout, SPARSE);
+  EXPECT_EQ(sums.rows, vector<uint32_t>({10, 11, 12, 13, 14}));
+  EXPECT_EQ(sums.values, vector<float>({3, 3, 6, 3, 3}));
+}